@@ -1,4 +1,26 @@
 #BlackBoardCmd.thrift
+
+# The type of a BlackBoardValue. NO_TYPE: the key has never been set
+enum BlackBoardType {
+  I16_TYPE,
+  I32_TYPE,
+  I64_TYPE,
+  BYTE_TYPE,
+  DOUBLE_TYPE,
+  BOOL_TYPE,
+  STRING_TYPE,
+  NO_TYPE
+}
+
+# A value of any type, for the batched and the atomic calls: only the field of its type is meaningful
+struct BlackBoardValue {
+  1: BlackBoardType type = BlackBoardType.NO_TYPE;
+  # i16, i32, i64, byte and bool
+  2: i64 integer;
+  3: double real;
+  4: string text;
+}
+
 service BlackBoardCmd {
   void SetI16(1: string name, 2: i16 data);
   void SetI32(1: string name, 2: i32 data);
@@ -14,4 +36,22 @@ service BlackBoardCmd {
   double GetDouble(1: string name);
   bool GetBool(1: string name);
   string GetString(1: string name);
-}
\ No newline at end of file
+
+  # One round trip for many keys. The values are in the order of the names (NO_TYPE if not set).
+  # A snapshot with a typed blackboard (all the values at a single point in time), otherwise each value is
+  # read atomically, not the whole list
+  list<BlackBoardValue> GetMany(1: list<string> names);
+  # All the values or none (false) are set: the batch is checked before the first set. With a typed
+  # blackboard the batch is also atomic for the readers, which see all of it or none of it
+  bool SetMany(1: list<string> names, 2: list<BlackBoardValue> values);
+  # Sets desired only if the value is expected (NO_TYPE: the key has never been set). Returns whether it has been set
+  bool CompareAndSet(1: string name, 2: BlackBoardValue expected, 3: BlackBoardValue desired);
+  # Adds delta to the number (0 if the key has never been set) and returns the new value (NO_TYPE if not a number)
+  BlackBoardValue Increment(1: string name, 2: BlackBoardValue delta);
+
+  # Streams the changes of the keys that match the patterns ('*' and '?' wildcards) to client_port:
+  # coalesced deltas, at most max_rate messages per second (0: no limit). Returns the id of the
+  # subscription, -1 if the changes cannot be streamed (e.g. a server on a yarp::os::Property)
+  i32 Subscribe(1: string client_port, 2: list<string> patterns, 3: double max_rate);
+  bool Unsubscribe(1: i32 subscription_id);
+}
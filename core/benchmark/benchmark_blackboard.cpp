@@ -0,0 +1,249 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <typed_blackboard.h>
+#include <shared_blackboard.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// A condition that reads ten keys per tick
+static const int KEYS_NUMBER = 10;
+
+static std::vector<std::string> KeyNames()
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < KEYS_NUMBER; i++)
+    {
+        names.push_back("sensor_" + std::to_string(i));
+    }
+    return names;
+}
+
+
+static void BM_ByNameGet(benchmark::State& state)
+{
+    BT::TypedBlackBoard blackboard;
+    std::vector<std::string> names = KeyNames();
+    for (int i = 0; i < KEYS_NUMBER; i++)
+    {
+        blackboard.SetByName<double>(names[i], i);
+    }
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (int i = 0; i < KEYS_NUMBER; i++)
+        {
+            sum += blackboard.GetByName<double>(names[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * KEYS_NUMBER);
+}
+BENCHMARK(BM_ByNameGet);
+
+
+static void BM_InternedGet(benchmark::State& state)
+{
+    BT::TypedBlackBoard blackboard;
+    std::vector<std::string> names = KeyNames();
+    std::vector<BT::BlackBoardKey<double> > keys;
+    for (int i = 0; i < KEYS_NUMBER; i++)
+    {
+        keys.push_back(blackboard.Intern<double>(names[i]));
+        blackboard.Set(keys[i], (double)i);
+    }
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (int i = 0; i < KEYS_NUMBER; i++)
+        {
+            sum += blackboard.Get(keys[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * KEYS_NUMBER);
+}
+BENCHMARK(BM_InternedGet);
+
+
+// The same reads from a second mapping of a shared-memory segment (as a reader in another process)
+static void BM_SharedGet(benchmark::State& state)
+{
+    BT::SharedBlackBoard owner("/btpp_benchmark_blackboard", KEYS_NUMBER);
+    BT::SharedBlackBoard blackboard("/btpp_benchmark_blackboard");
+    std::vector<std::string> names = KeyNames();
+    std::vector<BT::SharedBlackBoardKey<double> > keys;
+    for (int i = 0; i < KEYS_NUMBER; i++)
+    {
+        owner.Set(owner.Intern<double>(names[i]), (double)i);
+        keys.push_back(blackboard.Intern<double>(names[i]));
+    }
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (int i = 0; i < KEYS_NUMBER; i++)
+        {
+            sum += blackboard.Get(keys[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * KEYS_NUMBER);
+}
+BENCHMARK(BM_SharedGet);
+
+
+// Contention: 16 threads read and the other ones write, all on the same keys.
+// Run with 1 writer and 16 readers, and with 16 writers and 16 readers
+struct Pose
+{
+    double x;
+    double y;
+    double theta;
+    int64_t stamp;
+};
+
+static BT::TypedBlackBoard* shared_blackboard;
+static std::vector<BT::BlackBoardKey<Pose> > pose_keys;
+static std::vector<BT::BlackBoardKey<std::string> > string_keys;
+
+// Baseline: the values behind a single lock
+static std::mutex locked_mutex;
+static std::vector<Pose> locked_poses;
+
+static void SetUpShared(benchmark::State& state)
+{
+    if (state.thread_index() != 0)
+    {
+        return;
+    }
+    // the other threads wait for thread 0 before their first iteration
+    shared_blackboard = new BT::TypedBlackBoard();
+    pose_keys.clear();
+    string_keys.clear();
+    std::vector<std::string> names = KeyNames();
+    for (int i = 0; i < KEYS_NUMBER; i++)
+    {
+        pose_keys.push_back(shared_blackboard->Intern<Pose>(names[i] + "_pose"));
+        string_keys.push_back(shared_blackboard->Intern<std::string>(names[i] + "_frame"));
+    }
+    locked_poses.assign(KEYS_NUMBER, Pose());
+}
+
+static void TearDownShared(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        delete shared_blackboard;
+        shared_blackboard = NULL;
+    }
+}
+
+static const int READERS_NUMBER = 16;
+
+static bool IsWriter(benchmark::State& state)
+{
+    return state.thread_index() < state.threads() - READERS_NUMBER;
+}
+
+static void ContentionArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->Threads(1 + READERS_NUMBER);
+    benchmark->Threads(16 + READERS_NUMBER);
+    benchmark->UseRealTime();
+}
+
+
+static void BM_ContendedSeqlock(benchmark::State& state)
+{
+    SetUpShared(state);
+    bool is_writer = IsWriter(state);
+    int64_t stamp = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < KEYS_NUMBER; i++)
+        {
+            if (is_writer)
+            {
+                Pose pose = {1.0, 2.0, 3.0, ++stamp};
+                shared_blackboard->Set(pose_keys[i], pose);
+            }
+            else
+            {
+                benchmark::DoNotOptimize(shared_blackboard->Get(pose_keys[i]));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * KEYS_NUMBER);
+    TearDownShared(state);
+}
+BENCHMARK(BM_ContendedSeqlock)->Apply(ContentionArgs);
+
+
+static void BM_ContendedRcuString(benchmark::State& state)
+{
+    SetUpShared(state);
+    bool is_writer = IsWriter(state);
+    std::string frame = "base_link_" + std::to_string(state.thread_index());
+    for (auto _ : state)
+    {
+        for (int i = 0; i < KEYS_NUMBER; i++)
+        {
+            if (is_writer)
+            {
+                shared_blackboard->Set(string_keys[i], frame);
+            }
+            else
+            {
+                shared_blackboard->Read(string_keys[i], [](const std::string& value)
+                {
+                    benchmark::DoNotOptimize(value.size());
+                });
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * KEYS_NUMBER);
+    TearDownShared(state);
+}
+BENCHMARK(BM_ContendedRcuString)->Apply(ContentionArgs);
+
+
+static void BM_ContendedMutex(benchmark::State& state)
+{
+    SetUpShared(state);
+    bool is_writer = IsWriter(state);
+    int64_t stamp = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < KEYS_NUMBER; i++)
+        {
+            std::lock_guard<std::mutex> LockGuard(locked_mutex);
+            if (is_writer)
+            {
+                Pose pose = {1.0, 2.0, 3.0, ++stamp};
+                locked_poses[i] = pose;
+            }
+            else
+            {
+                benchmark::DoNotOptimize(locked_poses[i]);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * KEYS_NUMBER);
+    TearDownShared(state);
+}
+BENCHMARK(BM_ContendedMutex)->Apply(ContentionArgs);
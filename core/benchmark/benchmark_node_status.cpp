@@ -0,0 +1,161 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <condition_test_node.h>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+
+// A copy of the status accessors of TreeNode before the packed status word (baseline commit):
+// one mutex per field, and a console message at every get_status() and set_status(). The messages go to
+// a stream that discards them, so that the formatting is measured but not the terminal.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) { return c; }
+};
+
+class LegacyTreeNode
+{
+public:
+    LegacyTreeNode(std::string name) : name_(name), is_halt_requested_(false), console_(&null_buffer_)
+    {
+        set_status(BT::IDLE);
+    }
+
+    void set_status(BT::ReturnStatus new_status)
+    {
+        if (new_status != BT::IDLE)
+        {
+            set_color_status(new_status);
+        }
+
+        // Lock acquistion
+        std::unique_lock<std::mutex> UniqueLock(state_mutex_);
+        console_ << get_name() << " is setting its status to " << new_status <<std::endl;
+
+        // state_ update
+        status_ = new_status;
+    }
+
+    BT::ReturnStatus get_status()
+    {
+        std::lock_guard<std::mutex> LockGuard(state_mutex_);
+        console_ << get_name() << " status is " << status_ <<std::endl;
+
+        return status_;
+    }
+
+    void set_color_status(BT::ReturnStatus new_color_status)
+    {
+        std::lock_guard<std::mutex> LockGuard(color_state_mutex_);
+        color_status_ = new_color_status;
+    }
+
+    std::string get_name()
+    {
+        return name_;
+    }
+
+    bool is_halt_requested()
+    {
+        std::lock_guard<std::mutex> LockGuard(is_halt_requested_mutex_);
+        return is_halt_requested_;
+    }
+
+    void halt_requested(bool is_halt_requested)
+    {
+        std::lock_guard<std::mutex> LockGuard(is_halt_requested_mutex_);
+        is_halt_requested_ = is_halt_requested;
+    }
+
+private:
+    std::string name_;
+    bool is_halt_requested_;
+    BT::ReturnStatus status_;
+    BT::ReturnStatus color_status_;
+    std::mutex is_halt_requested_mutex_;
+    std::mutex state_mutex_;
+    std::mutex color_state_mutex_;
+    NullBuffer null_buffer_;
+    // std::cout in the original
+    std::ostream console_;
+};
+
+
+// Many parents (threads) polling the status of the same node, as the control nodes do at every tick,
+// while thread 0 keeps requesting and clearing the halt of the node.
+
+static void BM_LegacyGetStatus(benchmark::State& state)
+{
+    static LegacyTreeNode node("condition");
+    bool halt = false;
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            node.halt_requested(halt = !halt);
+        }
+        benchmark::DoNotOptimize(node.get_status());
+        benchmark::DoNotOptimize(node.is_halt_requested());
+    }
+}
+BENCHMARK(BM_LegacyGetStatus)->ThreadRange(1, 16)->UseRealTime();
+
+
+static void BM_PackedGetStatus(benchmark::State& state)
+{
+    static BT::ConditionTestNode node("condition");
+    bool halt = false;
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            node.halt_requested(halt = !halt);
+        }
+        benchmark::DoNotOptimize(node.get_status());
+        benchmark::DoNotOptimize(node.is_halt_requested());
+    }
+}
+BENCHMARK(BM_PackedGetStatus)->ThreadRange(1, 16)->UseRealTime();
+
+
+// The transition done by an action that completes its halt (status set to HALTED and halt request cleared).
+
+static void BM_LegacySetHalted(benchmark::State& state)
+{
+    static LegacyTreeNode node("condition");
+
+    for (auto _ : state)
+    {
+        node.set_status(BT::HALTED);
+        node.halt_requested(false);
+    }
+}
+BENCHMARK(BM_LegacySetHalted)->ThreadRange(1, 16)->UseRealTime();
+
+
+static void BM_PackedSetHalted(benchmark::State& state)
+{
+    static BT::ConditionTestNode node("condition");
+
+    for (auto _ : state)
+    {
+        node.set_halted();
+    }
+}
+BENCHMARK(BM_PackedSetHalted)->ThreadRange(1, 16)->UseRealTime();
@@ -0,0 +1,92 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <condition_test_node.h>
+#include <sequence_node.h>
+#include <fallback_node.h>
+#include <tick_program.h>
+#include <static_tree.h>
+
+
+// A sequence of fallbacks, each with 9 failing conditions followed by a succeeding one:
+// every node of the tree is ticked at every tick.
+static BT::SequenceNode* CreateTree(int nodes_number)
+{
+    BT::SequenceNode* root = new BT::SequenceNode("root");
+
+    for (int i = 0; i < (nodes_number - 1) / 11; i++)
+    {
+        BT::FallbackNode* fallback = new BT::FallbackNode("fallback");
+        for (int j = 0; j < 10; j++)
+        {
+            BT::ConditionTestNode* condition = new BT::ConditionTestNode("condition");
+            condition->set_boolean_value(j == 9);
+            fallback->AddChild(condition);
+        }
+        root->AddChild(fallback);
+    }
+    return root;
+}
+
+
+static void BM_ObjectTreeTick(benchmark::State& state)
+{
+    BT::SequenceNode* root = CreateTree(state.range(0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(root->Tick());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ObjectTreeTick)->RangeMultiplier(10)->Range(100, 100000);
+
+
+static void BM_TickProgramTick(benchmark::State& state)
+{
+    BT::TickProgram program(CreateTree(state.range(0)));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(program.Tick());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TickProgramTick)->RangeMultiplier(10)->Range(100, 100000);
+
+
+template <bool value>
+struct Constant
+{
+    bool operator()() { return value; }
+};
+
+// The tree of CreateTree(100), composed at compile time
+typedef BT::Static::Cond<Constant<false> > FailingCondition;
+typedef BT::Static::Fallback<FailingCondition, FailingCondition, FailingCondition, FailingCondition,
+                             FailingCondition, FailingCondition, FailingCondition, FailingCondition,
+                             FailingCondition, BT::Static::Cond<Constant<true> > > StaticFallback;
+typedef BT::Static::Sequence<StaticFallback, StaticFallback, StaticFallback, StaticFallback, StaticFallback,
+                             StaticFallback, StaticFallback, StaticFallback, StaticFallback> StaticRoot;
+
+static void BM_StaticTreeTick(benchmark::State& state)
+{
+    BT::Static::Tree<StaticRoot> tree;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(tree.Tick());
+    }
+    state.SetItemsProcessed(state.iterations() * 100);
+}
+BENCHMARK(BM_StaticTreeTick);
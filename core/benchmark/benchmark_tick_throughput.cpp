@@ -0,0 +1,284 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <condition_test_node.h>
+#include <action_node.h>
+#include <sequence_node.h>
+#include <fallback_node.h>
+#include <parallel_node.h>
+#include <sequence_node_with_memory.h>
+#include <fallback_node_with_memory.h>
+#include <node_metrics.h>
+#include <tree_arena.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+
+// Tick throughput of the object tree for a few tree shapes, with synthetic actions that finish instantly.
+// Besides the time per tick, each benchmark reports (as counters): ticks/s, p50 and p99 tick latency,
+// p50 and p99 action hand-off latency (time spent by a tick in the executor queue), number of threads
+// of the process and bytes per node. BM_HaltLatency reports the time to halt N running actions.
+// The trees are built in a BT::BehaviorTree, which owns their nodes.
+
+namespace
+{
+    // hand-off latencies of the current benchmark
+    std::atomic<BT::Metrics::Histogram*> hand_off_histogram_(NULL);
+
+    int64_t ToNanoseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    class InstantAction : public BT::ActionNode
+    {
+    public:
+        InstantAction(std::string name) : ActionNode(name) {}
+
+        BT::ReturnStatus Tick()
+        {
+            BT::Metrics::Histogram* histogram = hand_off_histogram_.load();
+            if (histogram != NULL)
+            {
+                histogram->Record(ToNanoseconds(get_tick().get_queue_latency()));
+            }
+            return BT::SUCCESS;
+        }
+
+        void Halt() {}
+    };
+
+    // Runs until it is halted
+    class EndlessAction : public BT::ActionNode
+    {
+    public:
+        EndlessAction(std::string name) : ActionNode(name) {}
+
+        BT::ReturnStatus Tick()
+        {
+            while (!is_halt_requested())
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            return BT::HALTED;
+        }
+
+        void Halt() {}
+    };
+
+    BT::ConditionTestNode* CreateCondition(BT::BehaviorTree* tree, bool boolean_value)
+    {
+        BT::ConditionTestNode* condition = tree->CreateNode<BT::ConditionTestNode>("condition");
+        condition->set_boolean_value(boolean_value);
+        return condition;
+    }
+
+    // A chain of sequences, each with a condition and the next sequence; the last one has an action
+    BT::ControlNode* CreateDeepTree(BT::BehaviorTree* tree, int nodes_number)
+    {
+        BT::SequenceNode* root = tree->CreateNode<BT::SequenceNode>("root");
+        BT::SequenceNode* sequence = root;
+        for (int i = 0; i < (nodes_number - 2) / 2; i++)
+        {
+            BT::SequenceNode* child = tree->CreateNode<BT::SequenceNode>("sequence");
+            sequence->AddChild(CreateCondition(tree, true));
+            sequence->AddChild(child);
+            sequence = child;
+        }
+        sequence->AddChild(tree->CreateNode<InstantAction>("action"));
+        return root;
+    }
+
+    // A single sequence with 9 conditions every action
+    BT::ControlNode* CreateWideTree(BT::BehaviorTree* tree, int nodes_number)
+    {
+        BT::SequenceNode* root = tree->CreateNode<BT::SequenceNode>("root");
+        for (int i = 0; i < nodes_number - 1; i++)
+        {
+            if (i % 10 == 9)
+            {
+                root->AddChild(tree->CreateNode<InstantAction>("action"));
+            }
+            else
+            {
+                root->AddChild(CreateCondition(tree, true));
+            }
+        }
+        return root;
+    }
+
+    // A parallel of sequences (condition, action) that succeeds when all of them succeed
+    BT::ControlNode* CreateParallelTree(BT::BehaviorTree* tree, int nodes_number)
+    {
+        int branches_number = (nodes_number - 1) / 3;
+        BT::ParallelNode* root = tree->CreateNode<BT::ParallelNode>("root", branches_number);
+        for (int i = 0; i < branches_number; i++)
+        {
+            BT::SequenceNode* sequence = tree->CreateNode<BT::SequenceNode>("sequence");
+            sequence->AddChild(CreateCondition(tree, true));
+            sequence->AddChild(tree->CreateNode<InstantAction>("action"));
+            root->AddChild(sequence);
+        }
+        return root;
+    }
+
+    // A sequence with memory of fallbacks with memory (failing condition, action)
+    BT::ControlNode* CreateMemoryTree(BT::BehaviorTree* tree, int nodes_number)
+    {
+        BT::SequenceNodeWithMemory* root = tree->CreateNode<BT::SequenceNodeWithMemory>("root");
+        for (int i = 0; i < (nodes_number - 1) / 3; i++)
+        {
+            BT::FallbackNodeWithMemory* fallback = tree->CreateNode<BT::FallbackNodeWithMemory>("fallback");
+            fallback->AddChild(CreateCondition(tree, false));
+            fallback->AddChild(tree->CreateNode<InstantAction>("action"));
+            root->AddChild(fallback);
+        }
+        return root;
+    }
+
+    // The nodes themselves (in the arena of the tree) and their side tables and metrics
+    size_t GetTreeBytes(BT::BehaviorTree* tree)
+    {
+        size_t tree_bytes = tree->get_allocated_bytes();
+        std::vector<BT::NodeTypeMemory> memory_report = tree->GetMemoryReport();
+        for (unsigned int i = 0; i < memory_report.size(); i++)
+        {
+            tree_bytes += memory_report[i].side_tables_bytes;
+        }
+        return tree_bytes;
+    }
+
+    unsigned int CountNodes(BT::TreeNode* node)
+    {
+        unsigned int nodes_number = 1;
+        if (node->get_type() == BT::CONTROL_NODE)
+        {
+            std::vector<BT::TreeNode*> children = static_cast<BT::ControlNode*>(node)->GetChildren();
+            for (unsigned int i = 0; i < children.size(); i++)
+            {
+                nodes_number += CountNodes(children[i]);
+            }
+        }
+        return nodes_number;
+    }
+
+    // Threads of the process (Linux only, 0 elsewhere)
+    int GetThreadsNumber()
+    {
+        std::ifstream status_file("/proc/self/status");
+        std::string line;
+        while (std::getline(status_file, line))
+        {
+            if (line.compare(0, 8, "Threads:") == 0)
+            {
+                return std::atoi(line.c_str() + 8);
+            }
+        }
+        return 0;
+    }
+
+    void RunTickBenchmark(benchmark::State& state,
+                          BT::ControlNode* (*create_tree)(BT::BehaviorTree* tree, int nodes_number))
+    {
+        BT::Metrics::Histogram tick_histogram;
+        BT::Metrics::Histogram hand_off_histogram;
+        // destroyed before the histograms: its destructor waits for the actions still in flight
+        BT::BehaviorTree tree;
+        BT::ControlNode* root = create_tree(&tree, state.range(0));
+        tree.set_root(root);
+        unsigned int nodes_number = CountNodes(root);
+        hand_off_histogram_.store(&hand_off_histogram);
+
+        for (auto _ : state)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            benchmark::DoNotOptimize(root->Tick());
+            tick_histogram.Record(ToNanoseconds(std::chrono::steady_clock::now() - start));
+        }
+
+        // the actions still running are not measured any more
+        hand_off_histogram_.store(NULL);
+        root->Halt();
+        // the side tables are filled by the ticks
+        size_t tree_bytes = GetTreeBytes(&tree);
+
+        state.counters["ticks/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+        state.counters["p50_us"] = tick_histogram.get_percentile(50) / 1000.0;
+        state.counters["p99_us"] = tick_histogram.get_percentile(99) / 1000.0;
+        state.counters["hand_off_p50_us"] = hand_off_histogram.get_percentile(50) / 1000.0;
+        state.counters["hand_off_p99_us"] = hand_off_histogram.get_percentile(99) / 1000.0;
+        state.counters["threads"] = GetThreadsNumber();
+        state.counters["bytes/node"] = (double)tree_bytes / nodes_number;
+    }
+}
+
+
+static void BM_DeepTreeTick(benchmark::State& state)
+{
+    RunTickBenchmark(state, &CreateDeepTree);
+}
+BENCHMARK(BM_DeepTreeTick)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_WideTreeTick(benchmark::State& state)
+{
+    RunTickBenchmark(state, &CreateWideTree);
+}
+BENCHMARK(BM_WideTreeTick)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_ParallelTreeTick(benchmark::State& state)
+{
+    RunTickBenchmark(state, &CreateParallelTree);
+}
+BENCHMARK(BM_ParallelTreeTick)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_MemoryTreeTick(benchmark::State& state)
+{
+    RunTickBenchmark(state, &CreateMemoryTree);
+}
+BENCHMARK(BM_MemoryTreeTick)->RangeMultiplier(10)->Range(10, 10000);
+
+
+// Time to halt a parallel node with N running actions
+static void BM_HaltLatency(benchmark::State& state)
+{
+    BT::BehaviorTree tree;
+    BT::ParallelNode& root = *tree.CreateNode<BT::ParallelNode>("root", state.range(0));
+    tree.set_root(&root);
+    for (int i = 0; i < state.range(0); i++)
+    {
+        root.AddChild(tree.CreateNode<EndlessAction>("action"));
+    }
+
+    BT::Metrics::Histogram halt_histogram;
+    for (auto _ : state)
+    {
+        root.Tick();
+        // lets the workers start the actions
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        root.Halt();
+        std::chrono::steady_clock::duration halt_time = std::chrono::steady_clock::now() - start;
+
+        state.SetIterationTime(std::chrono::duration<double>(halt_time).count());
+        halt_histogram.Record(ToNanoseconds(halt_time));
+    }
+
+    state.counters["p50_us"] = halt_histogram.get_percentile(50) / 1000.0;
+    state.counters["p99_us"] = halt_histogram.get_percentile(99) / 1000.0;
+    state.counters["threads"] = GetThreadsNumber();
+}
+BENCHMARK(BM_HaltLatency)->RangeMultiplier(4)->Range(1, 64)->UseManualTime();
@@ -15,10 +15,41 @@
 #include <action_test_node.h>
 #include <condition_test_node.h>
 #include <behavior_tree.h>
+#include <fstream>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 
-struct SimpleSequenceTest : testing::Test
+// The tree fixtures run in virtual time: the sleeps of the test nodes and of the tests, and the waits
+// for the halts, take no real time. The clock is never deleted, like the nodes of the fixtures
+// (actions that are not halted by their test may still be running after it)
+struct VirtualTimeTest : testing::Test
+{
+    static BT::VirtualClock* GetClock()
+    {
+        static BT::VirtualClock* clock = new BT::VirtualClock();
+        return clock;
+    }
+
+    void SetUp()
+    {
+        BT::SetDefaultClock(GetClock());
+        // the test thread ticks the trees
+        GetClock()->BeginActivity();
+    }
+
+    void TearDown()
+    {
+        GetClock()->EndActivity();
+        BT::SetDefaultClock(NULL);
+    }
+};
+
+
+struct SimpleSequenceTest : VirtualTimeTest
 {
     BT:: SequenceNode* root;
     BT::ActionTestNode* action;
@@ -36,7 +67,7 @@ struct SimpleSequenceTest : testing::Test
 };
 
 
-struct ComplexSequenceTest : testing::Test
+struct ComplexSequenceTest : VirtualTimeTest
 {
     BT:: SequenceNode* root;
     BT::ActionTestNode* action_1;
@@ -63,7 +94,7 @@ struct ComplexSequenceTest : testing::Test
 };
 
 
-struct ComplexSequence2ActionsTest : testing::Test
+struct ComplexSequence2ActionsTest : VirtualTimeTest
 {
     BT:: SequenceNode* root;
     BT::ActionTestNode* action_1;
@@ -99,7 +130,7 @@ struct ComplexSequence2ActionsTest : testing::Test
 };
 
 
-struct SimpleFallbackTest : testing::Test
+struct SimpleFallbackTest : VirtualTimeTest
 {
     BT:: FallbackNode* root;
     BT::ActionTestNode* action;
@@ -117,7 +148,7 @@ struct SimpleFallbackTest : testing::Test
 };
 
 
-struct ComplexFallbackTest : testing::Test
+struct ComplexFallbackTest : VirtualTimeTest
 {
     BT:: FallbackNode* root;
     BT::ActionTestNode* action_1;
@@ -145,7 +176,7 @@ struct ComplexFallbackTest : testing::Test
 
 
 
-struct BehaviorTreeTest : testing::Test
+struct BehaviorTreeTest : VirtualTimeTest
 {
     BT:: SequenceNode* root;
     BT::ActionTestNode* action_1;
@@ -170,7 +201,7 @@ struct BehaviorTreeTest : testing::Test
     }
 };
 
-struct ComplexBehaviorTreeTest : testing::Test
+struct ComplexBehaviorTreeTest : VirtualTimeTest
 {
     BT:: SequenceNode* root;
     BT::ActionTestNode* action_1;
@@ -198,7 +229,7 @@ struct ComplexBehaviorTreeTest : testing::Test
 
 
 
-struct SimpleSequenceWithMemoryTest : testing::Test
+struct SimpleSequenceWithMemoryTest : VirtualTimeTest
 {
     BT:: SequenceNodeWithMemory* root;
     BT::ActionTestNode* action;
@@ -215,7 +246,7 @@ struct SimpleSequenceWithMemoryTest : testing::Test
     }
 };
 
-struct ComplexSequenceWithMemoryTest : testing::Test
+struct ComplexSequenceWithMemoryTest : VirtualTimeTest
 {
     BT:: SequenceNodeWithMemory* root;
 
@@ -252,7 +283,7 @@ struct ComplexSequenceWithMemoryTest : testing::Test
     }
 };
 
-struct SimpleFallbackWithMemoryTest : testing::Test
+struct SimpleFallbackWithMemoryTest : VirtualTimeTest
 {
     BT::FallbackNodeWithMemory* root;
     BT::ActionTestNode* action;
@@ -269,7 +300,7 @@ struct SimpleFallbackWithMemoryTest : testing::Test
     }
 };
 
-struct ComplexFallbackWithMemoryTest : testing::Test
+struct ComplexFallbackWithMemoryTest : VirtualTimeTest
 {
     BT:: FallbackNodeWithMemory* root;
 
@@ -305,7 +336,7 @@ struct ComplexFallbackWithMemoryTest : testing::Test
 };
 
 
-struct SimpleParallelTest : testing::Test
+struct SimpleParallelTest : VirtualTimeTest
 {
     BT::ParallelNode* root;
     BT::ActionTestNode* action_1;
@@ -333,7 +364,7 @@ struct SimpleParallelTest : testing::Test
 };
 
 
-struct ComplexParallelTest : testing::Test
+struct ComplexParallelTest : VirtualTimeTest
 {
     BT::ParallelNode* root;
     BT::ParallelNode* parallel_1;
@@ -595,7 +626,7 @@ TEST_F(SimpleSequenceWithMemoryTest, ConditionTrue)
     std::cout << "Ticking the root node !" << std::endl << std::endl;
     // Ticking the root node
     BT::ReturnStatus state = root->Tick();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    BT::GetDefaultClock()->SleepFor(std::chrono::seconds(1));
 
     ASSERT_EQ(BT::RUNNING, action->get_status());
     ASSERT_EQ(BT::RUNNING, state);
@@ -666,7 +697,7 @@ TEST_F(ComplexSequenceWithMemoryTest, Action1Done)
     condition_2->set_boolean_value(false);
 
     root->Tick();
-    std::this_thread::sleep_for(std::chrono::seconds(10));
+    BT::GetDefaultClock()->SleepFor(std::chrono::seconds(10));
     root->Tick();
 
     ASSERT_EQ(BT::IDLE, action_1->get_status());
@@ -700,7 +731,7 @@ TEST_F(SimpleFallbackWithMemoryTest, ConditionFalse)
     // Ticking the root node
     condition->set_boolean_value(false);
     BT::ReturnStatus state = root->Tick();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    BT::GetDefaultClock()->SleepFor(std::chrono::seconds(1));
 
     ASSERT_EQ(BT::RUNNING, action->get_status());
     ASSERT_EQ(BT::RUNNING, state);
@@ -810,7 +841,7 @@ TEST_F(ComplexFallbackWithMemoryTest, Action1Failed)
     BT::ReturnStatus state = root->Tick();
 
     state = root->Tick();
-    std::this_thread::sleep_for(std::chrono::seconds(5));
+    BT::GetDefaultClock()->SleepFor(std::chrono::seconds(5));
     state = root->Tick();
 
     ASSERT_EQ(BT::IDLE, action_1->get_status());
@@ -840,7 +871,7 @@ TEST_F(SimpleParallelTest, Threshold_3)
     root->set_threshold_M(3);
     action_2->set_time(200);
     root->Tick();
-    std::this_thread::sleep_for(std::chrono::seconds(5));
+    BT::GetDefaultClock()->SleepFor(std::chrono::seconds(5));
     BT::ReturnStatus state = root->Tick();
 
     ASSERT_EQ(BT::IDLE, condition_1->get_status());
@@ -911,7 +942,7 @@ TEST_F(ComplexParallelTest, Condition3FalseAction1Done)
 
     condition_3->set_boolean_value(false);
     BT::ReturnStatus state = root->Tick();
-    std::this_thread::sleep_for(std::chrono::seconds(5));
+    BT::GetDefaultClock()->SleepFor(std::chrono::seconds(5));
 
 
     ASSERT_EQ(BT::IDLE, condition_1->get_status());
@@ -932,7 +963,7 @@ TEST_F(ComplexParallelTest, Condition3FalseAction1Done)
 
 
     state = root->Tick();
-    std::this_thread::sleep_for(std::chrono::seconds(15));
+    BT::GetDefaultClock()->SleepFor(std::chrono::seconds(15));
     state = root->Tick();
 
     ASSERT_EQ(BT::IDLE, parallel_2->get_status());
@@ -945,6 +976,2097 @@ TEST_F(ComplexParallelTest, Condition3FalseAction1Done)
     root->Halt();
 }
 
+TEST(WorkStealingExecutorTest, RunsAllTasks)
+{
+    BT::WorkStealingExecutor executor(2);
+    std::atomic<int> counter(0);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        executor.Submit([&counter]() { counter++; });
+    }
+    while (counter < 1000)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ASSERT_EQ(1000, counter);
+}
+
+
+TEST(WorkStealingExecutorTest, ManyActionsFewWorkers)
+{
+    BT::WorkStealingExecutor executor(2);
+    std::vector<BT::ActionTestNode*> actions;
+
+    for (int i = 0; i < 100; i++)
+    {
+        actions.push_back(new BT::ActionTestNode("action", &executor));
+        actions.back()->set_time(0);
+    }
+
+    for (unsigned int i = 0; i < actions.size(); i++)
+    {
+        actions[i]->SendTick();
+    }
+    for (unsigned int i = 0; i < actions.size(); i++)
+    {
+        while (actions[i]->get_status() == BT::RUNNING)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(BT::SUCCESS, actions[i]->get_status());
+    }
+}
+
+
+TEST(WorkStealingExecutorTest, GrowsWhenBusy)
+{
+    // one worker, blocked by the first action: the second one starts anyway
+    BT::WorkStealingExecutor executor(1);
+    BT::ActionTestNode action_1("action_1", &executor);
+    BT::ActionTestNode action_2("action_2", &executor);
+    action_1.set_time(1);
+    action_2.set_time(0);
+
+    action_1.SendTick();
+    action_2.SendTick();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (action_2.get_status() != BT::SUCCESS)
+    {
+        ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(2u, executor.get_workers_number());
+    ASSERT_EQ(0u, executor.get_saturated_submits_number());
+    ASSERT_EQ(BT::RUNNING, action_1.get_status());
+    while (action_1.get_status() == BT::RUNNING)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // a fixed-size pool does not grow
+    BT::WorkStealingExecutor fixed_executor(1, 1);
+    std::atomic<bool> is_started(false);
+    std::atomic<bool> is_released(false);
+    std::atomic<int> done_tasks_number(0);
+    fixed_executor.Submit([&is_started, &is_released, &done_tasks_number]()
+    {
+        is_started = true;
+        while (!is_released)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        done_tasks_number++;
+    });
+    while (!is_started)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    fixed_executor.Submit([&done_tasks_number]() { done_tasks_number++; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    int queued_done_tasks_number = done_tasks_number;
+    is_released = true;
+    ASSERT_EQ(0, queued_done_tasks_number);
+    ASSERT_EQ(1u, fixed_executor.get_workers_number());
+    // the queued task has been counted
+    ASSERT_EQ(1u, fixed_executor.get_saturated_submits_number());
+    while (done_tasks_number < 2)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+
+TEST_F(ComplexSequenceTest, TickProgramConditions1ToFalse)
+{
+    BT::TickProgram program(root);
+    BT::ReturnStatus state = program.Tick();
+
+    ASSERT_EQ(5u, program.get_nodes_number());
+    ASSERT_EQ(BT::RUNNING, state);
+    ASSERT_EQ(BT::RUNNING, action_1->get_status());
+
+    condition_1->set_boolean_value(false);
+    state = program.Tick();
+
+    ASSERT_EQ(BT::FAILURE, state);
+    ASSERT_EQ(BT::HALTED, action_1->get_status());
+    program.Halt();
+}
+
+
+TEST_F(SimpleParallelTest, TickProgramThreshold_1)
+{
+    root->set_threshold_M(1);
+    BT::TickProgram program(root);
+    BT::ReturnStatus state = program.Tick();
+
+    ASSERT_EQ(BT::IDLE, action_1->get_status());
+    ASSERT_EQ(BT::IDLE, action_2->get_status());
+    ASSERT_EQ(BT::SUCCESS, state);
+}
+
+
+TEST(TickProgramTest, NodeWithMemoryNotCompiled)
+{
+    BT::SequenceNodeWithMemory root("root");
+    root.AddChild(new BT::ConditionTestNode("condition"));
+
+    ASSERT_THROW(BT::TickProgram program(&root), BT::BehaviorTreeException);
+}
+
+
+TEST(ConcurrentParallelTest, SlowConditions)
+{
+    BT::WorkStealingExecutor executor(8);
+    BT::ParallelNode root("par", 8, &executor);
+
+    for (int i = 0; i < 8; i++)
+    {
+        BT::ConditionTestNode* condition = new BT::ConditionTestNode("condition");
+        condition->set_time_milliseconds(200);
+        root.AddChild(condition);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BT::ReturnStatus state = root.Tick();
+    std::chrono::steady_clock::duration tick_time = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(BT::SUCCESS, state);
+    // the sequential tick takes 8 * 200 ms
+    ASSERT_LT(tick_time, std::chrono::milliseconds(800));
+}
+
+
+TEST(ConcurrentParallelTest, FailureThreshold)
+{
+    BT::WorkStealingExecutor executor(4);
+    BT::ParallelNode root("par", 3, &executor);
+    BT::ActionTestNode* action = new BT::ActionTestNode("action", &executor);
+
+    root.AddChild(action);
+    for (int i = 0; i < 3; i++)
+    {
+        BT::ConditionTestNode* condition = new BT::ConditionTestNode("condition");
+        condition->set_boolean_value(i == 0);
+        root.AddChild(condition);
+    }
+
+    // 2 failures out of 4 children: the threshold of 3 successes cannot be reached
+    BT::ReturnStatus state = root.Tick();
+
+    ASSERT_EQ(BT::FAILURE, state);
+    ASSERT_EQ(BT::HALTED, action->get_status());
+}
+
+
+TEST(TickSchedulerTest, FixedRate)
+{
+    BT::TickScheduler scheduler(std::chrono::milliseconds(10));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 21; i++)
+    {
+        scheduler.WaitForNextTick();
+        // the tick time does not delay the next tick
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::chrono::steady_clock::duration elapsed_time = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(21u, scheduler.get_ticks_number());
+    ASSERT_EQ(0u, scheduler.get_overruns_number());
+    ASSERT_GE(elapsed_time, std::chrono::milliseconds(205));
+    ASSERT_LT(elapsed_time, std::chrono::milliseconds(260));
+}
+
+
+TEST(TickSchedulerTest, SkipMissedTicks)
+{
+    BT::TickScheduler scheduler(std::chrono::milliseconds(10), BT::SKIP_MISSED_TICKS);
+
+    scheduler.WaitForNextTick();
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    scheduler.WaitForNextTick();
+
+    ASSERT_EQ(1u, scheduler.get_overruns_number());
+    ASSERT_EQ(2u, scheduler.get_skipped_ticks_number());
+}
+
+
+TEST(TickSchedulerTest, CatchUp)
+{
+    BT::TickScheduler scheduler(std::chrono::milliseconds(10), BT::CATCH_UP);
+
+    scheduler.WaitForNextTick();
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+
+    // the ticks at 10 and 20 ms are executed immediately, the one at 30 ms on time
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    scheduler.WaitForNextTick();
+    scheduler.WaitForNextTick();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(2));
+    scheduler.WaitForNextTick();
+
+    ASSERT_EQ(2u, scheduler.get_overruns_number());
+    ASSERT_EQ(0u, scheduler.get_skipped_ticks_number());
+}
+
+
+TEST(TickTriggerTest, WakesUpOnTrigger)
+{
+    BT::TickTrigger tick_trigger;
+
+    ASSERT_FALSE(tick_trigger.WaitForTrigger(std::chrono::milliseconds(0)));
+
+    std::thread trigger_thread([&tick_trigger]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        tick_trigger.Trigger();
+        tick_trigger.Trigger();
+    });
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(tick_trigger.WaitForTrigger(std::chrono::seconds(10)));
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    trigger_thread.join();
+
+    // the two triggers have been coalesced
+    ASSERT_FALSE(tick_trigger.WaitForTrigger(std::chrono::milliseconds(0)));
+    ASSERT_EQ(2u, tick_trigger.get_triggers_number());
+}
+
+
+TEST(TickTriggerTest, ActionCompletion)
+{
+    BT::ActionTestNode action("action");
+    action.set_time(0);
+    action.set_boolean_value(true);
+
+    BT::GetDefaultTickTrigger()->WaitForTrigger(std::chrono::milliseconds(0));
+
+    action.SendTick();
+    // the action sets its status before triggering
+    ASSERT_TRUE(BT::GetDefaultTickTrigger()->WaitForTrigger(std::chrono::seconds(1)));
+    ASSERT_EQ(BT::SUCCESS, action.get_status());
+}
+
+
+TEST(TickTriggerTest, BlackBoardWrite)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<int32_t> target = blackboard.Intern<int32_t>("target");
+    BT::SequenceNode root("root");
+    BT::ConditionTestNode condition("condition");
+    root.AddChild(&condition);
+
+    // the loop of ExecuteReactive(), with a period long enough that only the trigger can tick the tree
+    BT::GetDefaultTickTrigger()->WaitForTrigger(std::chrono::milliseconds(0));
+    std::atomic<bool> is_done(false);
+    std::thread tree_thread([&root, &is_done]()
+    {
+        while (!is_done)
+        {
+            root.Tick();
+            BT::GetDefaultTickTrigger()->WaitForTrigger(std::chrono::seconds(10));
+        }
+    });
+    while (condition.get_ticks_number() == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(1, condition.get_ticks_number());
+
+    // an in-process write ticks the tree at once
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    blackboard.Set(target, 1);
+    while (condition.get_ticks_number() == 1
+           && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    ASSERT_EQ(2, condition.get_ticks_number());
+
+    // unless the blackboard has no tick trigger
+    blackboard.set_tick_trigger(NULL);
+    blackboard.SetByName<int32_t>("target", 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(2, condition.get_ticks_number());
+
+    is_done = true;
+    BT::GetDefaultTickTrigger()->Trigger();
+    tree_thread.join();
+}
+
+TEST(ConditionMemoizationTest, SharedConditionTickedOncePerEpoch)
+{
+    BT::SequenceNode root("root");
+    BT::SequenceNode sequence_1("sequence_1");
+    BT::SequenceNode sequence_2("sequence_2");
+    BT::ConditionTestNode condition("condition");
+
+    // the same condition under two parents
+    sequence_1.AddChild(&condition);
+    sequence_2.AddChild(&condition);
+    root.AddChild(&sequence_1);
+    root.AddChild(&sequence_2);
+
+    BT::SetConditionMemoization(true);
+
+    // outside any epoch (the root is not a RootNode) the condition is evaluated by both parents
+    ASSERT_EQ(BT::SUCCESS, root.Tick());
+    ASSERT_EQ(2, condition.get_ticks_number());
+
+    // the result is the one of the first evaluation within the epoch
+    {
+        BT::TickEpochScope epoch;
+        ASSERT_EQ(BT::SUCCESS, root.Tick());
+        ASSERT_EQ(3, condition.get_ticks_number());
+        condition.set_boolean_value(false);
+        ASSERT_EQ(BT::SUCCESS, root.Tick());
+        ASSERT_EQ(3, condition.get_ticks_number());
+    }
+
+    {
+        BT::TickEpochScope epoch;
+        ASSERT_EQ(BT::FAILURE, root.Tick());
+        ASSERT_EQ(4, condition.get_ticks_number());
+    }
+
+    BT::SetConditionMemoization(false);
+
+    {
+        BT::TickEpochScope epoch;
+        ASSERT_EQ(BT::FAILURE, root.Tick());
+        ASSERT_EQ(5, condition.get_ticks_number());
+    }
+}
+
+
+TEST(ConditionMemoizationTest, EpochScopedToThread)
+{
+    ASSERT_EQ(0u, BT::GetTickEpoch());
+
+    uint64_t other_epoch = 0;
+    {
+        BT::TickEpochScope epoch;
+        uint64_t current_epoch = BT::GetTickEpoch();
+        ASSERT_NE(0u, current_epoch);
+
+        // a nested scope joins the open epoch
+        {
+            BT::TickEpochScope nested_epoch;
+            ASSERT_EQ(current_epoch, BT::GetTickEpoch());
+        }
+
+        // another thread (e.g. another tree) is outside it, and begins its own
+        std::thread other_thread([&other_epoch]()
+        {
+            if (BT::GetTickEpoch() == 0)
+            {
+                BT::TickEpochScope epoch;
+                other_epoch = BT::GetTickEpoch();
+            }
+        });
+        other_thread.join();
+        ASSERT_NE(0u, other_epoch);
+        ASSERT_NE(current_epoch, other_epoch);
+        ASSERT_EQ(current_epoch, BT::GetTickEpoch());
+    }
+
+    ASSERT_EQ(0u, BT::GetTickEpoch());
+}
+
+
+TEST(ConditionMemoizationTest, TickProgram)
+{
+    BT::RootNode root;
+    BT::ParallelNode parallel("parallel", 2);
+    BT::SequenceNode sequence_1("sequence_1");
+    BT::SequenceNode sequence_2("sequence_2");
+    BT::ConditionTestNode condition("condition");
+
+    sequence_1.AddChild(&condition);
+    sequence_2.AddChild(&condition);
+    parallel.AddChild(&sequence_1);
+    parallel.AddChild(&sequence_2);
+    root.AddChild(&parallel);
+
+    BT::TickProgram program(&root);
+
+    BT::SetConditionMemoization(true);
+    ASSERT_EQ(BT::SUCCESS, program.Tick());
+    ASSERT_EQ(BT::SUCCESS, program.Tick());
+    BT::SetConditionMemoization(false);
+
+    // one evaluation per tick of the program
+    ASSERT_EQ(2, condition.get_ticks_number());
+}
+
+
+TEST(HaltBroadcastTest, ActionsHaltedConcurrently)
+{
+    // dedicated workers: the actions start at once, whatever the other tests have left running
+    BT::WorkStealingExecutor executor(3);
+    BT::ParallelNode parallel("parallel", 3);
+    BT::ActionTestNode action_1("action_1", &executor);
+    BT::ActionTestNode action_2("action_2", &executor);
+    BT::ActionTestNode action_3("action_3", &executor);
+
+    BT::ActionTestNode* actions[3] = {&action_1, &action_2, &action_3};
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        actions[i]->set_time(10);
+        actions[i]->set_halt_time_milliseconds(300);
+        parallel.AddChild(actions[i]);
+    }
+
+    ASSERT_EQ(BT::RUNNING, parallel.Tick());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // halted one after the other, the actions would take more than 3 s
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    parallel.Halt();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(BT::HALTED, actions[i]->get_status());
+    }
+    ASSERT_EQ(BT::HALTED, parallel.get_status());
+}
+
+
+// As a YARP action: the tick returns RUNNING at once (the action runs in its module), the halt is a request
+// that blocks for halt_time
+class RemoteActionTestNode : public BT::ActionNode
+{
+public:
+    RemoteActionTestNode(std::string name, BT::Executor* executor, std::chrono::milliseconds halt_time)
+        : ActionNode(name, executor), halt_time_(halt_time), halts_number_(0)
+    {
+        type_ = BT::YARP_ACTION_NODE;
+    }
+
+    BT::ReturnStatus Tick() { return BT::RUNNING; }
+
+    void Halt()
+    {
+        std::this_thread::sleep_for(halt_time_);
+        halts_number_++;
+    }
+
+    int get_halts_number() { return halts_number_; }
+
+    // Until the task of the tick has returned: the halt is then sent by SendHalt()
+    void WaitForTick()
+    {
+        WaitForTickResponse();
+        WaitForTickReturn();
+    }
+
+private:
+    std::chrono::milliseconds halt_time_;
+    std::atomic<int> halts_number_;
+};
+
+
+TEST(HaltBroadcastTest, RemoteActionsHaltedConcurrently)
+{
+    BT::WorkStealingExecutor executor(3);
+    BT::ParallelNode parallel("parallel", 3);
+    BT::SequenceNode sequence("sequence");
+    RemoteActionTestNode action_1("action_1", &executor, std::chrono::milliseconds(300));
+    RemoteActionTestNode action_2("action_2", &executor, std::chrono::milliseconds(300));
+    RemoteActionTestNode action_3("action_3", &executor, std::chrono::milliseconds(300));
+    // one of them under a nested control node
+    parallel.AddChild(&action_1);
+    parallel.AddChild(&action_2);
+    sequence.AddChild(&action_3);
+    parallel.AddChild(&sequence);
+
+    ASSERT_EQ(BT::RUNNING, parallel.Tick());
+    RemoteActionTestNode* actions[3] = {&action_1, &action_2, &action_3};
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        actions[i]->WaitForTick();
+    }
+
+    // halted one after the other, the actions would take 900 ms
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    parallel.Halt();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(800));
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(BT::HALTED, actions[i]->get_status());
+        ASSERT_EQ(1, actions[i]->get_halts_number());
+    }
+    ASSERT_EQ(BT::HALTED, parallel.get_status());
+}
+
+
+TEST(HaltBroadcastTest, RemoteActionDeadline)
+{
+    BT::WorkStealingExecutor executor(1);
+    BT::SequenceNode sequence("sequence");
+    RemoteActionTestNode action("action", &executor, std::chrono::milliseconds(1000));
+    sequence.AddChild(&action);
+
+    ASSERT_EQ(BT::RUNNING, sequence.Tick());
+    action.WaitForTick();
+
+    BT::SetHaltDeadline(std::chrono::milliseconds(100));
+    unsigned long missed_deadlines_number = BT::GetMissedHaltDeadlinesNumber();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    sequence.Halt();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    ASSERT_EQ(missed_deadlines_number + 1, BT::GetMissedHaltDeadlinesNumber());
+
+    BT::SetHaltDeadline(std::chrono::milliseconds::max());
+
+    // the halt completes anyway, and is not sent again
+    ASSERT_EQ(BT::HALTED, action.WaitForHaltResponse());
+    ASSERT_EQ(1, action.get_halts_number());
+}
+
+
+TEST(HaltBroadcastTest, Deadline)
+{
+    BT::WorkStealingExecutor executor(1);
+    BT::SequenceNode sequence("sequence");
+    BT::ActionTestNode action("action", &executor);
+    action.set_time(10);
+    sequence.AddChild(&action);
+
+    ASSERT_EQ(BT::RUNNING, sequence.Tick());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    BT::SetHaltDeadline(std::chrono::milliseconds(100));
+    unsigned long missed_deadlines_number = BT::GetMissedHaltDeadlinesNumber();
+
+    // the action checks the halt request once per second
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    sequence.Halt();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    ASSERT_EQ(missed_deadlines_number + 1, BT::GetMissedHaltDeadlinesNumber());
+
+    BT::SetHaltDeadline(std::chrono::milliseconds::max());
+
+    // the halt completes anyway
+    ASSERT_EQ(BT::HALTED, action.WaitForHaltResponse());
+}
+
+
+TEST(TickDescriptorTest, IdsAndBudget)
+{
+    BT::ActionTestNode action("action");
+    action.set_time(0);
+
+    ASSERT_EQ(0u, action.get_tick().tick_id);
+
+    action.SendTick();
+    while (action.get_status() == BT::RUNNING)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(BT::SUCCESS, action.get_status());
+    ASSERT_EQ(1u, action.get_tick().tick_id);
+    // no deadline by default
+    ASSERT_EQ(std::chrono::steady_clock::duration::max(), action.get_tick().get_remaining_budget());
+    ASSERT_GE(action.get_tick().get_queue_latency().count(), 0);
+
+    action.set_status(BT::IDLE);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    action.SendTick(deadline);
+    while (action.get_status() == BT::RUNNING)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(BT::SUCCESS, action.get_status());
+    ASSERT_EQ(2u, action.get_tick().tick_id);
+    ASSERT_EQ(deadline, action.get_tick().deadline);
+    ASSERT_GT(action.get_tick().get_remaining_budget(), std::chrono::seconds(5));
+}
+
+
+TEST(SyncLinkTest, SharedByName)
+{
+    BT::DecoratorSync sync_1("sync_1", "gtest_shared_link");
+    BT::DecoratorSync sync_2("sync_2", "gtest_shared_link");
+
+    ASSERT_EQ(BT::GetSyncLink("gtest_shared_link"), BT::GetSyncLink("gtest_shared_link"));
+    ASSERT_NE(BT::GetSyncLink("gtest_shared_link"), BT::GetSyncLink("gtest_other_link"));
+    ASSERT_EQ(2u, BT::GetSyncLink("gtest_shared_link")->get_participants_number());
+}
+
+
+TEST(SyncLinkTest, LockStep)
+{
+    BT::DecoratorSync sync_1("sync_1", "gtest_lock_step_link");
+    BT::DecoratorSync sync_2("sync_2", "gtest_lock_step_link");
+    BT::ConditionTestNode condition_1("condition_1");
+    BT::ConditionTestNode condition_2("condition_2");
+
+    sync_1.AddChild(&condition_1);
+    sync_2.AddChild(&condition_2);
+
+    // sync_1 is done first and waits for sync_2
+    ASSERT_EQ(BT::RUNNING, sync_1.Tick());
+    ASSERT_EQ(BT::RUNNING, sync_1.Tick());
+    ASSERT_EQ(1, condition_1.get_ticks_number());
+    ASSERT_EQ(BT::SUCCESS, sync_2.Tick());
+    ASSERT_EQ(BT::SUCCESS, sync_1.Tick());
+    ASSERT_EQ(1u, BT::GetSyncLink("gtest_lock_step_link")->get_tick_id());
+
+    // the result of the child is returned once all the participants are done
+    condition_2.set_boolean_value(false);
+    ASSERT_EQ(BT::RUNNING, sync_2.Tick());
+    ASSERT_EQ(BT::SUCCESS, sync_1.Tick());
+    ASSERT_EQ(BT::FAILURE, sync_2.Tick());
+    ASSERT_EQ(2, condition_1.get_ticks_number());
+    ASSERT_EQ(2, condition_2.get_ticks_number());
+    ASSERT_EQ(2u, BT::GetSyncLink("gtest_lock_step_link")->get_tick_id());
+}
+
+
+TEST(SyncLinkTest, ConcurrentParticipants)
+{
+    const unsigned int steps_number = 1000;
+    BT::DecoratorSync sync_1("sync_1", "gtest_concurrent_link");
+    BT::DecoratorSync sync_2("sync_2", "gtest_concurrent_link");
+    BT::DecoratorSync sync_3("sync_3", "gtest_concurrent_link");
+    BT::DecoratorSync sync_4("sync_4", "gtest_concurrent_link");
+    BT::ConditionTestNode condition_1("condition_1");
+    BT::ConditionTestNode condition_2("condition_2");
+    BT::ConditionTestNode condition_3("condition_3");
+    BT::ConditionTestNode condition_4("condition_4");
+
+    BT::DecoratorSync* syncs[4] = {&sync_1, &sync_2, &sync_3, &sync_4};
+    BT::ConditionTestNode* conditions[4] = {&condition_1, &condition_2, &condition_3, &condition_4};
+
+    // each branch ticked by its own thread
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        syncs[i]->AddChild(conditions[i]);
+    }
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        BT::DecoratorSync* sync = syncs[i];
+        threads.push_back(std::thread([sync, steps_number]()
+        {
+            for (unsigned int step = 0; step < steps_number; step++)
+            {
+                while (sync->Tick() == BT::RUNNING)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        threads[i].join();
+    }
+
+    ASSERT_EQ(steps_number, BT::GetSyncLink("gtest_concurrent_link")->get_tick_id());
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ((int)steps_number, conditions[i]->get_ticks_number());
+    }
+}
+
+
+TEST(MetricsTest, HistogramBuckets)
+{
+    BT::Metrics::Histogram histogram;
+
+    for (unsigned int i = 0; i < BT::Metrics::Histogram::BUCKETS_NUMBER; i++)
+    {
+        uint64_t lower_bound = BT::Metrics::Histogram::BucketLowerBound(i);
+        ASSERT_EQ(i, BT::Metrics::Histogram::BucketIndex(lower_bound));
+        if (i > 0)
+        {
+            ASSERT_EQ(i - 1, BT::Metrics::Histogram::BucketIndex(lower_bound - 1));
+        }
+    }
+
+    ASSERT_EQ(0u, histogram.get_percentile(50));
+    for (uint64_t value_us = 1; value_us <= 1000; value_us++)
+    {
+        histogram.Record(value_us * 1000);
+    }
+    ASSERT_EQ(1000u, histogram.get_count());
+    ASSERT_EQ(1000000u, histogram.get_max());
+    // relative error below 12.5%
+    ASSERT_NEAR(500000.0, histogram.get_percentile(50), 500000.0 / 8);
+    ASSERT_NEAR(990000.0, histogram.get_percentile(99), 990000.0 / 8);
+    ASSERT_EQ(1000000u, histogram.get_percentile(100));
+}
+
+
+TEST(MetricsTest, NodeReport)
+{
+    BT::SequenceNode sequence("sequence");
+    BT::ConditionTestNode condition("condition");
+    BT::ActionTestNode action("action");
+    action.set_time(0);
+    sequence.AddChild(&condition);
+    sequence.AddChild(&action);
+
+    // nothing is recorded while the collection is disabled
+    while (sequence.Tick() != BT::SUCCESS)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(0u, BT::Metrics::CollectReport(&sequence).size());
+
+    BT::Metrics::SetEnabled(true);
+    for (int i = 0; i < 3; i++)
+    {
+        while (sequence.Tick() != BT::SUCCESS)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    action.set_time(10);
+    ASSERT_EQ(BT::RUNNING, sequence.Tick());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    sequence.Halt();
+    BT::Metrics::SetEnabled(false);
+
+    std::vector<BT::Metrics::NodeReport> report = BT::Metrics::CollectReport(&sequence);
+    ASSERT_EQ(3u, report.size());
+    ASSERT_EQ("sequence", report[0].name);
+    ASSERT_EQ("condition", report[1].name);
+    // the condition is ticked again while the action is running
+    ASSERT_GE(report[1].tick_duration.count, 4u);
+    ASSERT_GE(report[1].successes_number, 1u);
+    ASSERT_EQ("action", report[2].name);
+    ASSERT_EQ(4u, report[2].tick_duration.count);
+    ASSERT_EQ(3u, report[2].successes_number);
+    ASSERT_EQ(4u, report[2].running_time.count);
+    ASSERT_EQ(1u, report[2].halt_latency.count);
+    ASSERT_EQ(1u, report[0].halt_latency.count);
+
+    std::ostringstream stream;
+    BT::Metrics::PrintReport(report, stream);
+    ASSERT_NE(std::string::npos, stream.str().find("action"));
+}
+
+
+TEST(TraceTest, DrainsAllThreads)
+{
+    const char* file_name = "btpp_gtest_trace.bin";
+    ASSERT_TRUE(BT::Trace::Start(file_name));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.push_back(std::thread([]()
+        {
+            for (int j = 0; j < 100; j++)
+            {
+                BT::Trace::Record(BT::Trace::SET_STATUS, "node", BT::SUCCESS);
+            }
+        }));
+    }
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+    BT::Trace::Stop();
+
+    FILE* file = fopen(file_name, "rb");
+    ASSERT_TRUE(file != NULL);
+    char magic[8];
+    uint32_t event_size;
+    ASSERT_EQ(1u, fread(magic, sizeof(magic), 1, file));
+    ASSERT_EQ(1u, fread(&event_size, sizeof(event_size), 1, file));
+    ASSERT_EQ(sizeof(BT::Trace::Event), event_size);
+
+    BT::Trace::Event event;
+    unsigned int events_number = 0;
+    while (fread(&event, sizeof(event), 1, file) == 1)
+    {
+        ASSERT_EQ(BT::Trace::SET_STATUS, event.type);
+        ASSERT_STREQ("node", event.text);
+        events_number++;
+    }
+    fclose(file);
+    remove(file_name);
+
+    ASSERT_EQ(400u, events_number);
+}
+
+
+TEST(VirtualClockTest, SleepsWithoutWaiting)
+{
+    BT::VirtualClock clock;
+    std::chrono::steady_clock::time_point start = clock.Now();
+    std::chrono::steady_clock::time_point real_start = std::chrono::steady_clock::now();
+
+    clock.BeginActivity();
+    clock.SleepFor(std::chrono::hours(1));
+    ASSERT_EQ(start + std::chrono::hours(1), clock.Now());
+    clock.EndActivity();
+
+    // outside of an activity the clock would never move
+    ASSERT_THROW(clock.SleepFor(std::chrono::seconds(1)), BT::BehaviorTreeException);
+    ASSERT_LT(std::chrono::steady_clock::now() - real_start, std::chrono::milliseconds(500));
+}
+
+TEST(VirtualClockTest, SimulatedMission)
+{
+    BT::VirtualClock clock;
+    BT::WorkStealingExecutor executor(2);
+    BT::SetDefaultClock(&clock);
+    clock.BeginActivity();
+    std::chrono::steady_clock::time_point real_start = std::chrono::steady_clock::now();
+
+    BT::SequenceNode root("root");
+    BT::ConditionTestNode condition("condition");
+    BT::ActionTestNode action_1("action_1", &executor);
+    BT::ActionTestNode action_2("action_2", &executor);
+    condition.set_time_milliseconds(100);
+    action_1.set_time(3);
+    action_2.set_time(10);
+    root.AddChild(&condition);
+    root.AddChild(&action_1);
+    root.AddChild(&action_2);
+
+    // a tick every 100 ms: action_1 takes 3 s, then action_2 is halted after 2 s
+    std::chrono::steady_clock::time_point start = clock.Now();
+    while (action_2.get_status() != BT::RUNNING)
+    {
+        root.Tick();
+        clock.SleepFor(std::chrono::milliseconds(100));
+    }
+    std::chrono::steady_clock::duration action_1_time = clock.Now() - start;
+    ASSERT_GE(action_1_time, std::chrono::seconds(3));
+    ASSERT_LT(action_1_time, std::chrono::milliseconds(3500));
+
+    clock.SleepFor(std::chrono::seconds(2));
+    ASSERT_EQ(BT::RUNNING, action_2.get_status());
+    root.Halt();
+    ASSERT_EQ(BT::HALTED, action_2.get_status());
+
+    // the whole mission has been simulated faster than real time
+    ASSERT_GE(clock.Now() - start, std::chrono::seconds(5));
+    ASSERT_LT(std::chrono::steady_clock::now() - real_start, std::chrono::seconds(2));
+
+    clock.EndActivity();
+    BT::SetDefaultClock(NULL);
+}
+
+TEST(VirtualClockTest, TickScheduler)
+{
+    BT::VirtualClock clock;
+    BT::SetDefaultClock(&clock);
+    clock.BeginActivity();
+
+    BT::TickScheduler scheduler(std::chrono::seconds(1));
+    std::chrono::steady_clock::time_point start = clock.Now();
+    for (int i = 0; i < 100; i++)
+    {
+        scheduler.WaitForNextTick();
+    }
+    // the first tick starts at once
+    ASSERT_EQ(start + std::chrono::seconds(99), clock.Now());
+    ASSERT_EQ(0u, scheduler.get_overruns_number());
+    ASSERT_EQ(0, scheduler.get_max_jitter().count());
+
+    clock.EndActivity();
+    BT::SetDefaultClock(NULL);
+}
+
+
+TEST(TreeArenaTest, Allocate)
+{
+    BT::TreeArena arena(1024);
+
+    void* first = arena.Allocate(24, 8);
+    void* second = arena.Allocate(1, 64);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(second) % 64);
+    ASSERT_GE(static_cast<char*>(second), static_cast<char*>(first) + 24);
+    ASSERT_EQ(1u, arena.get_blocks_number());
+
+    // larger than a block
+    arena.Allocate(4096, 8);
+    ASSERT_EQ(2u, arena.get_blocks_number());
+    ASSERT_EQ(24u + 1u + 4096u, arena.get_allocated_bytes());
+}
+
+TEST(TreeArenaTest, ShutdownHaltsTheActions)
+{
+    BT::WorkStealingExecutor executor(2);
+    BT::ActionTestNode* action_1;
+    {
+        BT::BehaviorTree tree;
+        BT::SequenceNode* root = tree.CreateNode<BT::SequenceNode>("root");
+        BT::ConditionTestNode* condition = tree.CreateNode<BT::ConditionTestNode>("condition");
+        action_1 = tree.CreateNode<BT::ActionTestNode>("action_1", &executor);
+        BT::DecoratorSync* sync = tree.CreateNode<BT::DecoratorSync>("sync", "gtest_arena_link");
+        BT::ActionTestNode* action_2 = tree.CreateNode<BT::ActionTestNode>("action_2", &executor);
+        action_1->set_time(0);
+        action_2->set_time(100);
+        sync->AddChild(action_2);
+        root->AddChild(condition);
+        root->AddChild(action_1);
+        tree.set_root(root);
+
+        ASSERT_EQ(5u, tree.get_nodes_number());
+        ASSERT_GE(tree.get_allocated_bytes(), sizeof(BT::SequenceNode) + 2 * sizeof(BT::ActionTestNode));
+        ASSERT_EQ(1u, BT::GetSyncLink("gtest_arena_link")->get_participants_number());
+
+        // action_1 may still be finishing its tick, action_2 runs for 100 s
+        root->Tick();
+        action_2->SendTick();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        tree.Shutdown();
+        ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+        ASSERT_FALSE(action_1->is_tick_in_flight());
+        ASSERT_FALSE(action_2->is_tick_in_flight());
+        ASSERT_EQ(BT::HALTED, action_2->get_status());
+
+        ASSERT_THROW(tree.CreateNode<BT::SequenceNode>("late"), BT::BehaviorTreeException);
+    }
+    // the nodes have been destroyed through their own type
+    ASSERT_EQ(0u, BT::GetSyncLink("gtest_arena_link")->get_participants_number());
+}
+
+TEST(TreeArenaTest, ShutdownWithVirtualClock)
+{
+    BT::VirtualClock clock;
+    BT::SetDefaultClock(&clock);
+    BT::WorkStealingExecutor executor(1);
+    {
+        BT::BehaviorTree tree;
+        BT::ActionTestNode* action = tree.CreateNode<BT::ActionTestNode>("action", &executor);
+        action->set_time(100000);
+        tree.set_root(action);
+
+        // the tick stays queued behind a busy worker, hence in flight during the shutdown.
+        // This thread is not an activity of the clock: the shutdown does not sleep in it
+        executor.Submit([]() { std::this_thread::sleep_for(std::chrono::milliseconds(200)); });
+        action->SendTick();
+        ASSERT_NO_THROW(tree.Shutdown());
+        ASSERT_FALSE(action->is_tick_in_flight());
+        ASSERT_EQ(BT::HALTED, action->get_status());
+    }
+    BT::SetDefaultClock(NULL);
+}
+
+TEST(TreeArenaTest, RequestHalt)
+{
+    BT::WorkStealingExecutor executor(1);
+    BT::BehaviorTree tree;
+    BT::SequenceNode* root = tree.CreateNode<BT::SequenceNode>("root");
+    BT::ActionTestNode* action = tree.CreateNode<BT::ActionTestNode>("action", &executor);
+    action->set_time(10);
+    action->set_halt_time_milliseconds(1000);
+    root->AddChild(action);
+    tree.set_root(root);
+
+    ASSERT_EQ(BT::RUNNING, root->Tick());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // requested in the whole tree and not waited
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    tree.RequestHalt();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    ASSERT_TRUE(action->is_halt_requested());
+
+    tree.Shutdown();
+    ASSERT_EQ(BT::HALTED, action->get_status());
+}
+
+TEST(TreeArenaTest, RequestHaltOfRemoteActions)
+{
+    BT::WorkStealingExecutor executor(2);
+    BT::BehaviorTree tree;
+    BT::ParallelNode* root = tree.CreateNode<BT::ParallelNode>("root", 2);
+    RemoteActionTestNode* action_1 = tree.CreateNode<RemoteActionTestNode>("action_1", &executor,
+                                                                           std::chrono::milliseconds(500));
+    RemoteActionTestNode* action_2 = tree.CreateNode<RemoteActionTestNode>("action_2", &executor,
+                                                                           std::chrono::milliseconds(500));
+    root->AddChild(action_1);
+    root->AddChild(action_2);
+    tree.set_root(root);
+
+    ASSERT_EQ(BT::RUNNING, root->Tick());
+    action_1->WaitForTick();
+    action_2->WaitForTick();
+
+    // the halt requests to the modules are sent on the executor (e.g. by the tick of a HotSwapNode)
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    tree.RequestHalt();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+    ASSERT_FALSE(tree.IsQuiescent());
+
+    tree.Shutdown();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(900));
+    ASSERT_TRUE(tree.IsQuiescent());
+    ASSERT_EQ(1, action_1->get_halts_number());
+    ASSERT_EQ(1, action_2->get_halts_number());
+}
+
+TEST(TreeArenaTest, MemoryReport)
+{
+    BT::BehaviorTree tree;
+    BT::SequenceNode* root = tree.CreateNode<BT::SequenceNode>("root");
+    BT::ConditionTestNode* condition_1 = tree.CreateNode<BT::ConditionTestNode>("condition_1");
+    BT::ConditionTestNode* condition_2 = tree.CreateNode<BT::ConditionTestNode>("condition_2");
+    root->AddChild(condition_1);
+    root->AddChild(condition_2);
+
+    // a node that is never waited for nor drawn has no side table
+    std::vector<BT::NodeTypeMemory> report = tree.GetMemoryReport();
+    ASSERT_EQ(2u, report.size());
+    ASSERT_EQ(1u, report[0].nodes_number);
+    ASSERT_EQ(sizeof(BT::SequenceNode), report[0].node_size);
+    ASSERT_EQ(2u, report[1].nodes_number);
+    ASSERT_EQ(sizeof(BT::ConditionTestNode), report[1].node_size);
+    ASSERT_NE(std::string::npos, report[1].type_name.find("ConditionTestNode"));
+    ASSERT_EQ(0u, report[0].side_tables_bytes + report[1].side_tables_bytes);
+
+    // the side tables are allocated at the first use only
+    ASSERT_EQ(0, condition_1->get_x_pose());
+    ASSERT_EQ(0u, condition_1->get_side_tables_size());
+    condition_1->set_x_pose(3);
+    ASSERT_EQ(3, condition_1->get_x_pose());
+    ASSERT_EQ(sizeof(BT::NodeDrawState), condition_1->get_side_tables_size());
+
+    condition_2->set_status(BT::RUNNING);
+    std::thread waiter([condition_2]() { condition_2->WaitForHaltResponse(); });
+    while (condition_2->get_side_tables_size() == 0)
+    {
+        std::this_thread::yield();
+    }
+    condition_2->set_status(BT::HALTED);
+    waiter.join();
+    ASSERT_EQ(sizeof(BT::NodeWaitState), condition_2->get_side_tables_size());
+
+    report = tree.GetMemoryReport();
+    ASSERT_EQ(sizeof(BT::NodeDrawState) + sizeof(BT::NodeWaitState), report[1].side_tables_bytes);
+
+    std::ostringstream stream;
+    tree.PrintMemoryReport(stream);
+    ASSERT_NE(std::string::npos, stream.str().find("total"));
+}
+
+
+// Predicate of the static conditions: the value is set by the test
+struct Flag
+{
+    Flag() : value(false) {}
+    bool operator()() { return value; }
+    bool value;
+};
+
+// Synchronous static action: RUNNING for the first ticks_number ticks, then SUCCESS
+struct Countdown
+{
+    Countdown() : ticks_number(0) {}
+    BT::ReturnStatus operator()() { return ticks_number-- > 0 ? BT::RUNNING : BT::SUCCESS; }
+    int ticks_number;
+};
+
+struct StaticTreeTest : VirtualTimeTest
+{
+    typedef BT::Static::Sequence<BT::Static::Cond<Flag>,
+                                 BT::Static::Fallback<BT::Static::Cond<Flag>, BT::Static::Node> > Root;
+    BT::Static::Tree<Root> tree;
+    BT::ActionTestNode* action;
+
+    StaticTreeTest()
+    {
+        action = new BT::ActionTestNode("action");
+        action->set_time(3);
+        tree.get_root().get_child<1>().get_child<1>().set_node(action);
+    }
+
+    Flag& precondition() { return tree.get_root().get_child<0>().get_predicate(); }
+    Flag& done() { return tree.get_root().get_child<1>().get_child<0>().get_predicate(); }
+};
+
+TEST_F(StaticTreeTest, Conditions)
+{
+    ASSERT_EQ(BT::FAILURE, tree.Tick());
+    ASSERT_EQ(BT::IDLE, action->get_status());
+
+    precondition().value = true;
+    done().value = true;
+    ASSERT_EQ(BT::SUCCESS, tree.Tick());
+    ASSERT_EQ(BT::IDLE, action->get_status());
+}
+
+TEST_F(StaticTreeTest, RuntimeActionHalted)
+{
+    precondition().value = true;
+    ASSERT_EQ(BT::RUNNING, tree.Tick());
+    ASSERT_EQ(BT::RUNNING, action->get_status());
+    ASSERT_EQ(BT::RUNNING, tree.get_root().get_child<1>().get_status());
+
+    // the fallback succeeds before the action: the action is halted
+    done().value = true;
+    ASSERT_EQ(BT::SUCCESS, tree.Tick());
+    ASSERT_EQ(BT::HALTED, action->get_status());
+}
+
+TEST_F(StaticTreeTest, RuntimeActionDone)
+{
+    precondition().value = true;
+    ASSERT_EQ(BT::RUNNING, tree.Tick());
+    GetClock()->SleepFor(std::chrono::seconds(5));
+    ASSERT_EQ(BT::SUCCESS, tree.Tick());
+    ASSERT_EQ(BT::IDLE, action->get_status());
+
+    // a failing precondition halts the running action of the fallback
+    ASSERT_EQ(BT::RUNNING, tree.Tick());
+    precondition().value = false;
+    ASSERT_EQ(BT::FAILURE, tree.Tick());
+    ASSERT_EQ(BT::HALTED, action->get_status());
+}
+
+TEST(StaticParallelTest, Threshold)
+{
+    BT::Static::Tree<BT::Static::Parallel<2, BT::Static::Act<Countdown>, BT::Static::Act<Countdown>,
+                                          BT::Static::Act<Countdown> > > tree;
+    tree.get_root().get_child<0>().get_function().ticks_number = 0;
+    tree.get_root().get_child<1>().get_function().ticks_number = 5;
+    tree.get_root().get_child<2>().get_function().ticks_number = 1;
+
+    ASSERT_EQ(BT::RUNNING, tree.Tick());
+    ASSERT_EQ(BT::SUCCESS, tree.Tick());
+    // the second action, still running, has been halted
+    ASSERT_EQ(BT::HALTED, tree.get_root().get_child<1>().get_status());
+}
+
+TEST(StaticSubtreeTest, InRuntimeTree)
+{
+    BT::SequenceNode* root = new BT::SequenceNode("root");
+    BT::ConditionTestNode* condition = new BT::ConditionTestNode("condition");
+    BT::Static::Subtree<BT::Static::Fallback<BT::Static::Cond<Flag>, BT::Static::Act<Countdown> > >* subtree =
+            new BT::Static::Subtree<BT::Static::Fallback<BT::Static::Cond<Flag>, BT::Static::Act<Countdown> > >("static");
+    subtree->get_root().get_child<1>().get_function().ticks_number = 10;
+    root->AddChild(subtree);
+    root->AddChild(condition);
+
+    ASSERT_EQ(BT::RUNNING, root->Tick());
+    ASSERT_EQ(BT::RUNNING, subtree->get_status());
+
+    // halted by its runtime parent
+    root->Halt();
+    ASSERT_EQ(BT::HALTED, subtree->get_status());
+    ASSERT_EQ(BT::HALTED, subtree->get_root().get_child<1>().get_status());
+
+    subtree->get_root().get_child<0>().get_predicate().value = true;
+    ASSERT_EQ(BT::SUCCESS, root->Tick());
+    ASSERT_EQ(BT::IDLE, subtree->get_status());
+}
+
+TEST(StaticSubtreeTest, HaltedWithTheSiblings)
+{
+    BT::WorkStealingExecutor executor(2);
+    BT::ParallelNode parallel("parallel", 2);
+    BT::ActionTestNode action("action", &executor);
+    BT::ActionTestNode static_action("static_action", &executor);
+    BT::Static::Subtree<BT::Static::Sequence<BT::Static::Node> > subtree("static");
+    subtree.get_root().get_child<0>().set_node(&static_action);
+    action.set_time(10);
+    action.set_halt_time_milliseconds(300);
+    static_action.set_time(10);
+    static_action.set_halt_time_milliseconds(300);
+    parallel.AddChild(&action);
+    parallel.AddChild(&subtree);
+
+    ASSERT_EQ(BT::RUNNING, parallel.Tick());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // a single wait for the action and the one in the static tree: halted one after the other,
+    // they would take more than 2 s
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    parallel.Halt();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    ASSERT_EQ(BT::HALTED, action.get_status());
+    ASSERT_EQ(BT::HALTED, static_action.get_status());
+    ASSERT_EQ(BT::HALTED, subtree.get_status());
+}
+
+struct HotSwapTest : VirtualTimeTest
+{
+    BT::HotSwapNode node;
+
+    HotSwapTest() : node("hot_swap") {}
+
+    // A condition followed by an action that runs for action_time seconds
+    BT::BehaviorTree* CreateVersion(std::string name, int action_time, BT::ActionTestNode** action)
+    {
+        BT::BehaviorTree* version = new BT::BehaviorTree();
+        BT::SequenceNode* root = version->CreateNode<BT::SequenceNode>(name);
+        *action = version->CreateNode<BT::ActionTestNode>(name + "_action");
+        (*action)->set_time(action_time);
+        root->AddChild(version->CreateNode<BT::ConditionTestNode>(name + "_condition"));
+        root->AddChild(*action);
+        version->set_root(root);
+        return version;
+    }
+};
+
+TEST_F(HotSwapTest, HaltRunningActions)
+{
+    BT::ActionTestNode* action_1;
+    BT::ActionTestNode* action_2;
+    ASSERT_THROW(node.Tick(), BT::BehaviorTreeException);
+
+    node.Swap(CreateVersion("version_1", 100, &action_1));
+    action_1->set_halt_time_milliseconds(2000);
+    ASSERT_EQ(BT::RUNNING, node.Tick());
+    ASSERT_EQ(1u, node.get_swaps_number());
+    // action_1 has started
+    GetClock()->SleepFor(std::chrono::milliseconds(500));
+
+    // the tick does not wait for the halt of the old action
+    node.Swap(CreateVersion("version_2", 1, &action_2));
+    std::chrono::steady_clock::time_point start = GetClock()->Now();
+    ASSERT_EQ(BT::RUNNING, node.Tick());
+    ASSERT_EQ(start, GetClock()->Now());
+    ASSERT_EQ(2u, node.get_swaps_number());
+    ASSERT_EQ(BT::RUNNING, action_2->get_status());
+    ASSERT_TRUE(action_1->is_halt_requested());
+    ASSERT_EQ(1u, node.CollectRetiredVersions());
+
+    // the worker of action_1 returns shortly after the halt (1 s to notice it, 2 s to complete it)
+    while (node.CollectRetiredVersions() != 0)
+    {
+        GetClock()->SleepFor(BT::VirtualClock::POLLING_PERIOD);
+    }
+    ASSERT_LT(GetClock()->Now() - start, std::chrono::seconds(4));
+    ASSERT_EQ(BT::SUCCESS, node.Tick());
+}
+
+TEST_F(HotSwapTest, FinishRunningActions)
+{
+    BT::ActionTestNode* action_1;
+    BT::ActionTestNode* action_2;
+
+    node.Swap(CreateVersion("version_1", 3, &action_1));
+    ASSERT_EQ(BT::RUNNING, node.Tick());
+
+    // the old version is ticked until it is done
+    node.Swap(CreateVersion("version_2", 3, &action_2), BT::FINISH_RUNNING_ACTIONS);
+    ASSERT_EQ(BT::RUNNING, node.Tick());
+    ASSERT_EQ(1u, node.get_swaps_number());
+    ASSERT_EQ(BT::IDLE, action_2->get_status());
+
+    GetClock()->SleepFor(std::chrono::seconds(5));
+    ASSERT_EQ(BT::SUCCESS, node.Tick());
+    ASSERT_EQ(1u, node.get_swaps_number());
+
+    ASSERT_EQ(BT::RUNNING, node.Tick());
+    ASSERT_EQ(2u, node.get_swaps_number());
+    ASSERT_EQ(BT::IDLE, action_1->get_status());
+    ASSERT_EQ(BT::RUNNING, action_2->get_status());
+}
+
+TEST_F(HotSwapTest, PendingVersionReplaced)
+{
+    BT::ActionTestNode* action_1;
+    BT::ActionTestNode* action_2;
+
+    node.Swap(CreateVersion("version_1", 3, &action_1));
+    // never ticked: destroyed by the following swap
+    node.Swap(CreateVersion("version_2", 3, &action_2));
+    ASSERT_EQ(BT::RUNNING, node.Tick());
+    ASSERT_EQ(1u, node.get_swaps_number());
+    ASSERT_EQ(BT::RUNNING, action_2->get_status());
+    ASSERT_EQ(0u, node.CollectRetiredVersions());
+
+    BT::BehaviorTree empty_version;
+    ASSERT_THROW(node.Swap(&empty_version), BT::BehaviorTreeException);
+}
+
+TEST(TypedBlackBoardTest, InternedKeys)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<double> speed = blackboard.Intern<double>("speed");
+    BT::BlackBoardKey<std::string> target = blackboard.Intern<std::string>("target");
+
+    ASSERT_EQ(0u, blackboard.get_version(speed));
+    ASSERT_EQ(0.0, blackboard.Get(speed));
+    blackboard.Set(speed, 1.5);
+    blackboard.Set(target, std::string("kitchen"));
+    ASSERT_EQ(1.5, blackboard.Get(speed));
+    ASSERT_EQ("kitchen", blackboard.Get(target));
+    ASSERT_EQ(1u, blackboard.get_version(speed));
+
+    // the same key, the same slot
+    BT::BlackBoardKey<double> same_speed = blackboard.Intern<double>("speed");
+    ASSERT_EQ(speed.get_index(), same_speed.get_index());
+    blackboard.Set(same_speed, 2.0);
+    ASSERT_EQ(2.0, blackboard.Get(speed));
+    ASSERT_EQ(2u, blackboard.get_version(speed));
+
+    ASSERT_THROW(blackboard.Intern<int32_t>("speed"), BT::BehaviorTreeException);
+    ASSERT_EQ(2u, blackboard.get_keys_number());
+    ASSERT_EQ("target", blackboard.GetNames()[1]);
+    ASSERT_EQ(BT::STRING_VALUE, blackboard.GetType("target"));
+}
+
+TEST(TypedBlackBoardTest, ByName)
+{
+    BT::TypedBlackBoard blackboard;
+    ASSERT_THROW(blackboard.GetByName<int32_t>("x32"), BT::BehaviorTreeException);
+
+    // the numbers are converted, as with a yarp::os::Property
+    blackboard.SetByName<int32_t>("x32", 11);
+    ASSERT_EQ(11, blackboard.GetByName<int8_t>("x32"));
+    ASSERT_EQ(11.0, blackboard.GetByName<double>("x32"));
+    blackboard.SetByName<double>("x32", 12.7);
+    ASSERT_EQ(12, blackboard.Get(blackboard.Intern<int32_t>("x32")));
+    ASSERT_TRUE(blackboard.GetByName<bool>("x32"));
+
+    blackboard.SetByName<int64_t>("x64", 1LL << 40);
+    ASSERT_EQ(1LL << 40, blackboard.GetByName<int64_t>("x64"));
+
+    blackboard.SetByName<std::string>("s", "test");
+    ASSERT_EQ("test", blackboard.GetByName<std::string>("s"));
+    ASSERT_THROW(blackboard.GetByName<double>("s"), BT::BehaviorTreeException);
+    ASSERT_THROW(blackboard.SetByName<int16_t>("s", 1), BT::BehaviorTreeException);
+    ASSERT_THROW(blackboard.GetByName<std::string>("x32"), BT::BehaviorTreeException);
+}
+
+TEST(TypedBlackBoardTest, ConcurrentNumbers)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<int64_t> counter = blackboard.Intern<int64_t>("counter");
+    std::atomic<bool> is_done(false);
+
+    // the reader always sees a value that has been written, never decreasing
+    std::thread reader([&blackboard, counter, &is_done]()
+    {
+        int64_t last_value = 0;
+        while (!is_done)
+        {
+            int64_t value = blackboard.Get(counter);
+            ASSERT_GE(value, last_value);
+            last_value = value;
+        }
+    });
+    for (int64_t i = 1; i <= 100000; i++)
+    {
+        blackboard.Set(counter, i);
+    }
+    is_done = true;
+    reader.join();
+    ASSERT_EQ(100000u, blackboard.get_version(counter));
+}
+
+// A value larger than a word: read through the seqlock
+struct Pose
+{
+    double x;
+    double y;
+    double theta;
+    int64_t stamp;
+};
+
+TEST(TypedBlackBoardTest, ConcurrentStructures)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<Pose> pose = blackboard.Intern<Pose>("pose");
+    ASSERT_EQ(BT::FIXED_VALUE, blackboard.GetType("pose"));
+    ASSERT_EQ(0, blackboard.Get(pose).stamp);
+    std::atomic<bool> is_done(false);
+
+    // two writers and two readers: a reader never sees the fields of two different writes
+    std::vector<std::thread> threads;
+    for (int64_t writer_idx = 0; writer_idx < 2; writer_idx++)
+    {
+        threads.push_back(std::thread([&blackboard, pose, writer_idx]()
+        {
+            for (int64_t i = 1; i <= 20000; i++)
+            {
+                Pose value = {(double)i, (double)(2 * i), (double)(writer_idx + 1), i};
+                blackboard.Set(pose, value);
+            }
+        }));
+    }
+    for (int reader_idx = 0; reader_idx < 2; reader_idx++)
+    {
+        threads.push_back(std::thread([&blackboard, pose, &is_done]()
+        {
+            while (!is_done)
+            {
+                Pose value = blackboard.Get(pose);
+                ASSERT_EQ((double)value.stamp, value.x);
+                ASSERT_EQ(2 * value.x, value.y);
+                ASSERT_TRUE(value.stamp == 0 || value.theta == 1.0 || value.theta == 2.0);
+            }
+        }));
+    }
+    threads[0].join();
+    threads[1].join();
+    is_done = true;
+    threads[2].join();
+    threads[3].join();
+    ASSERT_EQ(40000u, blackboard.get_version(pose));
+    ASSERT_EQ(20000, blackboard.Get(pose).stamp);
+
+    // a structure is typed by its size, and never converted
+    ASSERT_THROW(blackboard.Intern<int64_t[2]>("pose"), BT::BehaviorTreeException);
+    ASSERT_THROW(blackboard.GetByName<double>("pose"), BT::BehaviorTreeException);
+}
+
+TEST(TypedBlackBoardTest, ConcurrentStrings)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<std::string> target = blackboard.Intern<std::string>("target");
+    BT::BlackBoardKey<BT::BlackBoardBlob> map = blackboard.Intern<BT::BlackBoardBlob>("map");
+    ASSERT_EQ("", blackboard.Get(target));
+    ASSERT_TRUE(blackboard.Get(map).empty());
+    std::atomic<bool> is_done(false);
+
+    // the readers see whole copies only, while the old ones are retired under them
+    std::vector<std::thread> readers;
+    for (int reader_idx = 0; reader_idx < 2; reader_idx++)
+    {
+        readers.push_back(std::thread([&blackboard, target, map, &is_done]()
+        {
+            while (!is_done)
+            {
+                std::string value = blackboard.Get(target);
+                ASSERT_TRUE(value.empty() || value == std::string(value.size(), value[0]));
+                blackboard.Read(map, [](const BT::BlackBoardBlob& blob)
+                {
+                    for (unsigned int i = 0; i < blob.size(); i++)
+                    {
+                        ASSERT_EQ(blob.size() % 256, blob[i]);
+                    }
+                });
+            }
+        }));
+    }
+    for (unsigned int i = 1; i <= 2000; i++)
+    {
+        blackboard.Set(target, std::string(i % 100 + 20, 'a' + i % 26));
+        blackboard.Set(map, BT::BlackBoardBlob(i, i % 256));
+    }
+    is_done = true;
+    readers[0].join();
+    readers[1].join();
+    ASSERT_EQ(2000u, blackboard.get_version(target));
+    ASSERT_EQ(2000u, blackboard.Get(map).size());
+
+    // no reader left: all the old copies are deleted
+    BT::Rcu::Synchronize();
+    ASSERT_EQ(0u, BT::Rcu::get_retired_number());
+}
+
+TEST(TypedBlackBoardTest, CompareAndSetAndAdd)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<std::string> owner = blackboard.Intern<std::string>("owner");
+    ASSERT_TRUE(blackboard.CompareAndSet(owner, std::string(""), std::string("arm")));
+    ASSERT_FALSE(blackboard.CompareAndSet(owner, std::string(""), std::string("base")));
+    ASSERT_EQ("arm", blackboard.Get(owner));
+    ASSERT_EQ(1u, blackboard.get_version(owner));
+
+    // by name, with the conversions of SetByName()
+    blackboard.SetByName<int32_t>("x32", 3);
+    ASSERT_TRUE(blackboard.CompareAndSetByName<double>("x32", 3.0, 4.0));
+    ASSERT_FALSE(blackboard.CompareAndSetByName<int64_t>("x32", 3, 5));
+    ASSERT_EQ(4, blackboard.GetByName<int32_t>("x32"));
+    ASSERT_EQ(6, blackboard.AddByName<int64_t>("x32", 2));
+    ASSERT_EQ(2.5, blackboard.AddByName<double>("new_key", 2.5));
+    ASSERT_THROW(blackboard.AddByName<int32_t>("owner", 1), BT::BehaviorTreeException);
+
+    // concurrent increments are not lost
+    BT::BlackBoardKey<int64_t> counter = blackboard.Intern<int64_t>("counter");
+    std::vector<std::thread> threads;
+    for (int thread_idx = 0; thread_idx < 4; thread_idx++)
+    {
+        threads.push_back(std::thread([&blackboard, counter]()
+        {
+            for (int i = 0; i < 10000; i++)
+            {
+                blackboard.Add(counter, (int64_t)1);
+            }
+        }));
+    }
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+    ASSERT_EQ(40000, blackboard.Get(counter));
+}
+
+template <typename T>
+BT::BlackBoardRecord MakeNumberRecord(const std::string& name, T value)
+{
+    BT::BlackBoardRecord record;
+    record.name = name;
+    record.type = BT::BlackBoardTypeOf<T>::value;
+    record.value_size = sizeof(T);
+    record.bytes.assign(reinterpret_cast<const char*>(&value), sizeof(T));
+    record.version = 0;
+    return record;
+}
+
+TEST(TypedBlackBoardTest, SetManyAndGetMany)
+{
+    BT::TypedBlackBoard blackboard;
+    blackboard.SetByName<int32_t>("x32", 1);
+    blackboard.SetByName<std::string>("s", "test");
+
+    // a value that does not fit its key: nothing is set
+    std::vector<BT::BlackBoardRecord> records;
+    records.push_back(MakeNumberRecord<int64_t>("x32", 2));
+    records.push_back(MakeNumberRecord<int64_t>("s", 2));
+    ASSERT_THROW(blackboard.SetMany(records), BT::BehaviorTreeException);
+    ASSERT_EQ(1, blackboard.GetByName<int32_t>("x32"));
+
+    // converted as by SetByName(), the last record of a key wins
+    records.pop_back();
+    records.push_back(MakeNumberRecord<double>("x32", 3.0));
+    records.push_back(MakeNumberRecord<bool>("new_key", true));
+    blackboard.SetMany(records);
+    ASSERT_EQ(3, blackboard.GetByName<int32_t>("x32"));
+    ASSERT_EQ(BT::BOOL_VALUE, blackboard.GetType("new_key"));
+
+    std::vector<std::string> names = {"x32", "new_key", "s", "missing"};
+    blackboard.GetMany(names, &records);
+    ASSERT_EQ(4u, records.size());
+    ASSERT_EQ(BT::INT32_VALUE, records[0].type);
+    ASSERT_EQ(2u, records[0].version);
+    ASSERT_EQ("test", records[2].bytes);
+    ASSERT_EQ(0u, records[3].version);
+
+    // a batch is seen whole: the reader never gets the values of two different batches
+    std::atomic<bool> is_done(false);
+    std::thread reader([&blackboard, &is_done]()
+    {
+        std::vector<std::string> names = {"a", "b", "c"};
+        std::vector<BT::BlackBoardRecord> records;
+        while (!is_done)
+        {
+            blackboard.GetMany(names, &records);
+            ASSERT_EQ(records[0].version, records[1].version);
+            ASSERT_EQ(records[0].bytes, records[1].bytes);
+            ASSERT_EQ(records[0].bytes, records[2].bytes);
+        }
+    });
+    for (int64_t i = 1; i <= 20000; i++)
+    {
+        std::vector<BT::BlackBoardRecord> batch;
+        batch.push_back(MakeNumberRecord<int64_t>("c", i));
+        batch.push_back(MakeNumberRecord<int64_t>("a", i));
+        batch.push_back(MakeNumberRecord<int64_t>("b", i));
+        blackboard.SetMany(batch);
+    }
+    is_done = true;
+    reader.join();
+    ASSERT_EQ(20000, blackboard.GetByName<int64_t>("b"));
+}
+
+TEST(BlackBoardStreamTest, Patterns)
+{
+    ASSERT_TRUE(BT::MatchesKeyPattern("arm/*", "arm/joint_1"));
+    ASSERT_TRUE(BT::MatchesKeyPattern("*", ""));
+    ASSERT_TRUE(BT::MatchesKeyPattern("*/joint_?", "leg/left/joint_2"));
+    ASSERT_TRUE(BT::MatchesKeyPattern("a*b*c", "aXbYbZc"));
+    ASSERT_FALSE(BT::MatchesKeyPattern("arm/*", "leg/joint_1"));
+    ASSERT_FALSE(BT::MatchesKeyPattern("joint_?", "joint_10"));
+    ASSERT_FALSE(BT::MatchesKeyPattern("a*b", "aXbY"));
+}
+
+TEST(BlackBoardStreamTest, CoalescedDeltas)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<double> joint = blackboard.Intern<double>("arm/joint_1");
+    blackboard.Set(joint, 0.5);
+    blackboard.SetByName<int32_t>("leg/joint_1", 3);
+
+    BT::BlackBoardStream stream(&blackboard);
+    std::vector<std::string> patterns(1, "arm/*");
+    unsigned int subscription_id = stream.Subscribe(patterns, 0);
+
+    // the first message holds the keys already set
+    ASSERT_TRUE(stream.WaitForChanges(std::chrono::milliseconds(1000)));
+    std::vector<BT::BlackBoardDelta> deltas = stream.CollectDeltas(subscription_id);
+    ASSERT_EQ(1u, deltas.size());
+    ASSERT_EQ("arm/joint_1", deltas[0].name);
+    ASSERT_EQ(BT::DOUBLE_VALUE, deltas[0].type);
+    ASSERT_EQ(0.5, deltas[0].real);
+    ASSERT_EQ(1u, deltas[0].version);
+    ASSERT_TRUE(stream.CollectDeltas(subscription_id).empty());
+
+    // three sets, one delta with the last value; the keys interned later are matched too
+    blackboard.Set(joint, 0.6);
+    blackboard.Set(joint, 0.7);
+    blackboard.Set(joint, 0.8);
+    blackboard.SetByName<std::string>("arm/state", "moving");
+    blackboard.SetByName<int32_t>("leg/joint_1", 4);
+    ASSERT_TRUE(stream.WaitForChanges(std::chrono::milliseconds(1000)));
+    deltas = stream.CollectDeltas(subscription_id);
+    ASSERT_EQ(2u, deltas.size());
+    ASSERT_EQ(0.8, deltas[0].real);
+    ASSERT_EQ(4u, deltas[0].version);
+    ASSERT_EQ("moving", deltas[1].text);
+
+    ASSERT_TRUE(stream.Unsubscribe(subscription_id));
+    ASSERT_THROW(stream.CollectDeltas(subscription_id), BT::BehaviorTreeException);
+}
+
+TEST(BlackBoardStreamTest, RateLimit)
+{
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardKey<int64_t> counter = blackboard.Intern<int64_t>("counter");
+    BT::BlackBoardStream stream(&blackboard);
+    // at most 1 message per second: the changes after the first message are held back
+    unsigned int subscription_id = stream.Subscribe(std::vector<std::string>(1, "*"), 1.0);
+    blackboard.Set(counter, (int64_t)1);
+    ASSERT_EQ(1u, stream.CollectDeltas(subscription_id).size());
+    blackboard.Set(counter, (int64_t)2);
+    ASSERT_TRUE(stream.CollectDeltas(subscription_id).empty());
+
+    // another subscription has its own limit
+    unsigned int other_subscription_id = stream.Subscribe(std::vector<std::string>(1, "count*"), 0);
+    std::vector<BT::BlackBoardDelta> deltas = stream.CollectDeltas(other_subscription_id);
+    ASSERT_EQ(1u, deltas.size());
+    ASSERT_EQ(2, deltas[0].integer);
+    ASSERT_EQ(2u, stream.GetSubscriptions().size());
+
+    // the wait ends when the held back changes can be sent
+    stream.WaitForChanges(std::chrono::milliseconds(2000));
+    while (stream.CollectDeltas(subscription_id).empty())
+    {
+        stream.WaitForChanges(std::chrono::milliseconds(2000));
+    }
+}
+
+TEST(SharedBlackBoardTest, TwoMappings)
+{
+    std::string segment_name = "btpp_gtest_" + std::to_string(getpid());
+    ASSERT_THROW(BT::SharedBlackBoard missing(segment_name), BT::BehaviorTreeException);
+
+    BT::SharedBlackBoard blackboard(segment_name, 4, 32);
+    // another mapping of the same segment, as in another process
+    BT::SharedBlackBoard reader(segment_name);
+    ASSERT_EQ(4u, reader.get_keys_capacity());
+
+    BT::SharedBlackBoardKey<Pose> pose = blackboard.Intern<Pose>("pose");
+    BT::SharedBlackBoardKey<std::string> state = blackboard.Intern<std::string>("state");
+    Pose value = {1.0, 2.0, 0.5, 7};
+    blackboard.Set(pose, value);
+    blackboard.Set(state, std::string("docking"));
+
+    ASSERT_TRUE(reader.Contains("pose"));
+    ASSERT_EQ(7, reader.Get(reader.Intern<Pose>("pose")).stamp);
+    BT::SharedBlackBoardKey<std::string> reader_state = reader.Intern<std::string>("state");
+    ASSERT_EQ("docking", reader.Get(reader_state));
+    reader.Set(reader_state, std::string(""));
+    ASSERT_EQ("", blackboard.Get(state));
+    ASSERT_EQ(2u, blackboard.get_version(state));
+
+    ASSERT_THROW(reader.Intern<double>("pose"), BT::BehaviorTreeException);
+    ASSERT_THROW(blackboard.Set(state, std::string(100, 'x')), BT::BehaviorTreeException);
+    blackboard.Intern<BT::BlackBoardBlob>("map");
+    blackboard.Intern<bool>("is_docked");
+    ASSERT_THROW(blackboard.Intern<bool>("is_charging"), BT::BehaviorTreeException);
+    ASSERT_EQ("is_docked", reader.GetNames()[3]);
+}
+
+TEST(SharedBlackBoardTest, OtherProcess)
+{
+    std::string segment_name = "btpp_gtest_" + std::to_string(getpid());
+    BT::SharedBlackBoard blackboard(segment_name, 8);
+    BT::SharedBlackBoardKey<int64_t> counter = blackboard.Intern<int64_t>("counter");
+    BT::SharedBlackBoardKey<std::string> message = blackboard.Intern<std::string>("message");
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // the child maps the segment and writes, with no RPC
+        int exit_code = 1;
+        try
+        {
+            BT::SharedBlackBoard child_blackboard(segment_name);
+            BT::SharedBlackBoardKey<int64_t> child_counter = child_blackboard.Intern<int64_t>("counter");
+            for (int64_t i = 1; i <= 1000; i++)
+            {
+                child_blackboard.Set(child_counter, i);
+            }
+            child_blackboard.Set(child_blackboard.Intern<std::string>("message"), std::string("from the child"));
+            exit_code = 0;
+        }
+        catch (const BT::BehaviorTreeException& ex) {}
+        _exit(exit_code);
+    }
+    ASSERT_GT(pid, 0);
+
+    // the values read meanwhile never go backwards
+    int64_t last_value = 0;
+    int status = 0;
+    while (waitpid(pid, &status, WNOHANG) == 0)
+    {
+        int64_t value = blackboard.Get(counter);
+        ASSERT_GE(value, last_value);
+        last_value = value;
+    }
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+    ASSERT_EQ(1000, blackboard.Get(counter));
+    ASSERT_EQ("from the child", blackboard.Get(message));
+}
+
+TEST(SharedBlackBoardTest, LayoutVersion)
+{
+    using namespace boost::interprocess;
+    std::string segment_name = "btpp_gtest_" + std::to_string(getpid());
+    BT::SharedBlackBoard blackboard(segment_name, 2);
+    {
+        // as written by another version of the library
+        shared_memory_object segment(open_only, segment_name.c_str(), read_write);
+        mapped_region region(segment, read_write);
+        static_cast<BT::SharedBlackBoardHeader*>(region.get_address())->layout_version++;
+    }
+    ASSERT_THROW(BT::SharedBlackBoard reader(segment_name), BT::BehaviorTreeException);
+
+    // not a blackboard
+    std::string other_segment_name = segment_name + "_other";
+    {
+        shared_memory_object segment(create_only, other_segment_name.c_str(), read_write);
+        segment.truncate(4096);
+    }
+    ASSERT_THROW(BT::SharedBlackBoard reader(other_segment_name), BT::BehaviorTreeException);
+    ASSERT_TRUE(BT::SharedBlackBoard::Remove(other_segment_name));
+}
+
+TEST(SharedBlackBoardTest, DeadWriter)
+{
+    using namespace boost::interprocess;
+    std::string segment_name = "btpp_gtest_" + std::to_string(getpid());
+    BT::SharedBlackBoard blackboard(segment_name, 2);
+    BT::SharedBlackBoardKey<int64_t> counter = blackboard.Intern<int64_t>("counter");
+    blackboard.Set(counter, (int64_t)1);
+
+    // the pid of a process that has exited
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        _exit(0);
+    }
+    ASSERT_GT(pid, 0);
+    waitpid(pid, NULL, 0);
+
+    {
+        // as left by a process that has died within a write to the counter and a creation of a key
+        shared_memory_object segment(open_only, segment_name.c_str(), read_write);
+        mapped_region region(segment, read_write);
+        BT::SharedBlackBoardHeader* header = static_cast<BT::SharedBlackBoardHeader*>(region.get_address());
+        BT::SharedBlackBoardSlot* slot = reinterpret_cast<BT::SharedBlackBoardSlot*>(
+                    static_cast<char*>(region.get_address()) + BT::SharedBlackBoard::SLOTS_OFFSET);
+        slot->writer_pid = (uint32_t)pid;
+        slot->sequence++;
+        slot->get_words()[0] = 0xdead;
+        header->intern_lock = (uint32_t)pid;
+    }
+
+    BT::SharedBlackBoard reader(segment_name);
+    ASSERT_THROW(reader.Get(reader.Intern<int64_t>("counter")), BT::BehaviorTreeException);
+
+    // the next writer takes the locks over
+    BT::SharedBlackBoardKey<std::string> state = blackboard.Intern<std::string>("state");
+    blackboard.Set(state, std::string("recovered"));
+    ASSERT_EQ("recovered", reader.Get(reader.Intern<std::string>("state")));
+    blackboard.Set(counter, (int64_t)2);
+    ASSERT_EQ(2, reader.Get(reader.Intern<int64_t>("counter")));
+    ASSERT_EQ(2u, blackboard.get_version(counter));
+}
+
+TEST(SharedBlackBoardTest, Mirror)
+{
+    std::string segment_name = "btpp_gtest_" + std::to_string(getpid());
+    BT::SharedBlackBoard shared_blackboard(segment_name, 3);
+    BT::SharedBlackBoard reader(segment_name);
+
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardStream stream(&blackboard);
+    blackboard.SetByName<int32_t>("battery", 80);
+    BT::SharedBlackBoardMirror mirror(&stream, &shared_blackboard);
+    blackboard.SetByName<std::string>("state", "docking");
+    blackboard.SetByName<bool>("is_docked", false);
+    ASSERT_EQ(3u, mirror.Update());
+    ASSERT_EQ(80, reader.Get(reader.Intern<int32_t>("battery")));
+    ASSERT_EQ("docking", reader.Get(reader.Intern<std::string>("state")));
+
+    // only the changes, coalesced
+    blackboard.SetByName<int32_t>("battery", 79);
+    blackboard.SetByName<int32_t>("battery", 78);
+    ASSERT_EQ(1u, mirror.Update());
+    ASSERT_EQ(78, reader.Get(reader.Intern<int32_t>("battery")));
+    ASSERT_EQ(0u, mirror.Update());
+
+    // the segment is full
+    blackboard.SetByName<double>("speed", 0.5);
+    ASSERT_EQ(0u, mirror.Update());
+    ASSERT_EQ(1u, mirror.get_skipped_number());
+}
+
+// A new directory for the files of a journal
+std::string MakeJournalDirectory()
+{
+    char directory[] = "/tmp/btpp_gtest_XXXXXX";
+    return mkdtemp(directory) != NULL ? directory : "";
+}
+
+// Changes the last byte of the file
+void CorruptFile(const std::string& path)
+{
+    std::fstream file(path.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+    file.seekg(-1, std::ios::end);
+    char last_byte = file.get();
+    file.seekp(-1, std::ios::end);
+    file.put(last_byte ^ 1);
+}
+
+void RemoveJournalDirectory(const std::string& directory, unsigned int generations_number)
+{
+    for (unsigned int i = 0; i < generations_number; i++)
+    {
+        std::remove(BT::BlackBoardJournal::GetLogPath(directory, i).c_str());
+    }
+    std::remove(BT::BlackBoardJournal::GetSnapshotPath(directory).c_str());
+    std::remove(BT::BlackBoardJournal::GetPreviousSnapshotPath(directory).c_str());
+    rmdir(directory.c_str());
+}
+
+TEST(BlackBoardJournalTest, Restart)
+{
+    std::string directory = MakeJournalDirectory();
+    ASSERT_FALSE(directory.empty());
+    {
+        BT::TypedBlackBoard blackboard;
+        blackboard.SetByName<int32_t>("before_the_journal", 3);
+        BT::BlackBoardJournal journal(&blackboard, directory);
+        ASSERT_EQ(0u, journal.get_generation());
+
+        Pose pose = {1.0, 2.0, 0.5, 7};
+        blackboard.Set(blackboard.Intern<Pose>("pose"), pose);
+        blackboard.SetByName<std::string>("state", "docking");
+        BT::BlackBoardKey<int64_t> counter = blackboard.Intern<int64_t>("counter");
+        blackboard.Add(counter, (int64_t)5);
+
+        // a snapshot, then the tail in the new log
+        journal.Snapshot();
+        ASSERT_EQ(1u, journal.get_generation());
+        // kept with the previous snapshot
+        ASSERT_TRUE(std::ifstream(BT::BlackBoardJournal::GetLogPath(directory, 0).c_str()).good());
+        blackboard.Add(counter, (int64_t)2);
+        blackboard.CompareAndSetByName<std::string>("state", "docking", "docked");
+        blackboard.SetByName<BT::BlackBoardBlob>("map", BT::BlackBoardBlob(3, 9));
+        blackboard.SetByName<double>("battery", 0.5);
+        blackboard.SetByName<double>("battery", 0.25);
+        ASSERT_EQ(5u, journal.get_records_number());
+        ASSERT_FALSE(journal.is_failed());
+    }
+
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardJournal journal(&blackboard, directory);
+    ASSERT_EQ(4u, journal.get_snapshot_records_number());
+    ASSERT_EQ(5u, journal.get_replayed_records_number());
+    ASSERT_EQ(2u, journal.get_generation());
+    ASSERT_FALSE(journal.is_previous_snapshot_restored());
+    ASSERT_FALSE(std::ifstream(BT::BlackBoardJournal::GetLogPath(directory, 0).c_str()).good());
+    ASSERT_EQ(3, blackboard.GetByName<int32_t>("before_the_journal"));
+    ASSERT_EQ(7, blackboard.GetByName<Pose>("pose").stamp);
+    ASSERT_EQ(7, blackboard.GetByName<int64_t>("counter"));
+    ASSERT_EQ("docked", blackboard.GetByName<std::string>("state"));
+    ASSERT_EQ(BT::BlackBoardBlob(3, 9), blackboard.GetByName<BT::BlackBoardBlob>("map"));
+    ASSERT_EQ(0.25, blackboard.GetByName<double>("battery"));
+    // the restored keys keep their types
+    ASSERT_THROW(blackboard.Intern<int32_t>("pose"), BT::BehaviorTreeException);
+
+    ASSERT_THROW(BT::BlackBoardJournal other_journal(&blackboard, directory), BT::BehaviorTreeException);
+    RemoveJournalDirectory(directory, 3);
+}
+
+TEST(BlackBoardJournalTest, CutLog)
+{
+    std::string directory = MakeJournalDirectory();
+    ASSERT_FALSE(directory.empty());
+    unsigned int generation;
+    {
+        BT::TypedBlackBoard blackboard;
+        BT::BlackBoardJournal journal(&blackboard, directory);
+        BT::BlackBoardKey<int32_t> step = blackboard.Intern<int32_t>("step");
+        for (int32_t i = 1; i <= 10; i++)
+        {
+            blackboard.Set(step, i);
+        }
+        generation = journal.get_generation();
+    }
+
+    // a crash in the middle of the last record
+    std::string path = BT::BlackBoardJournal::GetLogPath(directory, generation);
+    std::ifstream log_file(path.c_str(), std::ios::binary | std::ios::ate);
+    ASSERT_EQ(0, truncate(path.c_str(), (off_t)log_file.tellg() - 2));
+
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardJournal journal(&blackboard, directory);
+    ASSERT_EQ(9u, journal.get_replayed_records_number());
+    ASSERT_EQ(9, blackboard.GetByName<int32_t>("step"));
+
+    ASSERT_FALSE(journal.is_previous_snapshot_restored());
+
+    // a corrupted snapshot is not loaded: the previous one and its logs are
+    CorruptFile(BT::BlackBoardJournal::GetSnapshotPath(directory));
+    {
+        BT::TypedBlackBoard other_blackboard;
+        BT::BlackBoardJournal other_journal(&other_blackboard, directory);
+        ASSERT_TRUE(other_journal.is_previous_snapshot_restored());
+        ASSERT_EQ(9, other_blackboard.GetByName<int32_t>("step"));
+    }
+
+    CorruptFile(BT::BlackBoardJournal::GetSnapshotPath(directory));
+    CorruptFile(BT::BlackBoardJournal::GetPreviousSnapshotPath(directory));
+    BT::TypedBlackBoard other_blackboard;
+    ASSERT_THROW(BT::BlackBoardJournal other_journal(&other_blackboard, directory), BT::BehaviorTreeException);
+    RemoveJournalDirectory(directory, generation + 3);
+}
+
+TEST(BlackBoardJournalTest, ConcurrentWriters)
+{
+    std::string directory = MakeJournalDirectory();
+    ASSERT_FALSE(directory.empty());
+    const int64_t increments_number = 2000;
+    unsigned int generation;
+    {
+        BT::TypedBlackBoard blackboard;
+        BT::BlackBoardJournal journal(&blackboard, directory);
+        ASSERT_TRUE(journal.Start(std::chrono::milliseconds(1), std::chrono::milliseconds(2)));
+        BT::BlackBoardKey<int64_t> counter = blackboard.Intern<int64_t>("counter");
+        std::vector<std::thread> writers;
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            writers.push_back(std::thread([&blackboard, counter, increments_number]()
+            {
+                for (int64_t j = 0; j < increments_number; j++)
+                {
+                    blackboard.Add(counter, (int64_t)1);
+                }
+            }));
+        }
+        for (unsigned int i = 0; i < writers.size(); i++)
+        {
+            writers[i].join();
+        }
+        journal.Stop();
+        ASSERT_FALSE(journal.is_failed());
+        generation = journal.get_generation();
+    }
+
+    // the results of the additions may have been appended out of order: the last one is restored
+    BT::TypedBlackBoard blackboard;
+    BT::BlackBoardJournal journal(&blackboard, directory);
+    ASSERT_EQ(4 * increments_number, blackboard.GetByName<int64_t>("counter"));
+    RemoveJournalDirectory(directory, generation + 2);
+}
+
+TEST(BlackBoardJournalTest, OfflineReplay)
+{
+    std::string directory = MakeJournalDirectory();
+    ASSERT_FALSE(directory.empty());
+    {
+        BT::TypedBlackBoard blackboard;
+        // the logs are kept: the whole session
+        BT::BlackBoardJournal journal(&blackboard, directory, true);
+        ASSERT_TRUE(journal.Start(std::chrono::milliseconds(1), std::chrono::milliseconds(5)));
+        ASSERT_FALSE(journal.Start(std::chrono::milliseconds(1), std::chrono::milliseconds(5)));
+        BT::BlackBoardKey<int64_t> step = blackboard.Intern<int64_t>("step");
+        for (int64_t i = 1; i <= 200; i++)
+        {
+            blackboard.Set(step, i);
+            blackboard.SetByName<std::string>("state", i % 2 == 0 ? "even" : "odd");
+            if (i % 50 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        journal.Stop();
+        ASSERT_GT(journal.get_generation(), 1u);
+        ASSERT_FALSE(journal.is_failed());
+    }
+
+    // the logs in order give every write, in the order of each key
+    BT::TypedBlackBoard blackboard;
+    int64_t last_step = 0;
+    std::chrono::steady_clock::time_point last_time;
+    unsigned int generation = 0;
+    for (; std::ifstream(BT::BlackBoardJournal::GetLogPath(directory, generation).c_str()).good(); generation++)
+    {
+        BT::BlackBoardLogReader reader(BT::BlackBoardJournal::GetLogPath(directory, generation));
+        ASSERT_EQ(generation, reader.get_generation());
+        BT::BlackBoardLogRecord log_record;
+        while (reader.Next(&log_record))
+        {
+            ASSERT_GE(log_record.time, last_time);
+            last_time = log_record.time;
+            blackboard.SetRecord(log_record.record);
+            if (log_record.record.name == "step")
+            {
+                ASSERT_EQ(last_step + 1, blackboard.GetByName<int64_t>("step"));
+                last_step++;
+            }
+        }
+    }
+    ASSERT_EQ(200, last_step);
+    ASSERT_EQ("even", blackboard.GetByName<std::string>("state"));
+
+    BT::TypedBlackBoard other_blackboard;
+    ASSERT_GT(BT::ReplayLog(BT::BlackBoardJournal::GetLogPath(directory, 0), &other_blackboard), 0u);
+    ASSERT_TRUE(other_blackboard.Contains("step"));
+    ASSERT_THROW(BT::ReplayLog(BT::BlackBoardJournal::GetSnapshotPath(directory), &other_blackboard),
+                 BT::BehaviorTreeException);
+    RemoveJournalDirectory(directory, generation);
+}
+
+TEST(RcuTest, SynchronizeWaitsForReaders)
+{
+    std::atomic<int*> value(new int(1));
+    std::atomic<bool> is_reading(false);
+    std::atomic<bool> is_synchronized(false);
+
+    std::thread reader([&value, &is_reading, &is_synchronized]()
+    {
+        BT::Rcu::ReadGuard read_guard;
+        int* read_value = value.load();
+        is_reading = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // the old value cannot have been deleted yet
+        ASSERT_FALSE(is_synchronized);
+        ASSERT_EQ(1, *read_value);
+    });
+    while (!is_reading)
+    {
+        std::this_thread::yield();
+    }
+    BT::Rcu::Retire(value.exchange(new int(2)), &BT::Rcu::Delete<int>);
+    BT::Rcu::Synchronize();
+    is_synchronized = true;
+    reader.join();
+    ASSERT_EQ(0u, BT::Rcu::get_retired_number());
+    delete value.load();
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
@@ -11,6 +11,7 @@ namespace BT
     public:
         // Constructor
         ActionTestNode(std::string Name);
+        ActionTestNode(std::string Name, Executor* executor);
         ~ActionTestNode();
 
         // The method that is going to be executed by the thread
@@ -20,9 +21,12 @@ namespace BT
         // The method used to interrupt the execution of the node
         void Halt();
         void set_boolean_value(bool boolean_value);
+        // Time spent by Halt() before returning (the default is 0)
+        void set_halt_time_milliseconds(int halt_time_milliseconds);
     private:
         int time_;
         bool boolean_value_;
+        int halt_time_milliseconds_;
 
         ///ReturnStatus status_;
 
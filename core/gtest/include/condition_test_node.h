@@ -2,6 +2,7 @@
 #define CONDITIONTEST_H
 
 #include <condition_node.h>
+#include <atomic>
 
 namespace BT
 {
@@ -12,11 +13,17 @@ namespace BT
         ConditionTestNode(std::string Name);
         ~ConditionTestNode();
         void set_boolean_value(bool boolean_value);
+        // Time spent by Tick() before returning (the default is 0)
+        void set_time_milliseconds(int time_milliseconds);
+        // Number of calls to Tick()
+        int get_ticks_number();
 
         // The method that is going to be executed by the thread
         BT::ReturnStatus Tick();
     private:
         bool boolean_value_;
+        int time_milliseconds_;
+        std::atomic<int> ticks_number_;
     };
 }
 
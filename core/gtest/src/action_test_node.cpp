@@ -19,10 +19,18 @@ BT::ActionTestNode::ActionTestNode(std::string name) : ActionNode::ActionNode(na
 {
     boolean_value_ = true;
     time_ = 3;
+    halt_time_milliseconds_ = 0;
             DEBUG_STDOUT(" Constuctor for  " << get_name() << "called! Thread id:" << std::this_thread::get_id());
 
 }
 
+BT::ActionTestNode::ActionTestNode(std::string name, Executor* executor) : ActionNode::ActionNode(name, executor)
+{
+    boolean_value_ = true;
+    time_ = 3;
+    halt_time_milliseconds_ = 0;
+}
+
 BT::ActionTestNode::~ActionTestNode() {}
 
 BT::ReturnStatus BT::ActionTestNode::Tick()
@@ -32,7 +40,7 @@ BT::ReturnStatus BT::ActionTestNode::Tick()
     while (!is_halt_requested() && i++ < time_)
     {
         DEBUG_STDOUT(" Action " << get_name() << "running! Thread id:" << std::this_thread::get_id());
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        get_tick().clock->SleepFor(std::chrono::seconds(1));
     }
     if (!is_halt_requested())
     {
@@ -55,6 +63,10 @@ BT::ReturnStatus BT::ActionTestNode::Tick()
 
 void BT::ActionTestNode::Halt()
 {
+    if (halt_time_milliseconds_ > 0)
+    {
+        get_tick().clock->SleepFor(std::chrono::milliseconds(halt_time_milliseconds_));
+    }
     set_status(BT::HALTED);
     DEBUG_STDOUT("HALTED state set for the node: " << get_name());
 }
@@ -72,4 +84,7 @@ void BT::ActionTestNode::set_boolean_value(bool boolean_value)
     boolean_value_ = boolean_value;
 }
 
-
+void BT::ActionTestNode::set_halt_time_milliseconds(int halt_time_milliseconds)
+{
+    halt_time_milliseconds_ = halt_time_milliseconds;
+}
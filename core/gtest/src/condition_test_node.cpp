@@ -17,13 +17,21 @@
 BT::ConditionTestNode::ConditionTestNode(std::string name) : ConditionNode::ConditionNode(name)
 {
     boolean_value_ = true;
+    time_milliseconds_ = 0;
+    ticks_number_ = 0;
 }
 
 BT::ConditionTestNode::~ConditionTestNode() {}
 
 BT::ReturnStatus BT::ConditionTestNode::Tick()
 {
+        ticks_number_++;
+
         // Condition checking and state update
+        if (time_milliseconds_ > 0)
+        {
+            BT::GetDefaultClock()->SleepFor(std::chrono::milliseconds(time_milliseconds_));
+        }
 
         if (boolean_value_)
         {
@@ -45,3 +53,12 @@ void BT::ConditionTestNode::set_boolean_value(bool boolean_value)
     boolean_value_ = boolean_value;
 }
 
+void BT::ConditionTestNode::set_time_milliseconds(int time_milliseconds)
+{
+    time_milliseconds_ = time_milliseconds;
+}
+
+int BT::ConditionTestNode::get_ticks_number()
+{
+    return ticks_number_;
+}
@@ -2,21 +2,75 @@
 #define BEHAVIORTREECORE_ACTIONNODE_H
 
 #include "leaf_node.h"
+#include <executor.h>
+#include <tick_trigger.h>
+
+#include <chrono>
+#include <cstdint>
+#include <atomic>
 
 namespace BT
 {
+    // Deadline of the current tick of the tree, handed to the actions ticked in it.
+    // Execute() sets it to the deadline of the next tick. The default is no deadline
+    void SetTickDeadline(std::chrono::steady_clock::time_point deadline);
+    std::chrono::steady_clock::time_point GetTickDeadline();
+
+    // What an action receives with a tick (see ActionNode::get_tick())
+    struct TickDescriptor
+    {
+        // Monotonically increasing, one per tick sent to the action (0 before the first tick)
+        uint64_t tick_id;
+        // The clock of the times below, i.e. BT::GetDefaultClock() when the tick was sent.
+        // The tick is an activity of this clock until the action returns (see BT::VirtualClock)
+        Clock* clock;
+        // When the parent has sent the tick
+        std::chrono::steady_clock::time_point issue_time;
+        // When a worker has started executing it
+        std::chrono::steady_clock::time_point start_time;
+        // time_point::max() if the tick has no deadline
+        std::chrono::steady_clock::time_point deadline;
+
+        // Time left before the deadline (negative once it is missed)
+        std::chrono::steady_clock::duration get_remaining_budget() const;
+        // Time spent by the tick in the executor queue
+        std::chrono::steady_clock::duration get_queue_latency() const;
+    };
 
     class ActionNode : public LeafNode
     {
     public:
         // Constructor
         ActionNode(std::string name);
+        ActionNode(std::string name, Executor* executor);
+        // Waits for the task of the last tick (see WaitForTickReturn())
         ~ActionNode();
 
-        // The method that is going to be executed by the thread
-        void WaitForTick();
+        // The method used by the parent to send the tick. The tick is queued on the executor,
+        // the method Tick() will be executed by one of its workers
+        void SendTick();
+        // As above, with an explicit deadline instead of GetTickDeadline()
+        void SendTick(std::chrono::steady_clock::time_point deadline);
         virtual BT::ReturnStatus Tick() = 0;
 
+        // The tick being executed (to be called from Tick(), e.g. to shed work when the budget is short),
+        // or the last one once the action has returned
+        const TickDescriptor& get_tick();
+
+        // The method used by the parent to halt an action whose Tick() returns while it is running (e.g. a
+        // YARP action, whose Halt() is a blocking request to its module): sets the halt request and runs Halt()
+        // on the executor, then the status becomes HALTED. The halts of several actions are thus concurrent,
+        // and waited together (see BT::WaitForHaltResponses()). If the tick is still running, its task halts
+        // the action instead
+        void SendHalt();
+
+        // True from SendTick() (or SendHalt()) until the executor task of the tick (or of the halt) has returned.
+        // The node must not be destroyed while its tick is running (see BehaviorTree::Shutdown())
+        bool is_tick_in_flight();
+        // Blocks in real time until is_tick_in_flight() is false, whatever the default clock: the caller
+        // is not an activity of a VirtualClock (it must not be one, or the time cannot move for the task)
+        void WaitForTickReturn();
+
         // The method used to interrupt the execution of the node
         virtual void Halt() = 0;
 
@@ -24,6 +78,25 @@ namespace BT
         // conditional waiting (only mutual access)
         bool WriteState(ReturnStatus new_state);
     int DrawType();
+
+    private:
+        // The task submitted to the executor for each tick
+        void RunTick();
+        // The task submitted by SendHalt()
+        void RunHalt(Clock* clock);
+        // The end of the task: wakes up WaitForTickReturn()
+        void ReturnTick();
+
+        Executor* executor_;
+
+        // Mailbox of the tick: written by SendTick before submitting the tick, read by RunTick
+        TickDescriptor sent_tick_;
+        TickDescriptor tick_;
+        std::atomic<int> ticks_in_flight_number_;
+        // From SendTick() until RunTick() has set the status: a halt requested meanwhile is sent by RunTick()
+        std::atomic<bool> is_tick_running_;
+        // Whoever sets it (RunTick() or SendHalt()) calls Halt(), once per tick
+        std::atomic<bool> is_halt_sent_;
     };
 }
 
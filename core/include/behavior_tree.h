@@ -29,6 +29,19 @@
 #include <sequence_node_with_memory.h>
 #include <fallback_node_with_memory.h>
 
+#include <tick_program.h>
+#include <tick_scheduler.h>
+#include <tick_trigger.h>
+#include <clock.h>
+#include <tree_arena.h>
+#include <static_tree.h>
+#include <hot_swap_node.h>
+#include <typed_blackboard.h>
+#include <blackboard_stream.h>
+#include <shared_blackboard.h>
+#include <blackboard_journal.h>
+#include <metrics_port.h>
+
 #include <exceptions.h>
 
 #include <string>
@@ -43,7 +56,14 @@
 #include <mutex>
 
 
-void Execute(BT::ControlNode* root,int TickPeriod_milliseconds);
+// Ticks the root every TickPeriod_milliseconds (absolute deadlines, see BT::TickScheduler)
+void Execute(BT::ControlNode* root, int TickPeriod_milliseconds,
+             BT::OverrunPolicy overrun_policy = BT::SKIP_MISSED_TICKS);
+
+// Reactive mode: ticks the root only when something may have changed its outcome, i.e. when
+// BT::GetDefaultTickTrigger() is triggered (an action completes, the blackboard changes,
+// an external command), and anyway at least every MaxTickPeriod_milliseconds
+void ExecuteReactive(BT::ControlNode* root, int MaxTickPeriod_milliseconds);
 
 
 #endif
@@ -0,0 +1,156 @@
+#ifndef BLACKBOARD_JOURNAL_H
+#define BLACKBOARD_JOURNAL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <typed_blackboard.h>
+
+namespace BT
+{
+    const uint32_t BLACKBOARD_JOURNAL_LAYOUT_VERSION = 2;
+
+    // A write of the log, with the time of BT::GetDefaultClock(). record.version is the version of the write
+    // (see TypedBlackBoard::get_version()) in the session of the log
+    struct BlackBoardLogRecord
+    {
+        std::chrono::steady_clock::time_point time;
+        BlackBoardRecord record;
+    };
+
+    // Persistence of a typed blackboard, for a fast restart: an append-only log of the writes (write-ahead
+    // log) and snapshots of all the values, in a directory (which must exist).
+    // The constructor restores the blackboard from the latest snapshot and the logs written after it, takes
+    // a new snapshot and then logs every write with its new value (an Add() is logged as its result, so
+    // replaying a write twice is harmless).
+    // Each construction is a new session, numbered in the files. A write is logged after the key is unlocked,
+    // with its version: the concurrent writes of a key may be out of order in the log, and the restore keeps
+    // the latest write of each key (by session, then by version).
+    // A snapshot is a compact binary file, memory-mapped to be loaded. Each one starts a new log. The snapshot
+    // it replaces is kept as the previous one, with the logs written after it: the restore falls back to them
+    // if the latest snapshot is corrupted. The older logs are deleted, unless kept (e.g. to replay a session
+    // offline with BlackBoardLogReader).
+    // The records are buffered: a crash loses the ones not flushed yet, and the restart stops at the first
+    // record cut by the crash. A single journal per blackboard, created before the blackboard is written.
+    class BlackBoardJournal
+    {
+    public:
+        // Throws BehaviorTreeException if neither snapshot can be loaded, a log cannot be read, or the directory
+        // written
+        BlackBoardJournal(TypedBlackBoard* blackboard, const std::string& directory, bool are_logs_kept = false);
+        // Stops the background thread, detaches from the blackboard and flushes the log
+        ~BlackBoardJournal();
+
+        // Starts a new log and writes all the values (atomically: the file replaces the latest snapshot once
+        // complete and synced). Throws BehaviorTreeException if the files cannot be written
+        void Snapshot();
+        // Writes the buffered records to the log file
+        void Flush();
+
+        // Calls Flush() every flush_period and Snapshot() every snapshot_period (0: never) on a background
+        // thread, in real time. Returns false if the thread is already running
+        bool Start(std::chrono::milliseconds flush_period, std::chrono::milliseconds snapshot_period);
+        void Stop();
+
+        // The generation of the current log (the logs and the snapshots are numbered in order)
+        unsigned int get_generation();
+        // Records appended to the current log
+        uint64_t get_records_number();
+        // Values restored by the constructor: from the snapshot and from the logs
+        unsigned int get_snapshot_records_number();
+        uint64_t get_replayed_records_number();
+        // Whether the constructor restored the previous snapshot, the latest one being corrupted (or lost by a
+        // crash while replaced)
+        bool is_previous_snapshot_restored();
+
+        static std::string GetSnapshotPath(const std::string& directory);
+        static std::string GetPreviousSnapshotPath(const std::string& directory);
+        static std::string GetLogPath(const std::string& directory, unsigned int generation);
+
+        // Called by the blackboard (see TypedBlackBoard::set_journal()) after a write, with its version. Never
+        // throws: a record that cannot be written is dropped, and the log is marked as failed
+        void Append(const BlackBoardSlot* slot, uint64_t version, const void* bytes, std::size_t size);
+        bool is_failed();
+
+    private:
+        BlackBoardJournal(const BlackBoardJournal&);
+        BlackBoardJournal& operator=(const BlackBoardJournal&);
+
+        void Restore();
+        // Opens the log of next_generation_, then closes the current one. With log_mutex_ locked
+        void OpenNextLog();
+        void CloseLog();
+        void Run(std::chrono::milliseconds flush_period, std::chrono::milliseconds snapshot_period);
+
+        TypedBlackBoard* blackboard_;
+        std::string directory_;
+        bool are_logs_kept_;
+        uint32_t session_;
+
+        // Protects the log, appended by the writers of the blackboard
+        std::mutex log_mutex_;
+        FILE* log_file_;
+        unsigned int next_generation_;
+        // The oldest log not deleted yet
+        unsigned int first_generation_;
+        uint64_t records_number_;
+        bool is_failed_;
+        // by key index: whether the key (name and type) is in the current log, which refers to it by index
+        std::vector<char> is_key_logged_;
+        std::string record_buffer_;
+
+        // Serializes the snapshots
+        std::mutex snapshot_mutex_;
+        // The generation of the latest snapshot, if any: its logs are kept when it becomes the previous one
+        bool has_snapshot_;
+        unsigned int snapshot_generation_;
+        unsigned int snapshot_records_number_;
+        uint64_t replayed_records_number_;
+        bool is_previous_snapshot_restored_;
+
+        std::mutex thread_mutex_;
+        std::condition_variable thread_condition_;
+        std::thread thread_;
+        bool is_running_;
+    };
+
+    // Reads a log of BlackBoardJournal, e.g. to replay a session offline
+    class BlackBoardLogReader
+    {
+    public:
+        // Throws BehaviorTreeException if the file cannot be opened or is not a log (a log cut by a crash
+        // before its header is complete has no records)
+        explicit BlackBoardLogReader(const std::string& path);
+        ~BlackBoardLogReader();
+
+        // The next write. Returns false at the end of the log, or at the first record cut by a crash
+        bool Next(BlackBoardLogRecord* log_record);
+
+        unsigned int get_generation();
+        // The session of the journal that wrote the log
+        uint32_t get_session();
+
+    private:
+        BlackBoardLogReader(const BlackBoardLogReader&);
+        BlackBoardLogReader& operator=(const BlackBoardLogReader&);
+
+        FILE* file_;
+        unsigned int generation_;
+        uint32_t session_;
+        // by key index, as in the log
+        std::map<uint32_t, BlackBoardRecord> keys_;
+        std::string payload_;
+    };
+
+    // Sets all the writes of the log in the blackboard, but the ones older than a write of their key already
+    // set (appended out of order). Returns the number set
+    uint64_t ReplayLog(const std::string& path, TypedBlackBoard* blackboard);
+}
+
+#endif  // BLACKBOARD_JOURNAL_H
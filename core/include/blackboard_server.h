@@ -4,6 +4,19 @@
 #include <BlackBoardCmd.h>
 #include <yarp/os/RFModule.h>
 #include <yarp/os/Property.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Bottle.h>
+#include <typed_blackboard.h>
+#include <blackboard_stream.h>
+#include <blackboard_journal.h>
+#include <shared_blackboard.h>
+#include <tick_trigger.h>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 
 
@@ -11,6 +24,9 @@ class BlackBoardServer : public BlackBoardCmd, public yarp::os::RFModule
 {
 public:
     BlackBoardServer(yarp::os::Property* blackboard_ptr);
+    // Serves a typed blackboard (see BT::TypedBlackBoard) with the loose typing of a yarp::os::Property
+    BlackBoardServer(BT::TypedBlackBoard* typed_blackboard);
+    ~BlackBoardServer();
     virtual void SetI16(const std::string& name, const int16_t data);
     virtual void SetI32(const std::string& name, const int32_t data);
     virtual void SetI64(const std::string& name, const YARP_INT64 data);
@@ -25,6 +41,20 @@ public:
     virtual double GetDouble(const std::string& name);
     virtual bool GetBool(const std::string& name);
     virtual std::string GetString(const std::string& name);
+    // Batched and atomic calls: see BlackBoardCmd.thrift. They are serialized with each other. With a typed
+    // blackboard, CompareAndSet() and Increment() are atomic with respect to all the writers, and a batch of
+    // SetMany() is atomic for all the readers (see TypedBlackBoard::SetMany())
+    virtual std::vector<BlackBoardValue> GetMany(const std::vector<std::string>& names);
+    virtual bool SetMany(const std::vector<std::string>& names, const std::vector<BlackBoardValue>& values);
+    virtual bool CompareAndSet(const std::string& name, const BlackBoardValue& expected,
+                               const BlackBoardValue& desired);
+    virtual BlackBoardValue Increment(const std::string& name, const BlackBoardValue& delta);
+    // Change streaming (typed blackboard only): each subscription has its own output port,
+    // /<module name>/stream/<subscription id>, connected to the port of the client. Each message is a list
+    // with one entry per changed key: (name type version value), type as in BlackBoardType
+    virtual int32_t Subscribe(const std::string& client_port, const std::vector<std::string>& patterns,
+                              const double max_rate);
+    virtual bool Unsubscribe(const int32_t subscription_id);
 
 
     bool attach(yarp::os::Port &source);
@@ -34,8 +64,68 @@ public:
 
 
 private:
+    template <typename T>
+    void SetTyped(const std::string& name, const T& data)
+    {
+        try
+        {
+            typed_blackboard_->SetByName(name, data);
+            BT::GetDefaultTickTrigger()->Trigger();
+        }
+        catch( const std::exception & ex )
+        {
+            std::cout << "Cannot set variable " << name << std::endl;
+        }
+    }
+
+    template <typename T>
+    T GetTyped(const std::string& name, const T& default_data)
+    {
+        try
+        {
+            return typed_blackboard_->GetByName<T>(name);
+        }
+        catch( const std::exception & ex )
+        {
+            std::cout << "Cannot get variable " << name << std::endl;
+            return default_data;
+        }
+    }
+
+    // Called with blackboard_mutex_ locked. GetValue() returns NO_TYPE if the key has never been set,
+    // SetValue() returns false if the value cannot be stored (e.g. a string into a number)
+    BlackBoardValue GetValue(const std::string& name);
+    bool SetValue(const std::string& name, const BlackBoardValue& value);
+    bool IsSettable(const std::string& name, const BlackBoardValue& value);
+
+    // Publishes the changes on the subscription ports until close()
+    void StreamChanges();
+    void StopStreaming();
+
+    // NULL if the server has been constructed with a typed blackboard
     yarp::os::Property* blackboard_ptr_;
+    // NULL if the server has been constructed with a yarp::os::Property
+    BT::TypedBlackBoard* typed_blackboard_;
     yarp::os::Port cmd_port_;
+    // Serializes the calls on the yarp::os::Property, and the batched and atomic calls (the calls on a typed
+    // blackboard do not take it otherwise)
+    std::mutex blackboard_mutex_;
+
+    // NULL if the server has been constructed with a yarp::os::Property
+    BT::BlackBoardStream* stream_;
+    // by subscription id
+    std::map<unsigned int, yarp::os::BufferedPort<yarp::os::Bottle>*> stream_ports_;
+    std::mutex stream_mutex_;
+    std::thread stream_thread_;
+    std::atomic<bool> is_streaming_;
+
+    // With a typed blackboard and the option "journal" (a directory): the blackboard is restored by
+    // configure() and persisted until close(). NULL otherwise
+    BT::BlackBoardJournal* journal_;
+    // With a typed blackboard and the option "shared_blackboard" (a segment name, with "shared_blackboard_keys"
+    // keys): the segment where the values are mirrored for the other processes of the host. NULL otherwise
+    BT::SharedBlackBoard* shared_blackboard_;
+    BT::SharedBlackBoardMirror* shared_blackboard_mirror_;
 
 };
 
@@ -0,0 +1,77 @@
+#ifndef BLACKBOARD_STREAM_H
+#define BLACKBOARD_STREAM_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <typed_blackboard.h>
+
+namespace BT
+{
+    // The last value of a key, as streamed to the subscribers. Only the field of the type is meaningful:
+    // integer for the integers and the booleans, real for the doubles, text for the strings
+    struct BlackBoardDelta
+    {
+        std::string name;
+        BlackBoardValueType type;
+        uint64_t version;
+        int64_t integer;
+        double real;
+        std::string text;
+    };
+
+    // Whether name matches pattern, where '*' is any sequence of characters and '?' any character
+    bool MatchesKeyPattern(const std::string& pattern, const std::string& name);
+
+    // The changes of a typed blackboard, for subscriptions to key patterns (push instead of polling).
+    // The changes are coalesced: a subscriber gets the last value of each key changed since its previous
+    // message, and at most max_rate messages per second. The structures and the blobs are not streamed.
+    // It enables the change notification of the blackboard (see TypedBlackBoard::set_change_notified()):
+    // a single stream per blackboard. The time is the one of BT::GetDefaultClock()
+    class BlackBoardStream
+    {
+    public:
+        BlackBoardStream(TypedBlackBoard* blackboard);
+        ~BlackBoardStream();
+
+        // max_rate = 0: no limit. The first message holds all the matching keys set so far.
+        // Returns the id of the subscription
+        unsigned int Subscribe(const std::vector<std::string>& patterns, double max_rate);
+        // Returns false if there is no such subscription
+        bool Unsubscribe(unsigned int subscription_id);
+        std::vector<unsigned int> GetSubscriptions();
+
+        // The changes since the previous message of the subscription. Empty if nothing has changed, or if
+        // the rate limit does not allow a message yet (the changes are then kept for the next one).
+        // Throws BehaviorTreeException if there is no such subscription
+        std::vector<BlackBoardDelta> CollectDeltas(unsigned int subscription_id);
+
+        // Blocks until the blackboard changes, max_wait elapses or the rate limit of a subscription with
+        // pending changes expires, whichever comes first. Returns true if the blackboard has changed
+        bool WaitForChanges(std::chrono::milliseconds max_wait);
+
+    private:
+        struct Subscription
+        {
+            std::vector<std::string> patterns;
+            std::chrono::steady_clock::duration min_period;
+            std::chrono::steady_clock::time_point next_message_time;
+            // by key index: 1 if the key matches, 0 if not (extended as new keys are interned)
+            std::vector<char> is_key_matched;
+            // by key index: the version in the last message
+            std::vector<uint64_t> sent_versions;
+            // changes held back by the rate limit
+            bool is_pending;
+        };
+
+        TypedBlackBoard* blackboard_;
+        std::mutex subscriptions_mutex_;
+        std::map<unsigned int, Subscription> subscriptions_;
+        unsigned int next_subscription_id_;
+    };
+}
+
+#endif  // BLACKBOARD_STREAM_H
@@ -0,0 +1,95 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <set>
+
+namespace BT
+{
+    // The time seen by the tree: tick deadlines, halt deadlines, the tick scheduler, the tick trigger
+    // and the timed waits of the nodes. The trace and the metrics keep using the steady clock,
+    // since they measure the process and not the mission.
+    class Clock
+    {
+    public:
+        virtual ~Clock() {}
+
+        virtual std::chrono::steady_clock::time_point Now() = 0;
+        // Blocks the calling thread until the clock has reached time (returns at once if it is in the past)
+        virtual void SleepUntil(std::chrono::steady_clock::time_point time) = 0;
+        void SleepFor(std::chrono::steady_clock::duration duration);
+
+        // Blocks until is_done() returns true or the deadline has passed (time_point::max() is no deadline).
+        // lock must hold the mutex that protects the state read by is_done(); whoever changes that state
+        // notifies condition_variable. Returns the last value of is_done()
+        virtual bool WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& condition_variable,
+                               std::chrono::steady_clock::time_point deadline,
+                               const std::function<bool()>& is_done) = 0;
+
+        // An activity is a flow of work that the clock must wait for before moving the time forward,
+        // e.g. the thread that ticks the root or an action tick queued on the executor.
+        // BeginActivity() may be called by one thread and EndActivity() by another (no-ops in real time)
+        virtual void BeginActivity() {}
+        virtual void EndActivity() {}
+    };
+
+    // The steady clock and std::this_thread::sleep_until
+    class RealTimeClock : public Clock
+    {
+    public:
+        std::chrono::steady_clock::time_point Now();
+        void SleepUntil(std::chrono::steady_clock::time_point time);
+        bool WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& condition_variable,
+                       std::chrono::steady_clock::time_point deadline,
+                       const std::function<bool()>& is_done);
+    };
+
+    // Discrete-event time: it stands still while any activity is running and, once all of them are
+    // sleeping (or done), it jumps to the earliest wake up time. A tree can thus be simulated
+    // faster than real time, and deterministically with respect to the sleeps.
+    // SleepUntil() must be called only from within an activity: the sleeping activity is not waited.
+    // WaitUntil() polls is_done() every POLLING_PERIOD of virtual time, because the thread that
+    // changes the state may be sleeping in the clock itself.
+    class VirtualClock : public Clock
+    {
+    public:
+        static const std::chrono::milliseconds POLLING_PERIOD;
+
+        VirtualClock(std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::time_point());
+        ~VirtualClock();
+
+        std::chrono::steady_clock::time_point Now();
+        // Throws BehaviorTreeException if the caller is not within an activity
+        void SleepUntil(std::chrono::steady_clock::time_point time);
+        bool WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& condition_variable,
+                       std::chrono::steady_clock::time_point deadline,
+                       const std::function<bool()>& is_done);
+
+        void BeginActivity();
+        void EndActivity();
+
+        // Number of activities currently running (i.e. not sleeping)
+        int get_activities_number();
+
+    private:
+        // Moves the time to the earliest wake up if no activity is running. Called with mutex_ held
+        void AdvanceIfIdle();
+
+        std::mutex mutex_;
+        std::condition_variable condition_variable_;
+        std::chrono::steady_clock::time_point now_;
+        int activities_number_;
+        // wake up times of the sleeping activities
+        std::multiset<std::chrono::steady_clock::time_point> wake_up_times_;
+    };
+
+    // The clock used by the tree. If no clock has been set, the real-time clock is used.
+    // SetDefaultClock(NULL) restores the real-time clock
+    Clock* GetDefaultClock();
+    void SetDefaultClock(Clock* clock);
+}
+
+#endif  // CLOCK_H
@@ -3,8 +3,40 @@
 
 #include "leaf_node.h"
 
+#include <cstdint>
+#include <mutex>
+
 namespace BT
 {
+    // Per-tick memoization of the conditions, for DAG-shaped trees where a condition has several parents.
+    // When it is enabled, a condition is evaluated once per tick epoch and its first result
+    // is returned to every other parent that ticks it in the same epoch.
+    // It is disabled by default.
+    void SetConditionMemoization(bool is_enabled);
+    bool IsConditionMemoizationEnabled();
+
+    // The tick epoch of the calling thread, for the lifetime of the scope. Opened at each tick of the
+    // RootNode, of a TickProgram, of a Static::Tree and by Execute(): a scope opened outside any epoch
+    // begins a new one, unique in the process (so two trees never share it), a nested scope joins the
+    // current one. The ticks outside an epoch are never memoized
+    class TickEpochScope
+    {
+    public:
+        TickEpochScope();
+        // Joins the epoch of another thread (e.g. the helpers of a ParallelNode)
+        explicit TickEpochScope(uint64_t epoch);
+        ~TickEpochScope();
+
+    private:
+        TickEpochScope(const TickEpochScope&);
+        TickEpochScope& operator=(const TickEpochScope&);
+
+        uint64_t previous_epoch_;
+    };
+
+    // The epoch of the calling thread, 0 outside any TickEpochScope
+    uint64_t GetTickEpoch();
+
     class ConditionNode : public LeafNode
     {
     public:
@@ -15,6 +47,10 @@ namespace BT
         // The method that is going to be executed by the thread
         virtual BT::ReturnStatus Tick() = 0;
 
+        // Used by the parents instead of Tick(): with the memoization enabled,
+        // calls Tick() only at the first tick of the current epoch
+        BT::ReturnStatus TickOnce();
+
         // The method used to interrupt the execution of the node
         void Halt();
 
@@ -22,6 +58,12 @@ namespace BT
         // conditional waiting (only mutual access)
         bool WriteState(ReturnStatus new_state);
     int DrawType();
+
+    private:
+        // protects the memoized result (the parents of a shared condition may tick it concurrently)
+        std::mutex memoization_mutex_;
+        uint64_t memoized_epoch_;
+        ReturnStatus memoized_status_;
     };
 }
 
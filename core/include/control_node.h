@@ -4,9 +4,30 @@
 #include <vector>
 
 #include <tree_node.h>
+#include <action_node.h>
+#include <condition_node.h>
 
 namespace BT
 {
+    // Maximum time a control node waits for its running actions to complete their halt.
+    // All the halt requests of a subtree are sent at once, then the actions are waited together,
+    // hence the halt of a subtree takes at most this time. The default is no deadline
+    void SetHaltDeadline(std::chrono::milliseconds halt_deadline);
+    std::chrono::milliseconds GetHaltDeadline();
+
+    // Number of actions that have not completed their halt within the deadline so far.
+    // Each miss is also recorded in the trace (HALT_DEADLINE_MISSED), when it is running
+    unsigned long GetMissedHaltDeadlinesNumber();
+
+    // Waits (with the halt deadline) for the actions whose halt has been requested.
+    // Returns the number of actions that have missed the deadline
+    unsigned int WaitForHaltResponses(const std::vector<TreeNode*>& halting_actions);
+
+    // Requests the halt of a running action and appends it to halting_actions, without waiting: a YARP action
+    // is halted on the executor (see ActionNode::SendHalt()). An action that has already missed a halt
+    // deadline is not requested nor waited again
+    void RequestActionHalt(TreeNode* action, std::vector<TreeNode*>* halting_actions);
+
     class ControlNode : public TreeNode
     {
     protected:
@@ -21,6 +42,10 @@ namespace BT
         //child i status. Used to rout the ticks
         ReturnStatus child_i_status_;
 
+        // Ticks a child that is not an action and returns its status
+        // (conditions go through ConditionNode::TickOnce())
+        ReturnStatus TickSynchronousChild(TreeNode* child);
+
     public:
         // Constructor
         ControlNode(std::string name);
@@ -36,6 +61,10 @@ namespace BT
         void Halt();
         void ResetColorState();
         void HaltChildren(int i);
+        // First phase of HaltChildren: requests the halt of the running actions from the i-th child on,
+        // in the whole subtree, and appends them to halting_actions. Does not wait.
+        // Overridden by the control nodes whose actions are not runtime children (e.g. Static::Subtree)
+        virtual void RequestHaltChildren(int i, std::vector<TreeNode*>* halting_actions);
         int Depth();
 
         // Methods used to access the node state without the
@@ -2,20 +2,27 @@
 #define DECORATORSYNC_H
 
 #include <control_node.h>
+#include <sync_link.h>
 
 namespace BT
 {
+// Executes its child in lock step with the other DecoratorSync nodes with the same link name:
+// once the child has returned SUCCESS or FAILURE, the decorator returns RUNNING until all the
+// other participants are done with the same tick, then it returns the result of the child.
 class DecoratorSync : public ControlNode
 {
 public:
     DecoratorSync(std::string name, std::string link_name);
+    ~DecoratorSync();
     BT::ReturnStatus Tick();
     void Halt();
     int DrawType();
 
 private:
-    TickEngine::SyncLink* link_;
-    unsigned int tick_id_;
+    SyncLink* link_;
+    uint64_t tick_id_;
+    // true once the child is done with tick_id_ - 1 and the other participants are not
+    bool is_waiting_link_;
 };
 }
 #endif // DECORATORSYNC_H
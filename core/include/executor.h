@@ -0,0 +1,89 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace BT
+{
+    // Abstract class of the objects that run the ticks of the action nodes.
+    // An action does not own a thread: when it receives a tick it submits a task to its executor.
+    class Executor
+    {
+    public:
+        virtual ~Executor() {}
+
+        // Queues the task. It will run on one of the executor's threads
+        virtual void Submit(std::function<void()> task) = 0;
+
+        virtual unsigned int get_workers_number() = 0;
+    };
+
+    // Pool of workers with one task deque per worker.
+    // A worker pops the tasks from the back of its own deque and, when this is empty,
+    // it steals from the front of the deques of the other workers.
+    // An action tick blocks its worker for the whole duration of the action: when a task is submitted
+    // and no worker is free to run it, a new worker is started (up to max_workers_number), so that
+    // every running action is actually running. The workers are never stopped before the executor.
+    // Past the cap the tasks wait in the deques: their actions look RUNNING but do not run until a worker
+    // is free. Each such submit is counted (get_saturated_submits_number()) and traced (EXECUTOR_SATURATED).
+    class WorkStealingExecutor : public Executor
+    {
+    public:
+        static const unsigned int MAX_WORKERS_NUMBER = 256;
+
+        // workers_number = 0 means one worker per core. max_workers_number = workers_number is a fixed-size pool
+        WorkStealingExecutor(unsigned int workers_number = 0, unsigned int max_workers_number = MAX_WORKERS_NUMBER);
+        ~WorkStealingExecutor();
+
+        void Submit(std::function<void()> task);
+        // The workers started so far
+        unsigned int get_workers_number();
+        // The submits that have found no free worker with the workers already at max_workers_number
+        unsigned long get_saturated_submits_number();
+
+    private:
+        struct Worker
+        {
+            std::mutex mutex_;
+            std::deque< std::function<void()> > tasks_;
+            std::thread thread_;
+        };
+
+        void WorkerLoop(unsigned int worker_idx);
+        bool PopTask(unsigned int worker_idx, std::function<void()>& task);
+        // Starts a worker if the pending tasks outnumber the free workers
+        void GrowIfBusy();
+
+        // The first workers_number_ are started: a worker is published (release) once its deque exists
+        Worker* workers_[MAX_WORKERS_NUMBER];
+        std::atomic<unsigned int> workers_number_;
+        unsigned int max_workers_number_;
+        std::atomic<unsigned int> next_worker_idx_;
+        // Submitted and not popped yet. Incremented before the push, so it never goes negative
+        std::atomic<int> pending_tasks_number_;
+        // Running a task. Incremented before pending_tasks_number_ is decremented: the sum never misses a task
+        std::atomic<int> busy_workers_number_;
+        std::atomic<unsigned long> saturated_submits_number_;
+        bool stop_;
+
+        // used only to put to sleep the workers that have nothing to do
+        std::mutex idle_mutex_;
+        std::condition_variable idle_condition_variable_;
+        // serializes the start of new workers
+        std::mutex grow_mutex_;
+    };
+
+    // The executor given to the action nodes that do not specify one.
+    // If no executor has been set, a WorkStealingExecutor with one worker per core (growing while they
+    // are all busy) is created.
+    Executor* GetDefaultExecutor();
+    void SetDefaultExecutor(Executor* executor);
+}
+
+#endif  // EXECUTOR_H
@@ -0,0 +1,67 @@
+#ifndef HOTSWAPNODE_H
+#define HOTSWAPNODE_H
+
+#include <atomic>
+
+#include <control_node.h>
+#include <tree_arena.h>
+
+namespace BT
+{
+// What happens to the running actions of the old version when a new one is swapped in:
+// - "HALT_RUNNING_ACTIONS": their halt is requested (not waited) and the new version is ticked at once;
+// - "FINISH_RUNNING_ACTIONS": the old version keeps being ticked until it returns SUCCESS or FAILURE,
+//   then the new version takes over (no action is interrupted).
+enum HandOverPolicy {HALT_RUNNING_ACTIONS, FINISH_RUNNING_ACTIONS};
+
+// A subtree that can be replaced while the tree is being ticked (or the whole tree, if it is the
+// child of the root). Swap() publishes a new version from any thread; the tick thread adopts it at
+// the beginning of its next tick, with no lock and no wait (RCU style).
+// The old versions are retired and destroyed once quiescent, i.e. when none of their actions
+// is running anymore: by CollectRetiredVersions() (called by Swap()) and by the destructor,
+// never by Tick().
+// The child is set by Swap(), not by AddChild().
+class HotSwapNode : public ControlNode
+{
+public:
+    HotSwapNode(std::string name);
+    // Requests the halt of all the versions, waits for them to be quiescent and destroys them
+    ~HotSwapNode();
+
+    BT::ReturnStatus Tick();
+    int DrawType();
+
+    // Takes the ownership of version, whose root must be set. A version published and
+    // not adopted yet is replaced (and destroyed) by the following one
+    void Swap(BehaviorTree* version, HandOverPolicy hand_over_policy = HALT_RUNNING_ACTIONS);
+    // Destroys the retired versions that are quiescent. Returns the number of versions still retired
+    unsigned int CollectRetiredVersions();
+
+    // Number of versions adopted by Tick() so far
+    unsigned int get_swaps_number();
+
+private:
+    struct Version
+    {
+        BehaviorTree* tree;
+        HandOverPolicy hand_over_policy;
+        Version* next;  // in the retired stack
+    };
+
+    // Called by Tick() only
+    void Adopt(Version* version);
+    void Retire(Version* version);
+
+    // The version ticked (owned by the tick thread)
+    Version* current_version_;
+    // Published by Swap(), adopted by Tick()
+    std::atomic<Version*> pending_version_;
+    // Lock-free stack: pushed by Tick(), emptied by CollectRetiredVersions()
+    std::atomic<Version*> retired_versions_;
+    // Serializes Swap() and CollectRetiredVersions()
+    std::mutex collect_mutex_;
+    std::atomic<unsigned int> swaps_number_;
+};
+}
+
+#endif  // HOTSWAPNODE_H
@@ -0,0 +1,33 @@
+#ifndef METRICS_PORT_H
+#define METRICS_PORT_H
+
+#include <node_metrics.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Bottle.h>
+
+#include <string>
+
+namespace BT
+{
+    // Publishes the metrics report of a tree (see BT::Metrics) on a YARP port.
+    // Each message is a list with one entry per node:
+    // (name successes failures (tick count p50 p99 max) (running count p50 p99 max) (halt count p50 p99 max)),
+    // latencies in microseconds
+    class MetricsPort
+    {
+    public:
+        MetricsPort(std::string port_name);
+        ~MetricsPort();
+
+        bool Open();
+        void Close();
+        // Collects the report of the tree and writes it on the port (does not wait for the readers)
+        void Publish(TreeNode* root);
+
+    private:
+        std::string port_name_;
+        yarp::os::BufferedPort<yarp::os::Bottle> port_;
+    };
+}
+
+#endif  // METRICS_PORT_H
@@ -0,0 +1,107 @@
+#ifndef NODE_METRICS_H
+#define NODE_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace BT
+{
+    class TreeNode;
+
+    // Per-node metrics: tick call duration, time spent RUNNING, halt latency and success/failure counts.
+    // The collection is switched on and off at runtime; when it is off the only cost on the tick path
+    // is the (predicted) branch on IsEnabled(). The metrics of a node are allocated at its first sample.
+    namespace Metrics
+    {
+        // Log-linear (HDR-style) histogram of durations in nanoseconds: 8 sub-buckets per power of two,
+        // i.e. a relative error below 12.5%, from 1 ns to about 18 minutes (larger values go in the last bucket).
+        // Recording is a few relaxed atomic operations: no locks, safe from any thread
+        class Histogram
+        {
+        public:
+            static const unsigned int SUB_BUCKET_BITS = 3;
+            static const unsigned int SUB_BUCKETS_NUMBER = 1 << SUB_BUCKET_BITS;
+            static const unsigned int MAX_EXPONENT = 40;
+            static const unsigned int BUCKETS_NUMBER = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS_NUMBER;
+
+            Histogram();
+
+            void Record(uint64_t value_ns);
+
+            uint64_t get_count();
+            uint64_t get_max();
+            // Upper bound of the bucket that contains the given percentile (in [0, 100]), 0 if empty
+            uint64_t get_percentile(double percentile);
+
+            static unsigned int BucketIndex(uint64_t value_ns);
+            // Smallest value that falls in the bucket
+            static uint64_t BucketLowerBound(unsigned int bucket_idx);
+
+        private:
+            std::atomic<uint32_t> buckets_[BUCKETS_NUMBER];
+            std::atomic<uint64_t> count_;
+            std::atomic<uint64_t> max_;
+        };
+
+        struct NodeMetrics
+        {
+            Histogram tick_duration;
+            Histogram running_time;
+            Histogram halt_latency;
+            std::atomic<uint64_t> successes_number;
+            std::atomic<uint64_t> failures_number;
+            // Start of the current RUNNING period and of the current halt (0 if none)
+            std::atomic<int64_t> running_start_ns;
+            std::atomic<int64_t> halt_start_ns;
+
+            NodeMetrics();
+        };
+
+        // Not to be used directly: see IsEnabled()
+        extern std::atomic<bool> is_enabled_;
+
+        inline bool IsEnabled()
+        {
+            return is_enabled_.load(std::memory_order_relaxed);
+        }
+        void SetEnabled(bool is_enabled);
+
+        // steady_clock time in nanoseconds
+        inline int64_t NowNanoseconds()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        struct HistogramSummary
+        {
+            uint64_t count;
+            uint64_t p50_ns;
+            uint64_t p99_ns;
+            uint64_t max_ns;
+        };
+
+        struct NodeReport
+        {
+            std::string name;
+            HistogramSummary tick_duration;
+            HistogramSummary running_time;
+            HistogramSummary halt_latency;
+            uint64_t successes_number;
+            uint64_t failures_number;
+        };
+
+        // One entry per node of the tree that has recorded something (a node with several parents appears once)
+        std::vector<NodeReport> CollectReport(TreeNode* root);
+        // One line per node, latencies in microseconds
+        void PrintReport(const std::vector<NodeReport>& report, std::ostream& stream);
+        // Returns false if the file cannot be written
+        bool WriteReport(TreeNode* root, const std::string& file_name);
+    }
+}
+
+#endif  // NODE_METRICS_H
@@ -2,6 +2,7 @@
 #define PARALLEL_NODE_H
 
 #include <control_node.h>
+#include <memory>
 
 namespace BT
 {
@@ -10,6 +11,9 @@ class ParallelNode : public ControlNode
 public:
     // Constructor
     ParallelNode(std::string name, int threshold_M);
+    // Concurrent parallel: at each tick the children are ticked at the same time, in a fork-join
+    // on the executor (the ticking thread takes part too). The children must not share nodes.
+    ParallelNode(std::string name, int threshold_M, Executor* executor);
     ~ParallelNode();
     int DrawType();
     // The method that is going to be executed by the thread
@@ -24,13 +28,46 @@ public:
     void set_threshold_M(unsigned int threshold_M);
 
 private:
+    // The state of one concurrent tick. It is shared with the executor tasks,
+    // that may start after the tick has returned (they find no child left to tick)
+    struct ForkJoin
+    {
+        unsigned int children_number_;
+        std::atomic<unsigned int> next_child_idx_;
+        std::atomic<unsigned int> done_children_number_;
+        // RUNNING until the threshold is reached, then SUCCESS or FAILURE
+        std::atomic<int> status_;
+        std::mutex mutex_;
+        std::condition_variable condition_variable_;
+        // the clock the helpers are activities of
+        Clock* clock_;
+        // the tick epoch the helpers join, for the memoized conditions
+        uint64_t tick_epoch_;
+    };
+
+    // Ticks the child i (sending the tick if it is an action) and returns its status
+    BT::ReturnStatus TickChild(unsigned int i);
+    // Counts the status of the child i. Returns SUCCESS or FAILURE to the only caller
+    // that makes the number of successes or failures reach the threshold, RUNNING otherwise
+    BT::ReturnStatus CountChildStatus(unsigned int i, BT::ReturnStatus child_status);
+    // Ends the tick if the threshold has been reached
+    BT::ReturnStatus ReturnTickStatus(BT::ReturnStatus status);
+
+    BT::ReturnStatus TickSequential();
+    BT::ReturnStatus TickConcurrent();
+    static void TickChildren(ParallelNode* node, std::shared_ptr<ForkJoin> fork_join);
+    // The task submitted to the executor for each helper
+    static void RunHelper(ParallelNode* node, std::shared_ptr<ForkJoin> fork_join);
 
     bool are_children_syncronized_;
 
     unsigned int tick_id_;
     unsigned int threshold_M_;
-    unsigned int success_childred_num_;
-    unsigned int failure_childred_num_;
+    std::atomic<unsigned int> success_childred_num_;
+    std::atomic<unsigned int> failure_childred_num_;
+
+    // NULL if the parallel is not concurrent
+    Executor* executor_;
 
 };
 }
@@ -5,8 +5,8 @@
 
 #include <mutex>
 #include <blackboard.h>
+#include <typed_blackboard.h>
 #include <yarp/os/Value.h>
-#include <yarp/os/Property.h> // the blackboard is a yarp property
 
 
 
@@ -16,7 +16,7 @@ namespace BT
 class PythonActionNode : public BT::ActionNode
 {
 public:
-    PythonActionNode(std::string name, std::string filename, yarp::os::Property* blackboard_ptr = NULL);
+    PythonActionNode(std::string name, std::string filename, BT::TypedBlackBoard* blackboard_ptr = NULL);
     ~PythonActionNode();
     BT::ReturnStatus Tick();
     void Finalize();
@@ -31,9 +31,10 @@ private:
     //lua_State *lua_state_;
     //PyObject* python_state_;
     // PyObject* python_tick_fn_;
+    // Sets the value with the type of the yarp::os::Value (an int as an int32), then wakes the reactive ticks
     void WriteOnBlackboard(std::string key, yarp::os::Value value);
     yarp::os::Value ReadFromBlackboard(std::string key);
-    yarp::os::Property* blackboard_ptr_;
+    BT::TypedBlackBoard* blackboard_ptr_;
     bool lua_script_done_;
     std::mutex lua_script_done_mutex_;
     // BlackBoardCmd* blackboard_cmd_;
@@ -3,8 +3,8 @@
 #include "condition_node.h"
 #include <mutex>
 #include <blackboard.h>
+#include <typed_blackboard.h>
 #include <yarp/os/Value.h>
-#include <yarp/os/Property.h> // the blackboard is a yarp property
 
 
 
@@ -14,7 +14,7 @@ namespace BT
 class PythonConditionNode : public BT::ConditionNode
 {
 public:
-    PythonConditionNode(std::string name, std::string filename, yarp::os::Property* blackboard = NULL);
+    PythonConditionNode(std::string name, std::string filename, BT::TypedBlackBoard* blackboard = NULL);
     ~PythonConditionNode();
     BT::ReturnStatus Tick();
     void Finalize();
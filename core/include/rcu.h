@@ -0,0 +1,45 @@
+#ifndef RCU_H
+#define RCU_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace BT
+{
+    // Read-copy-update for the objects that many threads read and few replace (e.g. the strings of the
+    // blackboard): a writer publishes a new copy with an atomic pointer and retires the old one, which
+    // is deleted once all the read-side sections that may still use it have ended (epoch-based reclamation).
+    // The readers take no lock: a read-side section publishes the current epoch in a per-thread record.
+    namespace Rcu
+    {
+        // Read-side section: the objects loaded within it are not deleted before it ends. Sections can be nested
+        class ReadGuard
+        {
+        public:
+            ReadGuard();
+            ~ReadGuard();
+
+        private:
+            ReadGuard(const ReadGuard&);
+            ReadGuard& operator=(const ReadGuard&);
+        };
+
+        // To be called once the object is no longer reachable by new readers (e.g. after the pointer swap)
+        void Retire(void* object, void (*deleter)(void* object));
+
+        template <typename T>
+        void Delete(void* object)
+        {
+            delete static_cast<T*>(object);
+        }
+
+        // Waits until the read-side sections in progress have ended, then deletes all the retired objects.
+        // Must not be called within a read-side section
+        void Synchronize();
+
+        // Objects retired and not deleted yet
+        unsigned int get_retired_number();
+    }
+}
+
+#endif  // RCU_H
@@ -0,0 +1,85 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace BT
+{
+    // The write and read protocol of a value stored as atomic words next to a sequence, shared by
+    // TypedBlackBoard and SharedBlackBoard. The sequence is even at rest and twice the number of writes.
+    // A writer makes it odd with a CAS (so the writers of a value are serialized) and even again once done;
+    // a reader copies the words and retries if the sequence has changed meanwhile.
+    // Only atomics are used: the protocol also works between processes, on shared memory (where a writer
+    // may also die within its write: see SharedBlackBoard).
+    namespace Seqlock
+    {
+        // Waits for the other writers, then makes the sequence odd. Returns the even sequence
+        inline uint64_t BeginWrite(std::atomic<uint64_t>* sequence)
+        {
+            uint64_t value = sequence->load(std::memory_order_relaxed);
+            while ((value & 1) || !sequence->compare_exchange_weak(value, value + 1, std::memory_order_acquire,
+                                                                   std::memory_order_relaxed))
+            {
+                if (value & 1)
+                {
+                    std::this_thread::yield();
+                    value = sequence->load(std::memory_order_relaxed);
+                }
+            }
+            return value;
+        }
+
+        // A write: begin_sequence + 2. No write (nothing has changed): begin_sequence
+        inline void EndWrite(std::atomic<uint64_t>* sequence, uint64_t end_sequence)
+        {
+            sequence->store(end_sequence, std::memory_order_release);
+        }
+
+        // Waits for the write in progress, if any. Returns the sequence to pass to IsReadValid()
+        inline uint64_t BeginRead(const std::atomic<uint64_t>* sequence)
+        {
+            uint64_t value = sequence->load(std::memory_order_acquire);
+            while (value & 1)
+            {
+                std::this_thread::yield();
+                value = sequence->load(std::memory_order_acquire);
+            }
+            return value;
+        }
+
+        // Whether the words loaded (relaxed) since BeginRead() are the ones of a single write
+        inline bool IsReadValid(const std::atomic<uint64_t>* sequence, uint64_t begin_sequence)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return sequence->load(std::memory_order_relaxed) == begin_sequence;
+        }
+
+        inline void Read(const std::atomic<uint64_t>* sequence, const std::atomic<uint64_t>* words,
+                         uint64_t* values, unsigned int words_number)
+        {
+            uint64_t begin_sequence;
+            do
+            {
+                begin_sequence = BeginRead(sequence);
+                for (unsigned int i = 0; i < words_number; i++)
+                {
+                    values[i] = words[i].load(std::memory_order_relaxed);
+                }
+            }
+            while (!IsReadValid(sequence, begin_sequence));
+        }
+
+        // Between BeginWrite() and EndWrite()
+        inline void Write(std::atomic<uint64_t>* words, const uint64_t* values, unsigned int words_number)
+        {
+            for (unsigned int i = 0; i < words_number; i++)
+            {
+                words[i].store(values[i], std::memory_order_release);
+            }
+        }
+    }
+}
+
+#endif  // SEQLOCK_H
@@ -0,0 +1,284 @@
+#ifndef SHARED_BLACKBOARD_H
+#define SHARED_BLACKBOARD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <blackboard_stream.h>
+#include <exceptions.h>
+#include <seqlock.h>
+#include <typed_blackboard.h>
+
+namespace boost
+{
+    namespace interprocess
+    {
+        class mapped_region;
+    }
+}
+
+namespace BT
+{
+    // Changed whenever the layout of the segment changes: a process never maps a segment of another layout
+    const uint32_t SHARED_BLACKBOARD_LAYOUT_VERSION = 2;
+    const unsigned int SHARED_KEY_NAME_MAX_SIZE = 64;
+
+    // The beginning of the segment. The slots follow, at SharedBlackBoard::SLOTS_OFFSET
+    struct SharedBlackBoardHeader
+    {
+        // set last by the creator: the segment is initialized
+        std::atomic<uint64_t> magic;
+        uint32_t layout_version;
+        uint32_t keys_capacity;
+        // bytes of value per key (the strings and the blobs have their length in the first word)
+        uint32_t value_capacity;
+        uint32_t slot_size;
+        // the slots [0, keys_number) are published, their name and type never change
+        std::atomic<uint32_t> keys_number;
+        // serializes the creation of the keys, between all the processes: the pid of the creator, 0 if none
+        std::atomic<uint32_t> intern_lock;
+    };
+
+    // A key of the segment, followed by the words of its value
+    struct SharedBlackBoardSlot
+    {
+        char name[SHARED_KEY_NAME_MAX_SIZE];
+        uint32_t type;
+        // sizeof of the value, 0 for the strings and the blobs
+        uint32_t value_size;
+        // serializes the writers of the key, between all the processes: the pid of the writer, 0 if none
+        std::atomic<uint32_t> writer_pid;
+        uint32_t reserved;
+        // as BlackBoardSlot::sequence (see BT::Seqlock)
+        std::atomic<uint64_t> sequence;
+
+        std::atomic<uint64_t>* get_words() { return reinterpret_cast<std::atomic<uint64_t>*>(this + 1); }
+    };
+
+    // Handle of a key of a SharedBlackBoard, valid in the process (mapping) that has interned it
+    template <typename T>
+    class SharedBlackBoardKey
+    {
+    public:
+        SharedBlackBoardKey() : slot_(NULL) {}
+
+        bool is_valid() { return slot_ != NULL; }
+        std::string get_name() { return slot_->name; }
+
+    private:
+        friend class SharedBlackBoard;
+        explicit SharedBlackBoardKey(SharedBlackBoardSlot* slot) : slot_(slot) {}
+
+        SharedBlackBoardSlot* slot_;
+    };
+
+    // A blackboard in a named shared-memory segment, which the processes of the same host map: a read is a
+    // few loads from the segment, with no RPC and no serialization. The layout is typed and versioned (see
+    // SHARED_BLACKBOARD_LAYOUT_VERSION), with a fixed number of keys, and it has no pointers.
+    // The values have the types of TypedBlackBoard and the same protocol (see BT::Seqlock): the readers take
+    // no lock, the writers of a key are serialized. The strings and the blobs are stored inline, up to the
+    // string capacity of the segment, and read under the seqlock as well (RCU would need a shared heap).
+    // The locks hold the pid of their owner, so that a process that dies with a key locked does not block
+    // the others: the next writer of the key takes the lock over and sets a whole value again. Until then,
+    // the readers of the key throw BehaviorTreeException instead of waiting for a write that never ends.
+    class SharedBlackBoard
+    {
+    public:
+        static const unsigned int SLOTS_OFFSET = 64;
+
+        // Creates the segment, replacing a stale one with the same name. The creator removes it when destroyed
+        SharedBlackBoard(const std::string& segment_name, unsigned int keys_capacity,
+                         unsigned int string_capacity = 256);
+        // Maps an existing segment. Throws BehaviorTreeException if there is none or if its layout is another one
+        explicit SharedBlackBoard(const std::string& segment_name);
+        ~SharedBlackBoard();
+
+        // Returns the handle of the key, creating it in the segment if needed. Throws BehaviorTreeException
+        // if the key has another type, if its name is too long or if the segment is full
+        template <typename T>
+        SharedBlackBoardKey<T> Intern(const std::string& name)
+        {
+            return SharedBlackBoardKey<T>(InternSlot(name, BlackBoardTypeOf<T>::value, IsBytes<T>::value ? 0 : sizeof(T)));
+        }
+
+        // T() if the value has never been set. Throws BehaviorTreeException if the value has been left
+        // half-written by a process that has died
+        template <typename T>
+        T Get(SharedBlackBoardKey<T> key)
+        {
+            return Load<T>(key.slot_, IsBytes<T>());
+        }
+
+        // Throws BehaviorTreeException if a string or a blob exceeds the string capacity
+        template <typename T>
+        void Set(SharedBlackBoardKey<T> key, const T& value)
+        {
+            Store(key.slot_, value, IsBytes<T>());
+        }
+
+        // Number of sets of the key so far, by all the processes (0 if never set)
+        template <typename T>
+        uint64_t get_version(SharedBlackBoardKey<T> key)
+        {
+            return key.slot_->sequence.load(std::memory_order_acquire) / 2;
+        }
+
+        bool Contains(const std::string& name);
+        // The keys, in order of creation
+        std::vector<std::string> GetNames();
+        unsigned int get_keys_number();
+        unsigned int get_keys_capacity();
+        unsigned int get_string_capacity();
+
+        // Removes the segment (e.g. left by a process that has crashed). Returns false if there is none
+        static bool Remove(const std::string& segment_name);
+
+    private:
+        SharedBlackBoard(const SharedBlackBoard&);
+        SharedBlackBoard& operator=(const SharedBlackBoard&);
+
+        template <typename T>
+        struct IsBytes : std::integral_constant<bool, BlackBoardTypeOf<T>::value == STRING_VALUE
+                                                      || BlackBoardTypeOf<T>::value == BLOB_VALUE> {};
+
+        SharedBlackBoardSlot* get_slot(unsigned int index)
+        {
+            return reinterpret_cast<SharedBlackBoardSlot*>(slots_ + index * header_->slot_size);
+        }
+        // NULL if there is no such key
+        SharedBlackBoardSlot* FindSlot(const std::string& name);
+        SharedBlackBoardSlot* InternSlot(const std::string& name, BlackBoardValueType type, uint32_t value_size);
+
+        // Seqlock::BeginWrite() and EndWrite(), with the key locked by the pid of this process
+        uint64_t BeginWrite(SharedBlackBoardSlot* slot);
+        void EndWrite(SharedBlackBoardSlot* slot, uint64_t sequence);
+        // Seqlock::BeginRead(), which throws if the writer in progress has died
+        uint64_t BeginRead(SharedBlackBoardSlot* slot);
+
+        template <typename T>
+        T Load(SharedBlackBoardSlot* slot, std::false_type)
+        {
+            const unsigned int words_number = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+            uint64_t words[BlackBoardSlot::WORDS_NUMBER];
+            std::atomic<uint64_t>* slot_words = slot->get_words();
+            uint64_t sequence;
+            do
+            {
+                sequence = BeginRead(slot);
+                for (unsigned int i = 0; i < words_number; i++)
+                {
+                    words[i] = slot_words[i].load(std::memory_order_relaxed);
+                }
+            }
+            while (!Seqlock::IsReadValid(&slot->sequence, sequence));
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void Store(SharedBlackBoardSlot* slot, const T& value, std::false_type)
+        {
+            uint64_t words[BlackBoardSlot::WORDS_NUMBER] = {0};
+            std::memcpy(words, &value, sizeof(T));
+            uint64_t sequence = BeginWrite(slot);
+            Seqlock::Write(slot->get_words(), words, (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            EndWrite(slot, sequence);
+        }
+
+        // The first word is the length, the bytes follow
+        template <typename T>
+        T Load(SharedBlackBoardSlot* slot, std::true_type)
+        {
+            const unsigned int max_words_number = header_->value_capacity / sizeof(uint64_t);
+            std::vector<uint64_t> words(max_words_number);
+            std::atomic<uint64_t>* slot_words = slot->get_words();
+            uint64_t length;
+            uint64_t sequence;
+            do
+            {
+                sequence = BeginRead(slot);
+                // a torn length is bounded, and then discarded by IsReadValid()
+                length = std::min<uint64_t>(slot_words[0].load(std::memory_order_relaxed),
+                                            header_->value_capacity - sizeof(uint64_t));
+                for (unsigned int i = 1; i <= (length + sizeof(uint64_t) - 1) / sizeof(uint64_t); i++)
+                {
+                    words[i] = slot_words[i].load(std::memory_order_relaxed);
+                }
+            }
+            while (!Seqlock::IsReadValid(&slot->sequence, sequence));
+
+            T value(length, 0);
+            if (length > 0)
+            {
+                std::memcpy(&value[0], &words[1], length);
+            }
+            return value;
+        }
+
+        template <typename T>
+        void Store(SharedBlackBoardSlot* slot, const T& value, std::true_type)
+        {
+            if (value.size() > header_->value_capacity - sizeof(uint64_t))
+            {
+                throw BehaviorTreeException("the value of '" + std::string(slot->name) + "' exceeds the string capacity");
+            }
+            const unsigned int words_number = 1 + (value.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+            std::vector<uint64_t> words(words_number, 0);
+            words[0] = value.size();
+            if (!value.empty())
+            {
+                std::memcpy(&words[1], &value[0], value.size());
+            }
+            uint64_t sequence = BeginWrite(slot);
+            Seqlock::Write(slot->get_words(), &words[0], words_number);
+            EndWrite(slot, sequence);
+        }
+
+        std::string segment_name_;
+        bool is_owner_;
+        boost::interprocess::mapped_region* region_;
+        SharedBlackBoardHeader* header_;
+        char* slots_;
+    };
+
+    // Mirrors a typed blackboard into a SharedBlackBoard, for the readers of the other processes: a
+    // subscription to all the keys of the stream of the blackboard, copied by Update() (e.g. on the thread
+    // that waits for the changes, see BlackBoardStream::WaitForChanges()). Like the stream, it skips the
+    // structures and the blobs
+    class SharedBlackBoardMirror
+    {
+    public:
+        SharedBlackBoardMirror(BlackBoardStream* stream, SharedBlackBoard* shared_blackboard);
+        // Unsubscribes from the stream
+        ~SharedBlackBoardMirror();
+
+        // Copies the values changed since the previous call, from a single thread. Returns their number.
+        // A value that does not fit the segment (e.g. it is full, or the key has another type there) is skipped
+        unsigned int Update();
+
+        uint64_t get_skipped_number();
+
+    private:
+        SharedBlackBoardMirror(const SharedBlackBoardMirror&);
+        SharedBlackBoardMirror& operator=(const SharedBlackBoardMirror&);
+
+        template <typename T>
+        void Copy(const std::string& name, const T& value)
+        {
+            shared_blackboard_->Set(shared_blackboard_->Intern<T>(name), value);
+        }
+
+        BlackBoardStream* stream_;
+        SharedBlackBoard* shared_blackboard_;
+        unsigned int subscription_id_;
+        uint64_t skipped_number_;
+    };
+}
+
+#endif  // SHARED_BLACKBOARD_H
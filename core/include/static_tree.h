@@ -0,0 +1,441 @@
+#ifndef STATIC_TREE_H
+#define STATIC_TREE_H
+
+#include <vector>
+
+#include <control_node.h>
+
+namespace BT
+{
+    // Trees composed at compile time, e.g.
+    //
+    //   typedef Static::Sequence<Static::Cond<IsReady>,
+    //                            Static::Fallback<Static::Cond<IsDone>, Static::Node> > MyTree;
+    //   Static::Tree<MyTree> tree;
+    //   tree.get_root().get_child<1>().get_child<1>().set_node(action);
+    //   tree.Tick();
+    //
+    // The children are members of their parent: the tick is dispatched statically, with no
+    // virtual call and no type switch, and the compiler can inline the whole tree.
+    // Sequence, Fallback and Parallel have the same semantics as SequenceNode, FallbackNode and
+    // ParallelNode (the children of a Parallel are ticked in order, as in TickProgram).
+    // Static::Node ticks a runtime TreeNode (e.g. an ActionNode or a whole subtree) with the
+    // same hand-off as the control nodes; Static::Subtree puts a static tree into a runtime one.
+    //
+    // Every static node has:
+    //   ReturnStatus Tick();
+    //   ReturnStatus get_status();
+    //   void set_status(ReturnStatus new_status);  // the parent sets IDLE once it has read the result
+    //   void RequestHalt(std::vector<TreeNode*>* halting_actions);  // as ControlNode::RequestHaltChildren
+    //   void CompleteHalt();  // after BT::WaitForHaltResponses(): the running nodes become HALTED
+    namespace Static
+    {
+        // A condition: SUCCESS if predicate() returns true, FAILURE otherwise.
+        // Predicate is a default-constructible functor, reachable through get_predicate()
+        template <typename Predicate>
+        class Cond
+        {
+        public:
+            Cond() : status_(BT::IDLE) {}
+
+            ReturnStatus Tick()
+            {
+                status_ = predicate_() ? BT::SUCCESS : BT::FAILURE;
+                return status_;
+            }
+
+            ReturnStatus get_status() { return status_; }
+            void set_status(ReturnStatus new_status) { status_ = new_status; }
+
+            // a condition has nothing to halt
+            void RequestHalt(std::vector<TreeNode*>* /*halting_actions*/) {}
+            void CompleteHalt() { status_ = BT::IDLE; }
+
+            Predicate& get_predicate() { return predicate_; }
+
+        private:
+            Predicate predicate_;
+            ReturnStatus status_;
+        };
+
+        // A synchronous action: Function is a default-constructible functor that returns the status,
+        // executed within the tick of the tree (it must not block). When halted, it is simply not ticked anymore
+        template <typename Function>
+        class Act
+        {
+        public:
+            Act() : status_(BT::IDLE) {}
+
+            ReturnStatus Tick()
+            {
+                status_ = function_();
+                return status_;
+            }
+
+            ReturnStatus get_status() { return status_; }
+            void set_status(ReturnStatus new_status) { status_ = new_status; }
+
+            void RequestHalt(std::vector<TreeNode*>* /*halting_actions*/) {}
+            void CompleteHalt()
+            {
+                if (status_ == BT::RUNNING)
+                {
+                    status_ = BT::HALTED;
+                }
+            }
+
+            Function& get_function() { return function_; }
+
+        private:
+            Function function_;
+            ReturnStatus status_;
+        };
+
+        // A runtime node (see set_node()), ticked and halted as the children of a ControlNode
+        class Node
+        {
+        public:
+            Node() : node_(NULL) {}
+
+            void set_node(TreeNode* node) { node_ = node; }
+            TreeNode* get_node() { return node_; }
+
+            ReturnStatus Tick()
+            {
+                ReturnStatus status;
+                if (node_->get_type() == BT::ACTION_NODE || node_->get_type() == BT::YARP_ACTION_NODE)
+                {
+                    status = node_->get_status();
+                    if (status == BT::IDLE || status == BT::HALTED)
+                    {
+                        static_cast<ActionNode*>(node_)->SendTick();
+                        status = node_->WaitForTickResponse();
+                    }
+                }
+                else
+                {
+                    status = node_->get_type() == BT::CONDITION_NODE ?
+                                static_cast<ConditionNode*>(node_)->TickOnce() : node_->Tick();
+                    node_->set_status(status);
+                }
+                return status;
+            }
+
+            ReturnStatus get_status() { return node_->get_status(); }
+            void set_status(ReturnStatus new_status) { node_->set_status(new_status); }
+
+            void RequestHalt(std::vector<TreeNode*>* halting_actions)
+            {
+                if (node_->get_status() != BT::RUNNING)
+                {
+                    return;
+                }
+                if (node_->get_type() == BT::ACTION_NODE || node_->get_type() == BT::YARP_ACTION_NODE)
+                {
+                    BT::RequestActionHalt(node_, halting_actions);
+                }
+                else if (node_->get_type() == BT::CONTROL_NODE)
+                {
+                    static_cast<ControlNode*>(node_)->RequestHaltChildren(0, halting_actions);
+                }
+            }
+
+            void CompleteHalt()
+            {
+                if (node_->get_type() == BT::CONDITION_NODE)
+                {
+                    node_->ResetColorState();
+                }
+                else if (node_->get_status() == BT::RUNNING && node_->get_type() == BT::CONTROL_NODE)
+                {
+                    node_->Halt();
+                }
+            }
+
+        private:
+            TreeNode* node_;
+        };
+
+        // The children of a composite node, as a recursive list of members
+        template <typename... Children>
+        struct ChildList;
+
+        template <>
+        struct ChildList<>
+        {
+            ReturnStatus TickSequence() { return BT::SUCCESS; }
+            ReturnStatus TickFallback() { return BT::FAILURE; }
+            ReturnStatus TickParallel(unsigned int /*threshold_M*/, unsigned int /*max_failures_number*/,
+                                      unsigned int /*success_children_number*/, unsigned int /*failure_children_number*/)
+            {
+                return BT::RUNNING;
+            }
+            void RequestHalt(std::vector<TreeNode*>* /*halting_actions*/) {}
+            void CompleteHalt() {}
+        };
+
+        template <typename First, typename... Rest>
+        struct ChildList<First, Rest...>
+        {
+            First first;
+            ChildList<Rest...> rest;
+
+            // Halts the children after the first one (as ControlNode::HaltChildren(i + 1))
+            void HaltRest()
+            {
+                std::vector<TreeNode*> halting_actions;
+                rest.RequestHalt(&halting_actions);
+                BT::WaitForHaltResponses(halting_actions);
+                rest.CompleteHalt();
+            }
+
+            ReturnStatus TickSequence()
+            {
+                ReturnStatus status = first.Tick();
+                if (status != BT::SUCCESS)
+                {
+                    if (status == BT::FAILURE)
+                    {
+                        first.set_status(BT::IDLE);
+                    }
+                    HaltRest();
+                    return status;
+                }
+                first.set_status(BT::IDLE);
+                return rest.TickSequence();
+            }
+
+            ReturnStatus TickFallback()
+            {
+                ReturnStatus status = first.Tick();
+                if (status != BT::FAILURE)
+                {
+                    if (status == BT::SUCCESS)
+                    {
+                        first.set_status(BT::IDLE);
+                    }
+                    HaltRest();
+                    return status;
+                }
+                first.set_status(BT::IDLE);
+                return rest.TickFallback();
+            }
+
+            // Ticks the children in order, counting the ones that have completed, until the outcome is known
+            ReturnStatus TickParallel(unsigned int threshold_M, unsigned int max_failures_number,
+                                      unsigned int success_children_number, unsigned int failure_children_number)
+            {
+                switch (first.Tick())
+                {
+                case BT::SUCCESS:
+                    first.set_status(BT::IDLE);
+                    if (++success_children_number == threshold_M)
+                    {
+                        return BT::SUCCESS;
+                    }
+                    break;
+                case BT::FAILURE:
+                    first.set_status(BT::IDLE);
+                    if (++failure_children_number > max_failures_number)
+                    {
+                        return BT::FAILURE;
+                    }
+                    break;
+                default:
+                    break;
+                }
+                return rest.TickParallel(threshold_M, max_failures_number,
+                                         success_children_number, failure_children_number);
+            }
+
+            void RequestHalt(std::vector<TreeNode*>* halting_actions)
+            {
+                first.RequestHalt(halting_actions);
+                rest.RequestHalt(halting_actions);
+            }
+
+            void CompleteHalt()
+            {
+                first.CompleteHalt();
+                rest.CompleteHalt();
+            }
+        };
+
+        // Type and member access of the child_idx-th child of a ChildList
+        template <unsigned int child_idx, typename List>
+        struct ChildAt;
+
+        template <typename First, typename... Rest>
+        struct ChildAt<0, ChildList<First, Rest...> >
+        {
+            typedef First Type;
+            static Type& Get(ChildList<First, Rest...>& children) { return children.first; }
+        };
+
+        template <unsigned int child_idx, typename First, typename... Rest>
+        struct ChildAt<child_idx, ChildList<First, Rest...> >
+        {
+            typedef typename ChildAt<child_idx - 1, ChildList<Rest...> >::Type Type;
+            static Type& Get(ChildList<First, Rest...>& children)
+            {
+                return ChildAt<child_idx - 1, ChildList<Rest...> >::Get(children.rest);
+            }
+        };
+
+        // Status and halt of the composite nodes
+        template <typename... Children>
+        class Composite
+        {
+        public:
+            Composite() : status_(BT::IDLE) {}
+
+            template <unsigned int child_idx>
+            typename ChildAt<child_idx, ChildList<Children...> >::Type& get_child()
+            {
+                return ChildAt<child_idx, ChildList<Children...> >::Get(children_);
+            }
+
+            ReturnStatus get_status() { return status_; }
+            void set_status(ReturnStatus new_status) { status_ = new_status; }
+
+            void RequestHalt(std::vector<TreeNode*>* halting_actions)
+            {
+                if (status_ == BT::RUNNING)
+                {
+                    children_.RequestHalt(halting_actions);
+                }
+            }
+
+            void CompleteHalt()
+            {
+                if (status_ == BT::RUNNING)
+                {
+                    children_.CompleteHalt();
+                    status_ = BT::HALTED;
+                }
+            }
+
+        protected:
+            ChildList<Children...> children_;
+            ReturnStatus status_;
+        };
+
+        template <typename... Children>
+        class Sequence : public Composite<Children...>
+        {
+            static_assert(sizeof...(Children) > 0, "a sequence needs at least one child");
+
+        public:
+            ReturnStatus Tick()
+            {
+                this->status_ = this->children_.TickSequence();
+                return this->status_;
+            }
+        };
+
+        template <typename... Children>
+        class Fallback : public Composite<Children...>
+        {
+            static_assert(sizeof...(Children) > 0, "a fallback needs at least one child");
+
+        public:
+            ReturnStatus Tick()
+            {
+                this->status_ = this->children_.TickFallback();
+                return this->status_;
+            }
+        };
+
+        // SUCCESS as soon as threshold_M children have succeeded, FAILURE as soon as more than
+        // N - threshold_M have failed (the running children are halted in both cases)
+        template <unsigned int threshold_M, typename... Children>
+        class Parallel : public Composite<Children...>
+        {
+            static_assert(threshold_M > 0 && threshold_M <= sizeof...(Children),
+                          "the threshold must be between 1 and the number of children");
+
+        public:
+            ReturnStatus Tick()
+            {
+                ReturnStatus status = this->children_.TickParallel(threshold_M, sizeof...(Children) - threshold_M, 0, 0);
+                if (status != BT::RUNNING)
+                {
+                    // the execution is done (or hopeless): halts the children still running
+                    std::vector<TreeNode*> halting_actions;
+                    this->children_.RequestHalt(&halting_actions);
+                    BT::WaitForHaltResponses(halting_actions);
+                    this->children_.CompleteHalt();
+                }
+                this->status_ = status;
+                return status;
+            }
+        };
+
+        // Halts a static node, with a single wait for all its running actions
+        template <typename StaticNode>
+        void Halt(StaticNode& node)
+        {
+            std::vector<TreeNode*> halting_actions;
+            node.RequestHalt(&halting_actions);
+            BT::WaitForHaltResponses(halting_actions);
+            node.CompleteHalt();
+        }
+
+        // The root of a static tree: each tick is a new epoch for the memoized conditions, as RootNode::Tick()
+        template <typename Root>
+        class Tree
+        {
+        public:
+            ReturnStatus Tick()
+            {
+                BT::TickEpochScope epoch;
+                return root_.Tick();
+            }
+
+            void Halt() { Static::Halt(root_); }
+
+            Root& get_root() { return root_; }
+
+        private:
+            Root root_;
+        };
+
+        // A static tree as a node of a runtime tree (a control node with no runtime children)
+        template <typename Root>
+        class Subtree : public ControlNode
+        {
+        public:
+            Subtree(std::string name) : ControlNode(name) {}
+
+            // Sets its own status, as the runtime control nodes (a ParallelNode parent does not)
+            ReturnStatus Tick()
+            {
+                ReturnStatus status = root_.Tick();
+                set_status(status);
+                return status;
+            }
+
+            // The actions of the static tree join the halt requests of the runtime parent (i is ignored)
+            void RequestHaltChildren(int /*i*/, std::vector<TreeNode*>* halting_actions)
+            {
+                root_.RequestHalt(halting_actions);
+            }
+
+            // After RequestHaltChildren() and the wait of the parent, there is nothing left to wait for
+            void Halt()
+            {
+                Static::Halt(root_);
+                set_status(BT::HALTED);
+            }
+
+            int DrawType() { return BT::SUBTREE; }
+
+            Root& get_root() { return root_; }
+
+        private:
+            Root root_;
+        };
+    }
+}
+
+#endif  // STATIC_TREE_H
@@ -0,0 +1,47 @@
+#ifndef SYNC_LINK_H
+#define SYNC_LINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace BT
+{
+    // Barrier shared by the DecoratorSync nodes with the same link name, which execute their
+    // children in lock step: the tick tick_id starts only when all the participants are done with tick_id - 1.
+    // It is a sense-reversing barrier where the sense is the tick ID: the last participant that arrives
+    // resets the counter and publishes the next tick ID. No locks and no blocking: a participant
+    // that has arrived polls is_tick_id_ready() at its next ticks.
+    class SyncLink
+    {
+    public:
+        SyncLink(std::string name);
+        ~SyncLink();
+
+        // The participants are counted at the construction of the DecoratorSync nodes.
+        // They must not change while the link is in use
+        void AddParticipant();
+        void RemoveParticipant();
+        unsigned int get_participants_number();
+
+        // True once all the participants are done with the ticks before tick_id
+        bool is_tick_id_ready(uint64_t tick_id);
+        // Called by each participant when it is done with the tick tick_id (the current one)
+        void NodeDone(uint64_t tick_id);
+        // The tick currently executed by the participants
+        uint64_t get_tick_id();
+
+        std::string get_name();
+
+    private:
+        std::string name_;
+        std::atomic<uint32_t> participants_number_;
+        std::atomic<uint32_t> arrived_participants_number_;
+        std::atomic<uint64_t> tick_id_;
+    };
+
+    // Process-wide registry: returns the link with the given name, created at the first call
+    SyncLink* GetSyncLink(const std::string& name);
+}
+
+#endif  // SYNC_LINK_H
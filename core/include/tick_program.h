@@ -0,0 +1,66 @@
+#ifndef TICK_PROGRAM_H
+#define TICK_PROGRAM_H
+
+#include <vector>
+#include <cstdint>
+
+#include <tree_node.h>
+
+namespace BT
+{
+    // A tree compiled into flat arrays (struct of arrays), ticked by a single interpreter function.
+    // The nodes are stored in breadth-first order, hence the children of a control node
+    // are contiguous: they are the nodes [first_child, first_child + children_number).
+    // Sequence, Fallback and Parallel have the same semantics as SequenceNode, FallbackNode
+    // and ParallelNode. The leaves are ticked through a function pointer on the original
+    // TreeNode; actions keep their asynchronous hand-off.
+    // The program refers to the leaves of the tree it has been compiled from, that must outlive it.
+    // A node shared by several parents (DAG-shaped tree) is compiled once per parent.
+    class TickProgram
+    {
+    public:
+        enum NodeKind {SEQUENCE_KIND, FALLBACK_KIND, PARALLEL_KIND, CONDITION_KIND, ACTION_KIND};
+
+        typedef ReturnStatus (*LeafTickFunction)(TreeNode* leaf);
+        // Requests the halt of a running leaf and appends it to halting_actions if it has to be waited
+        typedef void (*LeafHaltFunction)(TreeNode* leaf, std::vector<TreeNode*>* halting_actions);
+
+        // Compiles the tree. Throws BehaviorTreeException if it contains a node kind
+        // that cannot be compiled (e.g. a node with memory or a decorator)
+        TickProgram(TreeNode* root);
+        ~TickProgram();
+
+        ReturnStatus Tick();
+        void Halt();
+
+        unsigned int get_nodes_number();
+        // Status of the node node_idx (in breadth-first order) after the last tick
+        ReturnStatus get_status(unsigned int node_idx);
+
+    private:
+        ReturnStatus TickNode(uint32_t node_idx);
+        ReturnStatus TickSequence(uint32_t node_idx);
+        ReturnStatus TickFallback(uint32_t node_idx);
+        ReturnStatus TickParallel(uint32_t node_idx);
+        // Halts the children of node_idx from the child_idx-th on
+        // (all the halt requests first, then a single wait, as ControlNode::HaltChildren())
+        void HaltChildren(uint32_t node_idx, uint32_t child_idx);
+        void RequestHaltChildren(uint32_t node_idx, uint32_t child_idx, std::vector<TreeNode*>* halting_actions);
+
+        // Hot arrays, one entry per node
+        std::vector<uint8_t> kinds_;
+        std::vector<uint8_t> statuses_;
+        // For control nodes: index of the first child. For leaves: index in the leaf arrays
+        std::vector<uint32_t> first_children_;
+        std::vector<uint32_t> children_numbers_;
+        // Parallel threshold M (0 for the other nodes)
+        std::vector<uint32_t> thresholds_;
+
+        // One entry per leaf
+        std::vector<LeafTickFunction> leaf_tick_functions_;
+        std::vector<LeafHaltFunction> leaf_halt_functions_;
+        std::vector<TreeNode*> leaves_;
+    };
+}
+
+#endif  // TICK_PROGRAM_H
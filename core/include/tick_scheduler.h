@@ -0,0 +1,64 @@
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+#include <clock.h>
+
+namespace BT
+{
+    // What to do when a tick ends after the deadline of the next one:
+    // - "SKIP_MISSED_TICKS": the missed ticks are skipped, the next tick starts at the next deadline;
+    // - "CATCH_UP": the missed ticks are executed one after the other without sleeping,
+    //   until the schedule is met again;
+    // - "STRETCH_PERIOD": the next tick starts immediately and the following deadlines are
+    //   shifted by the delay.
+    enum OverrunPolicy {SKIP_MISSED_TICKS, CATCH_UP, STRETCH_PERIOD};
+
+    // Fixed-rate tick scheduler. The deadlines are absolute (start + k * period on the clock that is
+    // BT::GetDefaultClock() at construction), hence the time spent ticking does not make the period drift.
+    class TickScheduler
+    {
+    public:
+        // Number of bins of the jitter histogram
+        static const unsigned int JITTER_BINS_NUMBER = 24;
+
+        TickScheduler(std::chrono::microseconds period, OverrunPolicy overrun_policy = SKIP_MISSED_TICKS);
+        ~TickScheduler();
+
+        // Sleeps until the deadline of the next tick. The first call returns immediately
+        void WaitForNextTick();
+        // Deadline of the tick after the current one, i.e. the end of the time budget of the current tick
+        std::chrono::steady_clock::time_point get_next_deadline();
+
+        unsigned long get_ticks_number();
+        // Number of ticks that ended after the deadline of the next tick
+        unsigned long get_overruns_number();
+        unsigned long get_skipped_ticks_number();
+        // Delay of the wake up with respect to the deadline
+        std::chrono::microseconds get_max_jitter();
+        // Bin 0 counts the wake ups with a jitter < 1 us, bin i those with a jitter in [2^(i-1), 2^i) us.
+        // The last bin counts all the larger jitters
+        std::vector<unsigned long> get_jitter_histogram();
+
+        void PrintStatistics(std::ostream& stream);
+
+    private:
+        Clock* clock_;
+        std::chrono::steady_clock::duration period_;
+        OverrunPolicy overrun_policy_;
+        bool is_started_;
+        std::chrono::steady_clock::time_point next_deadline_;
+
+        unsigned long ticks_number_;
+        unsigned long overruns_number_;
+        unsigned long skipped_ticks_number_;
+        std::chrono::microseconds max_jitter_;
+        std::vector<unsigned long> jitter_histogram_;
+    };
+}
+
+#endif  // TICK_SCHEDULER_H
@@ -0,0 +1,44 @@
+#ifndef TICK_TRIGGER_H
+#define TICK_TRIGGER_H
+
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <clock.h>
+
+namespace BT
+{
+    // Wakes up a tree executed in reactive mode (see ExecuteReactive()).
+    // It is triggered when an action completes its tick, when the blackboard changes
+    // (TypedBlackBoard writes, BlackBoardServer setters and PythonActionNode writes), on the
+    // commands of BTCmd and by anyone that needs an immediate tick.
+    // The triggers that arrive while the tree is ticking are coalesced into one.
+    class TickTrigger
+    {
+    public:
+        TickTrigger();
+        ~TickTrigger();
+
+        // Never blocks if the trigger is already pending
+        void Trigger();
+
+        // Blocks until Trigger() is called or max_wait has elapsed (on BT::GetDefaultClock()).
+        // Returns true (and clears the trigger) if it has been triggered
+        bool WaitForTrigger(std::chrono::milliseconds max_wait);
+
+        unsigned long get_triggers_number();
+
+    private:
+        std::atomic<bool> is_triggered_;
+        std::atomic<unsigned long> triggers_number_;
+        std::mutex mutex_;
+        std::condition_variable condition_variable_;
+    };
+
+    // The trigger used by the action nodes and by the blackboard
+    TickTrigger* GetDefaultTickTrigger();
+}
+
+#endif  // TICK_TRIGGER_H
@@ -0,0 +1,102 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <sstream>
+
+// Compile-time trace level. Every BT_TRACE_* call above the level is removed by the preprocessor,
+// its arguments included, so a release build pays nothing for it.
+// - BT_TRACE_LEVEL_NONE: no tracing (default in release builds, i.e. when NDEBUG is defined);
+// - BT_TRACE_LEVEL_EVENTS: status changes, halts and tick requests (default otherwise);
+// - BT_TRACE_LEVEL_DEBUG: also the DEBUG_STDOUT messages (default when DEBUG is defined).
+#define BT_TRACE_LEVEL_NONE 0
+#define BT_TRACE_LEVEL_EVENTS 1
+#define BT_TRACE_LEVEL_DEBUG 2
+
+#ifndef BT_TRACE_LEVEL
+#if defined(DEBUG)
+#define BT_TRACE_LEVEL BT_TRACE_LEVEL_DEBUG
+#elif defined(NDEBUG)
+#define BT_TRACE_LEVEL BT_TRACE_LEVEL_NONE
+#else
+#define BT_TRACE_LEVEL BT_TRACE_LEVEL_EVENTS
+#endif
+#endif
+
+
+#if BT_TRACE_LEVEL >= BT_TRACE_LEVEL_EVENTS
+#define BT_TRACE_EVENT(type, name, value) do { if (BT::Trace::IsRunning()) { \
+    BT::Trace::Record((type), (name), (value)); } } while (false)
+#else
+#define BT_TRACE_EVENT(type, name, value) do { } while (false)
+#endif
+
+// DEBUG_STDOUT is the front-end for the free-text messages: the message is formatted
+// on the calling thread and stored (truncated) in the trace like any other event
+#if BT_TRACE_LEVEL >= BT_TRACE_LEVEL_DEBUG
+#define DEBUG_STDOUT(message) do { if (BT::Trace::IsRunning()) { std::ostringstream trace_stream; \
+    trace_stream << message; BT::Trace::Record(BT::Trace::MESSAGE, trace_stream.str(), 0); } } while (false)
+#else
+#define DEBUG_STDOUT(message)
+#endif
+
+
+namespace BT
+{
+    // Structured tracing of the tree execution.
+    // Each thread writes its events in binary form into its own ring buffer (single producer,
+    // single consumer, no locks). A background thread drains all the buffers into a file.
+    // While the drain is not running the events are discarded; when a buffer is full
+    // the new events are dropped and counted.
+    namespace Trace
+    {
+        enum EventType {MESSAGE, SET_STATUS, HALT, HALT_CHILD, NO_NEED_TO_HALT, TICK_RETURN,
+                        REQUEST_TICK, TICK_REQUESTED, REQUEST_HALT, HALT_REQUESTED, HALT_DEADLINE_MISSED,
+                        EXECUTOR_SATURATED};
+
+        // The record written in the trace file (after a header with the magic "BTTRACE1"
+        // and the record size as uint32_t)
+        struct Event
+        {
+            // steady_clock time in nanoseconds
+            uint64_t timestamp_ns;
+            // index of the thread (i.e. of the ring buffer) that recorded the event
+            uint32_t thread_idx;
+            uint16_t type;
+            // event argument, e.g. the new status for SET_STATUS
+            int16_t value;
+            // node name or message, truncated and null terminated
+            char text[48];
+        };
+
+        // Set by Start() and Stop()
+        extern std::atomic<bool> is_running_flag;
+
+        // Whether the drain is running. BT_TRACE_EVENT checks it before evaluating its arguments
+        // (e.g. the node name), so that an event discarded costs a single load
+        inline bool IsRunning()
+        {
+            return is_running_flag.load(std::memory_order_relaxed);
+        }
+
+        // Records an event. Never blocks and never allocates after the first event of the thread
+        void Record(EventType type, const std::string& text, int value);
+
+        // Starts the background thread that writes the events to file_name.
+        // Returns false if the file cannot be opened or the drain is already running
+        bool Start(const std::string& file_name, unsigned int drain_period_milliseconds = 10);
+
+        // Drains the remaining events, closes the file and stops the background thread
+        void Stop();
+
+        // Number of events lost so far because a ring buffer was full
+        uint64_t get_dropped_events_number();
+
+        // Name of an event type (used to convert the binary trace to text)
+        const char* EventTypeName(EventType type);
+    }
+}
+
+#endif  // TRACE_H
@@ -0,0 +1,132 @@
+#ifndef TREE_ARENA_H
+#define TREE_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <tree_node.h>
+
+namespace BT
+{
+    // Bump allocator: the memory is carved out of large blocks, that are released all together
+    // when the arena is destroyed. Nothing is freed before (no per-allocation bookkeeping)
+    class TreeArena
+    {
+    public:
+        static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        TreeArena(size_t block_size = DEFAULT_BLOCK_SIZE);
+        ~TreeArena();
+
+        // alignment must be a power of two. Allocations larger than the block size get a block of their own
+        void* Allocate(size_t size, size_t alignment);
+
+        size_t get_allocated_bytes();
+        unsigned int get_blocks_number();
+
+    private:
+        TreeArena(const TreeArena&);
+        TreeArena& operator=(const TreeArena&);
+
+        size_t block_size_;
+        std::vector<char*> blocks_;
+        char* next_;
+        char* end_;
+        size_t allocated_bytes_;
+    };
+
+    // Memory used by the nodes of one type (see BehaviorTree::GetMemoryReport())
+    struct NodeTypeMemory
+    {
+        std::string type_name;
+        unsigned int nodes_number;
+        // sizeof of the node type
+        size_t node_size;
+        // side tables and metrics allocated so far, summed over the nodes (see TreeNode::get_side_tables_size())
+        size_t side_tables_bytes;
+    };
+
+    // Owns all the nodes of a tree, allocated in one arena.
+    // The destructor shuts the tree down (see Shutdown()), destroys the nodes in reverse order
+    // of creation and releases the arena blocks at once.
+    // The nodes must not be ticked while the tree is being shut down or destroyed.
+    class BehaviorTree
+    {
+    public:
+        BehaviorTree(size_t arena_block_size = TreeArena::DEFAULT_BLOCK_SIZE);
+        ~BehaviorTree();
+
+        // Constructs a node of type NodeType in the arena, e.g. CreateNode<SequenceNode>("sequence").
+        // Throws BehaviorTreeException once the tree has been shut down
+        template <typename NodeType, typename... Args>
+        NodeType* CreateNode(Args&&... args)
+        {
+            if (is_shut_down_)
+            {
+                throw BehaviorTreeException("the tree has been shut down, no node can be added");
+            }
+            void* memory = arena_.Allocate(sizeof(NodeType), alignof(NodeType));
+            NodeType* node = new (memory) NodeType(std::forward<Args>(args)...);
+
+            OwnedNode owned_node;
+            owned_node.node = node;
+            // ~TreeNode is not virtual: the node is destroyed through its own type
+            owned_node.destroy = &DestroyNode<NodeType>;
+            owned_node.type = &typeid(NodeType);
+            owned_node.size = sizeof(NodeType);
+            nodes_.push_back(owned_node);
+            return node;
+        }
+
+        void set_root(TreeNode* root);
+        TreeNode* get_root();
+
+        // Requests the halt of all the running actions, without waiting for it. The halt of a YARP action is
+        // also sent to its server, on the executor (see ActionNode::SendHalt()): the caller does not block on it
+        void RequestHalt();
+        // Sends all the halt requests at once (see RequestHalt()), then waits until no action tick is in flight anymore
+        // (in real time, see ActionNode::WaitForTickReturn()) and joins the threads of the nodes that have one.
+        // The tree cannot be ticked afterwards. Called by the destructor if needed
+        void Shutdown();
+        // True if no action is running nor has a tick in flight: the tree can be destroyed without waiting
+        bool IsQuiescent();
+
+        unsigned int get_nodes_number();
+        size_t get_allocated_bytes();
+
+        // One entry per node type, in order of first creation
+        std::vector<NodeTypeMemory> GetMemoryReport();
+        // Prints the report as a table, with the totals
+        void PrintMemoryReport(std::ostream& stream);
+
+    private:
+        struct OwnedNode
+        {
+            TreeNode* node;
+            void (*destroy)(TreeNode* node);
+            const std::type_info* type;
+            size_t size;
+        };
+
+        template <typename NodeType>
+        static void DestroyNode(TreeNode* node)
+        {
+            static_cast<NodeType*>(node)->~NodeType();
+        }
+
+        BehaviorTree(const BehaviorTree&);
+        BehaviorTree& operator=(const BehaviorTree&);
+
+        TreeArena arena_;
+        std::vector<OwnedNode> nodes_;
+        TreeNode* root_;
+        bool is_shut_down_;
+    };
+}
+
+#endif  // TREE_ARENA_H
@@ -28,15 +28,7 @@
 
 #endif
 
-// #define DEBUG //uncomment this line if you want to print debug messages
-
-#ifdef DEBUG
-  // #define DEBUG_STDERR(x) (std::cerr << (x))
-#define DEBUG_STDOUT(str) do { std::cout << str << std::endl; } while( false )
-
-#else
-#define DEBUG_STDOUT(str)
-#endif
+// #define DEBUG //uncomment this line if you want to trace the debug messages (see trace.h)
 
 
 #include <iostream>
@@ -49,10 +41,15 @@
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <cstdint>
 
 
 #include <tick_engine.h>
+#include <trace.h>
+#include <node_metrics.h>
 #include <exceptions.h>
+#include <clock.h>
 
 namespace BT
 {
@@ -89,45 +86,72 @@ enum NodeType {ACTION_NODE, CONDITION_NODE, CONTROL_NODE, YARP_ACTION_NODE};
     // If "BT::FAIL_ON_ONE" and "BT::SUCCEED_ON_ONE" are both active and are both trigerred in the
     // same time step, failure will take precedence.
 
-    // Abstract base class for Behavior Tree Nodes
-    class TreeNode
-    {
-    private:
-        // Node name
-        std::string name_;
-
-
+    // Layout of TreeNode::status_word_
+    const uint32_t STATUS_WORD_STATUS_MASK = 0x000000FF;
+    const uint32_t STATUS_WORD_COLOR_MASK = 0x0000FF00;
+    const uint32_t STATUS_WORD_COLOR_SHIFT = 8;
+    const uint32_t STATUS_WORD_HALT_REQUESTED = 0x00010000;
 
-    protected:
-        // The node state that must be treated in a thread-safe way
-        bool is_state_updated_;
-        bool is_halt_requested_;
+    // Cold state of a node: it lives in side tables allocated at the first use,
+    // so that the nodes that never need it pay only for a NULL pointer (see TreeNode).
 
-        ReturnStatus status_;
-        ReturnStatus color_status_;
+    // Used only to put to sleep the threads waiting in WaitForTickResponse() and WaitForHaltResponse()
+    struct NodeWaitState
+    {
+        std::mutex mutex;
+        std::condition_variable condition_variable;
+    };
 
+    // Position and offset for horizontal positioning when drawing
+    struct NodeDrawState
+    {
+        NodeDrawState() : x_shift(0), x_pose(0) {}
 
+        float x_shift, x_pose;
+    };
 
-        std::mutex is_halt_requested_mutex_;
-        std::mutex state_mutex_;
-        std::mutex color_state_mutex_;
-        std::condition_variable state_condition_variable_;
-        // Node type
-        NodeType type_;
-        //position and offset for horizontal positioning when drawing
-        float x_shift_, x_pose_;
+    // For the nodes that run a thread of their own
+    struct NodeThreadState
+    {
+        NodeThreadState() : tick_engine(0) {}
 
-    public:
         // The thread that will execute the node
-        std::thread thread_;
-
+        std::thread thread;
         // Node semaphore to simulate the tick
         // (and to synchronize fathers and children)
         TickEngine tick_engine;
+    };
+
+    // Abstract base class for Behavior Tree Nodes.
+    // Only the state read at every tick is stored in the node; the rest is in the side tables above.
+    class TreeNode
+    {
+    private:
+        // Node name
+        std::string name_;
 
+    protected:
+        // The node state that must be treated in a thread-safe way.
+        // Status, color status and halt request are packed in a single atomic word
+        // (see the STATUS_WORD_* masks above) and updated with CAS loops.
+        // Every update is a release operation and every read an acquire operation:
+        // whatever a thread wrote before changing the status is visible to the thread that reads it.
+        std::atomic<uint32_t> status_word_;
+
+        // Number of threads waiting in WaitForStatus()
+        std::atomic<int> waiters_number_;
+        // Node type
+        NodeType type_;
 
+        // NULL until the node records its first metric (see BT::Metrics)
+        std::atomic<Metrics::NodeMetrics*> metrics_;
 
+        // Side tables, NULL until the first use
+        std::atomic<NodeWaitState*> wait_state_;
+        NodeDrawState* draw_state_;
+        NodeThreadState* thread_state_;
 
+    public:
         // The constructor and the distructor
         TreeNode(std::string name);
         ~TreeNode();
@@ -155,19 +179,44 @@ enum NodeType {ACTION_NODE, CONDITION_NODE, CONTROL_NODE, YARP_ACTION_NODE};
 
 
         //Getters and setters
+        // The drawing position is 0 until it is set
         void set_x_pose(float x_pose);
         float get_x_pose();
 
         void set_x_shift(float x_shift);
         float get_x_shift();
 
+        // The thread and the tick semaphore of the nodes that run a thread of their own
+        // (allocated at the first call, not thread-safe: to be called at construction)
+        std::thread& get_thread();
+        TickEngine& get_tick_engine();
+        // Joins the thread of the node, if it has a joinable one
+        void JoinThread();
+
+        // Bytes allocated for the side tables and the metrics of the node (not included in sizeof)
+        size_t get_side_tables_size();
+
 
 
         ReturnStatus get_status();
         void set_status(ReturnStatus new_status);
 
+        // Atomically sets the status to new_status only if it is equal to expected_status
+        // (e.g. RUNNING->HALTED). Returns false if the status was different
+        bool compare_and_set_status(ReturnStatus expected_status, ReturnStatus new_status);
+
+        // Blocks until the node has received the tick, i.e. until its status is RUNNING,
+        // SUCCESS or FAILURE. The caller is woken up by set_status (no polling)
+        ReturnStatus WaitForTickResponse();
+
+        // Blocks until the node has completed its halt, i.e. until its status is HALTED or IDLE
+        ReturnStatus WaitForHaltResponse();
+        // As above, but returns the current status (e.g. RUNNING) once the deadline
+        // (on BT::GetDefaultClock()) has passed
+        ReturnStatus WaitForHaltResponse(std::chrono::steady_clock::time_point deadline);
 
-        std::string get_name();
+
+        const std::string& get_name();
         void set_name(std::string new_name);
 
         NodeType get_type();
@@ -176,6 +225,30 @@ enum NodeType {ACTION_NODE, CONDITION_NODE, CONTROL_NODE, YARP_ACTION_NODE};
         //void RequestHalt();
         bool is_halt_requested();
         void halt_requested(bool is_halt_requested);
+        // Sets the status to HALTED and clears the halt request in a single atomic step
+        void set_halted();
+
+        // The metrics recorded so far, NULL if none (see BT::Metrics)
+        Metrics::NodeMetrics* get_metrics();
+        // Called by whoever calls Tick(), with the metrics enabled
+        void RecordTickDuration(int64_t duration_ns);
+        // Called at the beginning of a halt, with the metrics enabled (the halt ends when the status becomes HALTED)
+        void RecordHaltStart();
+
+    private:
+        // Wakes up the threads waiting for a status change (if any)
+        void NotifyStatusChange();
+        // Allocates the metrics at the first use
+        Metrics::NodeMetrics* metrics();
+        // Allocates the wait state at the first use (may be called concurrently)
+        NodeWaitState* wait_state();
+        NodeDrawState* draw_state();
+        // Updates the running time, the halt latency and the success/failure counts
+        void RecordStatusChange(ReturnStatus old_status, ReturnStatus new_status);
+        // Blocks until the status is one of the statuses in the mask (bit i set means ReturnStatus i)
+        ReturnStatus WaitForStatus(uint32_t status_mask,
+                                   std::chrono::steady_clock::time_point deadline =
+                                   std::chrono::steady_clock::time_point::max());
     };
 }
 
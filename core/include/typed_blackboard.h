@@ -0,0 +1,507 @@
+#ifndef TYPED_BLACKBOARD_H
+#define TYPED_BLACKBOARD_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <exceptions.h>
+#include <rcu.h>
+#include <seqlock.h>
+#include <tick_trigger.h>
+
+namespace BT
+{
+    // Raw bytes of any size (e.g. a serialized message)
+    typedef std::vector<uint8_t> BlackBoardBlob;
+
+    // The types of the values: the ones of BlackBoardCmd.thrift, the blobs and the trivially copyable
+    // structures of at most FIXED_VALUE_MAX_SIZE bytes (e.g. a pose)
+    enum BlackBoardValueType {INT16_VALUE, INT32_VALUE, INT64_VALUE, BYTE_VALUE, DOUBLE_VALUE, BOOL_VALUE, STRING_VALUE,
+                              BLOB_VALUE, FIXED_VALUE};
+
+    const unsigned int FIXED_VALUE_MAX_SIZE = 64;
+
+    template <typename T>
+    struct BlackBoardTypeOf
+    {
+        static_assert(std::is_trivially_copyable<T>::value && sizeof(T) <= FIXED_VALUE_MAX_SIZE,
+                      "a blackboard value is a number, a string, a blob or a small trivially copyable structure");
+        static const BlackBoardValueType value = FIXED_VALUE;
+    };
+    template <> struct BlackBoardTypeOf<int16_t> { static const BlackBoardValueType value = INT16_VALUE; };
+    template <> struct BlackBoardTypeOf<int32_t> { static const BlackBoardValueType value = INT32_VALUE; };
+    template <> struct BlackBoardTypeOf<int64_t> { static const BlackBoardValueType value = INT64_VALUE; };
+    template <> struct BlackBoardTypeOf<int8_t> { static const BlackBoardValueType value = BYTE_VALUE; };
+    template <> struct BlackBoardTypeOf<double> { static const BlackBoardValueType value = DOUBLE_VALUE; };
+    template <> struct BlackBoardTypeOf<bool> { static const BlackBoardValueType value = BOOL_VALUE; };
+    template <> struct BlackBoardTypeOf<std::string> { static const BlackBoardValueType value = STRING_VALUE; };
+    template <> struct BlackBoardTypeOf<BlackBoardBlob> { static const BlackBoardValueType value = BLOB_VALUE; };
+
+    // One entry of the blackboard. Its address never changes once interned
+    struct BlackBoardSlot
+    {
+        static const unsigned int WORDS_NUMBER = FIXED_VALUE_MAX_SIZE / sizeof(uint64_t);
+
+        std::string name;
+        BlackBoardValueType type;
+        uint32_t index;
+        // sizeof of the value, for the numbers and the structures
+        uint32_t value_size;
+        // Even when no write is in progress, twice the number of sets so far.
+        // A writer makes it odd with a CAS (the writers of a key are serialized) and even again once done
+        std::atomic<uint64_t> sequence;
+        // Numbers and structures, as their bytes. A value of a single word is read with a single load,
+        // a larger one with the sequence (seqlock): the reader retries if a write has overlapped
+        std::atomic<uint64_t> words[WORDS_NUMBER];
+        // Strings and blobs (RCU): the writer publishes a new copy and retires the old one
+        std::atomic<void*> rcu_value;
+    };
+
+    // A value as raw bytes: the bytes of the number or of the structure, the characters of the string,
+    // the blob (e.g. to save and restore the blackboard, see BlackBoardJournal)
+    struct BlackBoardRecord
+    {
+        std::string name;
+        BlackBoardValueType type;
+        // sizeof of the structure (FIXED_VALUE only)
+        uint32_t value_size;
+        std::string bytes;
+        // The number of sets of the key with the value read by GetRecords() (of a string or a blob, a lower
+        // bound). Ignored by SetRecord()
+        uint64_t version;
+    };
+
+    class BlackBoardJournal;
+
+    // Handle of an interned key: a direct reference to the slot of the key, typed with its value
+    template <typename T>
+    class BlackBoardKey
+    {
+    public:
+        BlackBoardKey() : slot_(NULL) {}
+
+        bool is_valid() { return slot_ != NULL; }
+        uint32_t get_index() { return slot_->index; }
+        const std::string& get_name() { return slot_->name; }
+
+    private:
+        friend class TypedBlackBoard;
+        explicit BlackBoardKey(BlackBoardSlot* slot) : slot_(slot) {}
+
+        BlackBoardSlot* slot_;
+    };
+
+    // In-process blackboard with typed slots. Each key is interned once (one string hash, under a lock);
+    // Get() and Set() through the returned handle are then direct loads and stores, with no string work.
+    // Any number of threads can read and write at the same time. The readers take no lock: seqlock for the
+    // numbers and the structures, RCU for the strings and the blobs (see BT::Rcu). The writers of a key are
+    // serialized (spinning on the sequence of the key), the writers of different keys do not interact.
+    // The by-name methods are the slow path of the RPC side (see BlackBoardServer), with the loose typing
+    // of yarp::os::Property: a number can be read and written as any other number type.
+    class TypedBlackBoard
+    {
+    public:
+        TypedBlackBoard();
+        ~TypedBlackBoard();
+
+        // Returns the handle of the key, creating its slot if needed.
+        // Throws BehaviorTreeException if the key has already been interned with another type
+        // (a structure is only checked by size)
+        template <typename T>
+        BlackBoardKey<T> Intern(const std::string& name)
+        {
+            return BlackBoardKey<T>(InternSlot(name, BlackBoardTypeOf<T>::value, sizeof(T)));
+        }
+
+        // T() (all bits zero for a structure) if the value has never been set
+        template <typename T>
+        T Get(BlackBoardKey<T> key)
+        {
+            return Load<T>(key.slot_, IsRcu<T>());
+        }
+
+        template <typename T>
+        void Set(BlackBoardKey<T> key, const T& value)
+        {
+            uint64_t sequence = BeginWrite(key.slot_);
+            void* old_value = StoreLocked(key.slot_, value, IsRcu<T>());
+            EndWrite<T>(key.slot_, sequence, old_value);
+            Journal(key.slot_, sequence, value, IsRcu<T>());
+            NotifyChange();
+        }
+
+        // Sets desired only if the value is expected, atomically with respect to the other writers of the key.
+        // Returns whether it has been set
+        template <typename T>
+        bool CompareAndSet(BlackBoardKey<T> key, const T& expected, const T& desired)
+        {
+            uint64_t sequence = BeginWrite(key.slot_);
+            if (!(LoadLocked<T>(key.slot_, IsRcu<T>()) == expected))
+            {
+                // nothing has changed: the readers in progress need not retry
+                Seqlock::EndWrite(&key.slot_->sequence, sequence);
+                return false;
+            }
+            void* old_value = StoreLocked(key.slot_, desired, IsRcu<T>());
+            EndWrite<T>(key.slot_, sequence, old_value);
+            Journal(key.slot_, sequence, desired, IsRcu<T>());
+            NotifyChange();
+            return true;
+        }
+
+        // Adds delta to the number, atomically with respect to the other writers of the key. Returns the new value
+        template <typename T>
+        T Add(BlackBoardKey<T> key, const T& delta)
+        {
+            static_assert(std::is_arithmetic<T>::value, "only the numbers are added");
+            uint64_t sequence = BeginWrite(key.slot_);
+            T value = (T)(LoadLocked<T>(key.slot_, std::false_type()) + delta);
+            StoreLocked(key.slot_, value, std::false_type());
+            EndWrite<T>(key.slot_, sequence, NULL);
+            Journal(key.slot_, sequence, value, std::false_type());
+            NotifyChange();
+            return value;
+        }
+
+        // Calls reader(value) within a read-side section, without copying the value (strings and blobs only)
+        template <typename T, typename Reader>
+        void Read(BlackBoardKey<T> key, Reader reader)
+        {
+            static_assert(BlackBoardTypeOf<T>::value == STRING_VALUE || BlackBoardTypeOf<T>::value == BLOB_VALUE,
+                          "only the strings and the blobs are read in place");
+            Rcu::ReadGuard read_guard;
+            const T* value = static_cast<const T*>(key.slot_->rcu_value.load(std::memory_order_acquire));
+            reader(*value);
+        }
+
+        // Number of sets of the key so far (0 if never set)
+        template <typename T>
+        uint64_t get_version(BlackBoardKey<T> key)
+        {
+            return key.slot_->sequence.load(std::memory_order_acquire) / 2;
+        }
+
+        // CompareAndSet() and Add() by name, with the conversions of SetByName()
+        template <typename T>
+        bool CompareAndSetByName(const std::string& name, const T& expected, const T& desired)
+        {
+            BlackBoardSlot* slot = InternSlot(name, BlackBoardTypeOf<T>::value, sizeof(T), false);
+            if (slot->type == BlackBoardTypeOf<T>::value)
+            {
+                return CompareAndSet(BlackBoardKey<T>(slot), expected, desired);
+            }
+            return CompareAndSetNumber(slot, ToNumber(expected), ToNumber(desired));
+        }
+
+        template <typename T>
+        T AddByName(const std::string& name, const T& delta)
+        {
+            BlackBoardSlot* slot = InternSlot(name, BlackBoardTypeOf<T>::value, sizeof(T), false);
+            if (slot->type == BlackBoardTypeOf<T>::value)
+            {
+                return Add(BlackBoardKey<T>(slot), delta);
+            }
+            T value;
+            FromNumber(AddNumber(slot, ToNumber(delta)), &value);
+            return value;
+        }
+
+        // By name. Set() interns the key with the type T if it is new, otherwise converts the value to the
+        // type of the key. Get() converts the value of the key to T. Only the numbers are converted: both
+        // throw BehaviorTreeException if the types differ otherwise, Get() also if the key has never been set
+        template <typename T>
+        void SetByName(const std::string& name, const T& value)
+        {
+            BlackBoardSlot* slot = InternSlot(name, BlackBoardTypeOf<T>::value, sizeof(T), false);
+            if (slot->type == BlackBoardTypeOf<T>::value)
+            {
+                Set(BlackBoardKey<T>(slot), value);
+            }
+            else
+            {
+                SetNumber(slot, ToNumber(value));
+            }
+        }
+
+        template <typename T>
+        T GetByName(const std::string& name)
+        {
+            BlackBoardSlot* slot = FindSetSlot(name);
+            if (slot->type == BlackBoardTypeOf<T>::value)
+            {
+                return Get(BlackBoardKey<T>(slot));
+            }
+            T value;
+            FromNumber(GetNumber(slot), &value);
+            return value;
+        }
+
+        bool Contains(const std::string& name);
+        // The keys, in order of interning (i.e. by index)
+        std::vector<std::string> GetNames();
+        // Throws BehaviorTreeException if the key does not exist
+        BlackBoardValueType GetType(const std::string& name);
+        unsigned int get_keys_number();
+        // The versions of all the keys, by index (see BlackBoardKey::get_index())
+        void GetVersions(std::vector<uint64_t>* versions);
+
+        // Once enabled, each write triggers get_change_trigger() (e.g. to stream the changes, see
+        // BlackBoardStream). Disabled by default: the writers then do not touch any shared state
+        void set_change_notified(bool is_change_notified);
+        TickTrigger* get_change_trigger();
+
+        // Each write also triggers this tick trigger, so that a tree executed in reactive mode re-evaluates its
+        // conditions (see ExecuteReactive()). BT::GetDefaultTickTrigger() by default, NULL for none
+        void set_tick_trigger(TickTrigger* tick_trigger);
+
+        // The keys set so far, in order of interning. Each value is read atomically, not the whole blackboard
+        void GetRecords(std::vector<BlackBoardRecord>* records);
+        // Interns the key with the type of the record if it is new, then sets the value.
+        // Throws BehaviorTreeException if the key has another type or the bytes do not fit the type
+        void SetRecord(const BlackBoardRecord& record);
+
+        // Sets several values atomically, with the conversions of SetByName() (a new key is interned with the
+        // type of its record, the last record of a key is the one set). All the keys are locked (in the order
+        // of their indices, so two batches cannot deadlock), written, then unlocked: GetMany() sees the whole
+        // batch or none of it. Throws BehaviorTreeException, with nothing set, if a value does not fit its key
+        void SetMany(const std::vector<BlackBoardRecord>& records);
+        // Reads several values at a single point in time (retrying while a write overlaps), by name.
+        // A key never set has version 0 and no bytes (a key that does not exist, also the type FIXED_VALUE)
+        void GetMany(const std::vector<std::string>& names, std::vector<BlackBoardRecord>* records);
+
+        // Called by BlackBoardJournal, which then gets every write with the new value. NULL detaches the
+        // journal and waits for the writes that may still be appending to it
+        void set_journal(BlackBoardJournal* journal);
+        BlackBoardJournal* get_journal();
+
+    private:
+        TypedBlackBoard(const TypedBlackBoard&);
+        TypedBlackBoard& operator=(const TypedBlackBoard&);
+
+        BlackBoardSlot* InternSlot(const std::string& name, BlackBoardValueType type, uint32_t value_size,
+                                   bool is_type_checked = true);
+        BlackBoardSlot* FindSetSlot(const std::string& name);
+
+        // The strings and the blobs are behind an RCU pointer, the other values in the words of the slot
+        template <typename T>
+        struct IsRcu : std::integral_constant<bool, BlackBoardTypeOf<T>::value == STRING_VALUE
+                                                    || BlackBoardTypeOf<T>::value == BLOB_VALUE> {};
+
+        static uint64_t BeginWrite(BlackBoardSlot* slot)
+        {
+            return Seqlock::BeginWrite(&slot->sequence);
+        }
+
+        // Makes the sequence even again, then retires the old string or blob, if any
+        template <typename T>
+        static void EndWrite(BlackBoardSlot* slot, uint64_t sequence, void* old_value)
+        {
+            Seqlock::EndWrite(&slot->sequence, sequence + 2);
+            if (old_value != NULL)
+            {
+                Rcu::Retire(old_value, &Rcu::Delete<T>);
+            }
+        }
+
+        // Reader side: a single load for one word, the seqlock for more
+        template <typename T>
+        static T Load(BlackBoardSlot* slot, std::false_type)
+        {
+            T value;
+            if (sizeof(T) <= sizeof(uint64_t))
+            {
+                uint64_t word = slot->words[0].load(std::memory_order_acquire);
+                std::memcpy(&value, &word, sizeof(T));
+                return value;
+            }
+
+            uint64_t words[BlackBoardSlot::WORDS_NUMBER];
+            Seqlock::Read(&slot->sequence, slot->words, words, (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        static T Load(BlackBoardSlot* slot, std::true_type)
+        {
+            Rcu::ReadGuard read_guard;
+            return *static_cast<const T*>(slot->rcu_value.load(std::memory_order_acquire));
+        }
+
+        // Writer side, with the key locked by BeginWrite()
+        template <typename T>
+        static T LoadLocked(BlackBoardSlot* slot, std::false_type)
+        {
+            uint64_t words[BlackBoardSlot::WORDS_NUMBER];
+            const unsigned int words_number = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+            for (unsigned int i = 0; i < words_number; i++)
+            {
+                words[i] = slot->words[i].load(std::memory_order_relaxed);
+            }
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        static const T& LoadLocked(BlackBoardSlot* slot, std::true_type)
+        {
+            // no other writer can retire it
+            return *static_cast<const T*>(slot->rcu_value.load(std::memory_order_relaxed));
+        }
+
+        // Returns the old string or blob, NULL for the other values
+        template <typename T>
+        static void* StoreLocked(BlackBoardSlot* slot, const T& value, std::false_type)
+        {
+            uint64_t words[BlackBoardSlot::WORDS_NUMBER] = {0};
+            std::memcpy(words, &value, sizeof(T));
+            Seqlock::Write(slot->words, words, (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            return NULL;
+        }
+
+        template <typename T>
+        static void* StoreLocked(BlackBoardSlot* slot, const T& value, std::true_type)
+        {
+            // sequentially consistent, as the epochs of BT::Rcu: a reader that misses the retirement sees the new copy
+            return slot->rcu_value.exchange(new T(value));
+        }
+
+        // Conversions between the number types, through a double (an int64 is converted exactly)
+        struct Number
+        {
+            bool is_integer;
+            int64_t integer;
+            double real;
+        };
+        Number GetNumber(BlackBoardSlot* slot);
+        void SetNumber(BlackBoardSlot* slot, Number number);
+        // The bytes of a record of a number, and a number as the words of a slot (as StoreLocked())
+        static Number ToNumber(const BlackBoardRecord& record);
+        static void ToWords(BlackBoardSlot* slot, Number number, uint64_t* words);
+        bool CompareAndSetNumber(BlackBoardSlot* slot, Number expected, Number desired);
+        Number AddNumber(BlackBoardSlot* slot, Number delta);
+
+        // The same, once the type of the slot is known
+        template <typename T>
+        bool CompareAndSetAs(BlackBoardSlot* slot, Number expected, Number desired)
+        {
+            T expected_value;
+            T desired_value;
+            FromNumber(expected, &expected_value);
+            FromNumber(desired, &desired_value);
+            return CompareAndSet(BlackBoardKey<T>(slot), expected_value, desired_value);
+        }
+
+        template <typename T>
+        Number AddAs(BlackBoardSlot* slot, Number delta)
+        {
+            T delta_value;
+            FromNumber(delta, &delta_value);
+            return ToNumber(Add(BlackBoardKey<T>(slot), delta_value));
+        }
+
+        template <typename T>
+        static Number ToNumberAs(const std::string& bytes)
+        {
+            T value;
+            std::memcpy(&value, bytes.data(), sizeof(T));
+            return ToNumber(value);
+        }
+
+        template <typename T>
+        static void ToWordsAs(Number number, uint64_t* words)
+        {
+            T value;
+            FromNumber(number, &value);
+            std::memcpy(words, &value, sizeof(T));
+        }
+
+        // The size of the values of the type of the record. Throws BehaviorTreeException if it is invalid
+        static uint32_t GetValueSize(const BlackBoardRecord& record);
+
+        template <typename T>
+        static typename std::enable_if<std::is_arithmetic<T>::value, Number>::type ToNumber(const T& value)
+        {
+            Number number;
+            number.is_integer = BlackBoardTypeOf<T>::value != DOUBLE_VALUE;
+            number.integer = (int64_t)value;
+            number.real = (double)value;
+            return number;
+        }
+
+        // strings, blobs and structures
+        template <typename T>
+        static typename std::enable_if<!std::is_arithmetic<T>::value, Number>::type ToNumber(const T& value)
+        {
+            throw BehaviorTreeException("the value is not a number");
+        }
+
+        template <typename T>
+        static typename std::enable_if<std::is_arithmetic<T>::value>::type FromNumber(Number number, T* value)
+        {
+            *value = number.is_integer ? (T)number.integer : (T)number.real;
+        }
+
+        template <typename T>
+        static typename std::enable_if<!std::is_arithmetic<T>::value>::type FromNumber(Number number, T* value)
+        {
+            throw BehaviorTreeException("a number can be read only as a number");
+        }
+
+        // Appends the new value to the journal, if any, with the version of the write: called once the key is
+        // unlocked, so that its readers do not wait for the log. The records of the concurrent writers of a key
+        // may then be appended out of order, the versions order them
+        template <typename T>
+        void Journal(BlackBoardSlot* slot, uint64_t sequence, const T& value, std::false_type)
+        {
+            if (journal_.load(std::memory_order_relaxed) != NULL)
+            {
+                JournalBytes(slot, sequence / 2 + 1, &value, sizeof(T));
+            }
+        }
+
+        template <typename T>
+        void Journal(BlackBoardSlot* slot, uint64_t sequence, const T& value, std::true_type)
+        {
+            if (journal_.load(std::memory_order_relaxed) != NULL)
+            {
+                JournalBytes(slot, sequence / 2 + 1, value.data(), value.size());
+            }
+        }
+
+        void JournalBytes(BlackBoardSlot* slot, uint64_t version, const void* bytes, std::size_t size);
+
+        void NotifyChange()
+        {
+            if (is_change_notified_.load(std::memory_order_relaxed))
+            {
+                change_trigger_.Trigger();
+            }
+            TickTrigger* tick_trigger = tick_trigger_.load(std::memory_order_relaxed);
+            if (tick_trigger != NULL)
+            {
+                tick_trigger->Trigger();
+            }
+        }
+
+        std::atomic<bool> is_change_notified_;
+        TickTrigger change_trigger_;
+        std::atomic<TickTrigger*> tick_trigger_;
+        // Loaded within an RCU read-side section, so that set_journal(NULL) can wait for the writers
+        std::atomic<BlackBoardJournal*> journal_;
+
+        // Protects the name table and the slot list. The slots are never freed before the blackboard
+        std::mutex intern_mutex_;
+        std::unordered_map<std::string, BlackBoardSlot*> slots_by_name_;
+        std::vector<BlackBoardSlot*> slots_;
+    };
+}
+
+#endif  // TYPED_BLACKBOARD_H
@@ -12,44 +12,220 @@
 
 #include <action_node.h>
 #include <string>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+    std::atomic<std::chrono::steady_clock::rep> tick_deadline_(
+            std::chrono::steady_clock::time_point::max().time_since_epoch().count());
+
+    // Wakes up WaitForTickReturn(). Not a member: the node may be destroyed as soon as its last task has
+    // returned. The tasks lock the mutex only while someone is waiting
+    std::mutex tick_return_mutex_;
+    std::condition_variable tick_return_condition_;
+    std::atomic<int> tick_return_waiters_number_(0);
+}
+
+void BT::SetTickDeadline(std::chrono::steady_clock::time_point deadline)
+{
+    tick_deadline_.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+std::chrono::steady_clock::time_point BT::GetTickDeadline()
+{
+    return std::chrono::steady_clock::time_point(
+                std::chrono::steady_clock::duration(tick_deadline_.load(std::memory_order_relaxed)));
+}
+
+std::chrono::steady_clock::duration BT::TickDescriptor::get_remaining_budget() const
+{
+    if (deadline == std::chrono::steady_clock::time_point::max())
+    {
+        return std::chrono::steady_clock::duration::max();
+    }
+    return deadline - clock->Now();
+}
+
+std::chrono::steady_clock::duration BT::TickDescriptor::get_queue_latency() const
+{
+    return start_time - issue_time;
+}
 
 
 BT::ActionNode::ActionNode(std::string name) : LeafNode::LeafNode(name)
 {
     type_ = BT::ACTION_NODE;
-    thread_ = std::thread(&ActionNode::WaitForTick, this);
+    sent_tick_.tick_id = 0;
+    sent_tick_.clock = BT::GetDefaultClock();
+    tick_ = sent_tick_;
+    ticks_in_flight_number_ = 0;
+    is_tick_running_ = false;
+    is_halt_sent_ = false;
+    executor_ = BT::GetDefaultExecutor();
 }
 
-BT::ActionNode::~ActionNode() {}
+BT::ActionNode::ActionNode(std::string name, Executor* executor) : LeafNode::LeafNode(name)
+{
+    type_ = BT::ACTION_NODE;
+    sent_tick_.tick_id = 0;
+    sent_tick_.clock = BT::GetDefaultClock();
+    tick_ = sent_tick_;
+    ticks_in_flight_number_ = 0;
+    is_tick_running_ = false;
+    is_halt_sent_ = false;
+    executor_ = executor;
+}
+
+BT::ActionNode::~ActionNode()
+{
+    // the task of the last tick may still be finishing after having set the status
+    WaitForTickReturn();
+}
 
 
-void BT::ActionNode::WaitForTick()
+void BT::ActionNode::SendTick()
 {
+    SendTick(BT::GetTickDeadline());
+}
 
-    while (true)
-    {
-        // Waiting for the tick to come
-        DEBUG_STDOUT(get_name() << " WAIT FOR TICK");
+void BT::ActionNode::SendTick(std::chrono::steady_clock::time_point deadline)
+{
+    DEBUG_STDOUT(get_name() << " TICK SENT");
 
-        tick_engine.Wait();
-        DEBUG_STDOUT(get_name() << " TICK RECEIVED");
+    // a tick is sent only to an action that is not running: the previous one has been consumed
+    sent_tick_.tick_id++;
+    sent_tick_.clock = BT::GetDefaultClock();
+    sent_tick_.issue_time = sent_tick_.clock->Now();
+    sent_tick_.deadline = deadline;
+    // the clock waits for the tick from now on, while it is queued too
+    sent_tick_.clock->BeginActivity();
+    is_halt_sent_.store(false, std::memory_order_relaxed);
+    is_tick_running_.store(true);
 
-        // Running state
-        set_status(BT::RUNNING);
-        BT::ReturnStatus status = Tick();
-        if (is_halt_requested())
-        {
-            DEBUG_STDOUT(get_name() << " HALT REQUESTED");
+    // Running state (this also notifies the parent waiting for the tick response).
+    // It is set here and not by the worker, the parent does not have to wait for a free worker
+    set_status(BT::RUNNING);
 
-            Halt();
-            set_status(BT::HALTED);
-            halt_requested(false);
-        }
-        else
+    // a counter, the task of the previous tick may not have returned yet
+    ticks_in_flight_number_.fetch_add(1, std::memory_order_relaxed);
+    executor_->Submit(std::bind(&ActionNode::RunTick, this));
+}
+
+
+void BT::ActionNode::RunTick()
+{
+    DEBUG_STDOUT(get_name() << " TICK RECEIVED");
+
+    tick_ = sent_tick_;
+    // the parent may send the next tick as soon as the status is set
+    Clock* tick_clock = tick_.clock;
+    tick_.start_time = tick_clock->Now();
+
+    if (is_halt_requested())
+    {
+        // halted while the tick was still queued, the action has never started
+        DEBUG_STDOUT(get_name() << " HALT REQUESTED BEFORE STARTING");
+
+        is_halt_sent_.store(true);
+        set_halted();
+        is_tick_running_.store(false);
+        tick_clock->EndActivity();
+        ReturnTick();
+        return;
+    }
+
+    BT::ReturnStatus status;
+    if (BT::Metrics::IsEnabled())
+    {
+        int64_t start_ns = BT::Metrics::NowNanoseconds();
+        status = Tick();
+        RecordTickDuration(BT::Metrics::NowNanoseconds() - start_ns);
+    }
+    else
+    {
+        status = Tick();
+    }
+    if (!is_halt_requested())
+    {
+        set_status(status);
+        if (status == BT::SUCCESS || status == BT::FAILURE)
         {
-            set_status(status);
+            // a tree executed in reactive mode has to read the result
+            BT::GetDefaultTickTrigger()->Trigger();
         }
     }
+    // a halt requested from now on is sent by SendHalt(), one requested before by this task
+    is_tick_running_.store(false);
+    if (is_halt_requested() && !is_halt_sent_.exchange(true))
+    {
+        DEBUG_STDOUT(get_name() << " HALT REQUESTED");
+
+        Halt();
+        set_halted();
+    }
+    tick_clock->EndActivity();
+    ReturnTick();
+}
+
+void BT::ActionNode::SendHalt()
+{
+    halt_requested(true);
+    if (is_tick_running_.load() || is_halt_sent_.exchange(true))
+    {
+        // sent by the task of the tick
+        return;
+    }
+    Clock* clock = BT::GetDefaultClock();
+    // the clock waits for the halt, as for a tick
+    clock->BeginActivity();
+    ticks_in_flight_number_.fetch_add(1, std::memory_order_relaxed);
+    executor_->Submit(std::bind(&ActionNode::RunHalt, this, clock));
+}
+
+void BT::ActionNode::RunHalt(Clock* clock)
+{
+    Halt();
+    set_halted();
+    clock->EndActivity();
+    ReturnTick();
+}
+
+void BT::ActionNode::ReturnTick()
+{
+    // the last access to the node: it may be destroyed from now on
+    ticks_in_flight_number_.fetch_sub(1);
+    if (tick_return_waiters_number_.load() > 0)
+    {
+        // the waiter either has not checked the counter yet or is already waiting
+        { std::lock_guard<std::mutex> LockGuard(tick_return_mutex_); }
+        tick_return_condition_.notify_all();
+    }
+}
+
+const BT::TickDescriptor& BT::ActionNode::get_tick()
+{
+    return tick_;
+}
+
+bool BT::ActionNode::is_tick_in_flight()
+{
+    return ticks_in_flight_number_.load(std::memory_order_acquire) > 0;
+}
+
+void BT::ActionNode::WaitForTickReturn()
+{
+    if (!is_tick_in_flight())
+    {
+        return;
+    }
+    tick_return_waiters_number_++;
+    {
+        std::unique_lock<std::mutex> UniqueLock(tick_return_mutex_);
+        tick_return_condition_.wait(UniqueLock, [this]() { return !is_tick_in_flight(); });
+    }
+    tick_return_waiters_number_--;
 }
 
 int BT::ActionNode::DrawType()
@@ -15,7 +15,7 @@
 
 
 
-void Execute(BT::ControlNode* root, int TickPeriod_milliseconds)
+void Execute(BT::ControlNode* root, int TickPeriod_milliseconds, BT::OverrunPolicy overrun_policy)
 {
     std::cout << "Start Drawing!" << std::endl;
     // Starts in another thread the drawing of the BT
@@ -23,12 +23,24 @@ void Execute(BT::ControlNode* root, int TickPeriod_milliseconds)
 
     root->ResetColorState();
 
+    // this thread is the activity that ticks the root (time stands still while it ticks, in virtual time)
+    BT::GetDefaultClock()->BeginActivity();
+    BT::TickScheduler scheduler(std::chrono::milliseconds(TickPeriod_milliseconds), overrun_policy);
+
     while (true)
     {
+        // sleeps until the deadline of this tick
+        scheduler.WaitForNextTick();
+        // the actions ticked now have to complete before the next tick
+        BT::SetTickDeadline(scheduler.get_next_deadline());
+
         DEBUG_STDOUT("Ticking the root node !");
 
         // Ticking the root node
-        root->Tick();
+        {
+            BT::TickEpochScope epoch;
+            root->Tick();
+        }
         // Printing its state
 
         if (root->get_status() != BT::RUNNING)
@@ -36,6 +48,26 @@ void Execute(BT::ControlNode* root, int TickPeriod_milliseconds)
             // when the root returns a status it resets the colors of the tree
 //            root->ResetColorState();
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(TickPeriod_milliseconds));
+    }
+}
+
+void ExecuteReactive(BT::ControlNode* root, int MaxTickPeriod_milliseconds)
+{
+    root->ResetColorState();
+
+    BT::TickTrigger* tick_trigger = BT::GetDefaultTickTrigger();
+    BT::GetDefaultClock()->BeginActivity();
+
+    while (true)
+    {
+        DEBUG_STDOUT("Ticking the root node !");
+
+        {
+            BT::TickEpochScope epoch;
+            root->Tick();
+        }
+
+        // the triggers received during the tick are not lost: the next wait returns immediately
+        tick_trigger->WaitForTrigger(std::chrono::milliseconds(MaxTickPeriod_milliseconds));
     }
 }
@@ -0,0 +1,802 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <blackboard_journal.h>
+#include <clock.h>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace
+{
+    const char LOG_MAGIC[8] = {'B', 'T', 'B', 'B', 'L', 'O', 'G', '1'};
+    const char SNAPSHOT_MAGIC[8] = {'B', 'T', 'B', 'B', 'S', 'N', 'A', 'P'};
+
+    // Log: a LogHeader, then the records, each as a RecordFrame followed by its payload:
+    // - KEY_RECORD: kind (uint8_t), key index, type and value_size (uint32_t), name;
+    // - VALUE_RECORD: kind (uint8_t), key index (uint32_t), time in nanoseconds (int64_t), version (uint64_t),
+    //   bytes.
+    // A key is written before its first value in each log
+    struct LogHeader
+    {
+        char magic[8];
+        uint32_t layout_version;
+        uint32_t generation;
+        uint32_t session;
+    };
+
+    struct RecordFrame
+    {
+        uint32_t payload_size;
+        uint32_t checksum;
+    };
+
+    enum RecordKind {KEY_RECORD, VALUE_RECORD};
+    const std::size_t RECORD_PREFIX_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+
+    // Snapshot: a SnapshotHeader, a SnapshotEntry per value, then the names and the bytes of the values
+    // (each entry's name followed by its bytes, aligned to 8 bytes so that the numbers can be read in place)
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32_t layout_version;
+        uint32_t generation;
+        uint32_t session;
+        uint32_t entries_number;
+        // of everything after the header
+        uint32_t checksum;
+        uint32_t reserved;
+        uint64_t file_size;
+    };
+
+    struct SnapshotEntry
+    {
+        uint32_t type;
+        uint32_t value_size;
+        uint32_t name_size;
+        uint32_t bytes_size;
+        uint64_t offset;
+        uint64_t version;
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 40 && sizeof(SnapshotEntry) == 32, "the snapshot layout must not depend on padding");
+
+    // FNV-1a
+    uint32_t Checksum(const char* data, std::size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void AppendValue(std::string* buffer, const T& value)
+    {
+        buffer->append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T ReadValue(const char* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    bool IsFile(const std::string& path)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == NULL)
+        {
+            return false;
+        }
+        fclose(file);
+        return true;
+    }
+
+    // The values being restored, each from the latest write read so far (by session, then by version)
+    class RestoredValues
+    {
+    public:
+        // Returns false if the value of the key is already from a later write
+        bool Add(uint32_t session, const BT::BlackBoardRecord& record)
+        {
+            std::pair<uint32_t, uint64_t> order(session, record.version);
+            std::map<std::string, std::size_t>::iterator index = indices_.find(record.name);
+            if (index == indices_.end())
+            {
+                indices_[record.name] = values_.size();
+                values_.push_back(Value());
+            }
+            else if (order <= values_[index->second].order)
+            {
+                return false;
+            }
+            Value& value = values_[indices_[record.name]];
+            value.order = order;
+            value.record = record;
+            return true;
+        }
+
+        void Clear()
+        {
+            indices_.clear();
+            values_.clear();
+        }
+
+        // In the order of the first value of each key
+        void Set(BT::TypedBlackBoard* blackboard)
+        {
+            for (unsigned int i = 0; i < values_.size(); i++)
+            {
+                blackboard->SetRecord(values_[i].record);
+            }
+        }
+
+    private:
+        struct Value
+        {
+            std::pair<uint32_t, uint64_t> order;
+            BT::BlackBoardRecord record;
+        };
+
+        std::map<std::string, std::size_t> indices_;
+        std::vector<Value> values_;
+    };
+
+    // Adds the values of the snapshot. Returns false with the error if the snapshot is corrupted, throws
+    // BehaviorTreeException if it is of another layout version
+    bool LoadSnapshot(const std::string& path, RestoredValues* values, SnapshotHeader* header, std::string* error)
+    {
+        using namespace boost::interprocess;
+
+        file_mapping mapping;
+        mapped_region region;
+        try
+        {
+            file_mapping file(path.c_str(), read_only);
+            mapping.swap(file);
+            mapped_region file_region(mapping, read_only);
+            region.swap(file_region);
+        }
+        catch (const interprocess_exception& ex)
+        {
+            // e.g. empty
+            *error = std::string("it cannot be mapped: ") + ex.what();
+            return false;
+        }
+
+        const char* data = static_cast<const char*>(region.get_address());
+        std::size_t size = region.get_size();
+        if (size < sizeof(SnapshotHeader))
+        {
+            *error = "it is truncated";
+            return false;
+        }
+        *header = ReadValue<SnapshotHeader>(data);
+        if (std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+        {
+            *error = "it is not a snapshot";
+            return false;
+        }
+        if (header->layout_version != BT::BLACKBOARD_JOURNAL_LAYOUT_VERSION)
+        {
+            // not a corruption: the previous snapshot is of the same version
+            throw BT::BehaviorTreeException("Cannot load the snapshot " + path + ": its layout version is "
+                                            + std::to_string(header->layout_version) + ", not "
+                                            + std::to_string(BT::BLACKBOARD_JOURNAL_LAYOUT_VERSION));
+        }
+        if (header->file_size != size
+                || size < sizeof(SnapshotHeader) + (uint64_t)header->entries_number * sizeof(SnapshotEntry)
+                || Checksum(data + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) != header->checksum)
+        {
+            *error = "it is corrupted";
+            return false;
+        }
+
+        const char* entries = data + sizeof(SnapshotHeader);
+        for (uint32_t i = 0; i < header->entries_number; i++)
+        {
+            SnapshotEntry entry = ReadValue<SnapshotEntry>(entries + i * sizeof(SnapshotEntry));
+            if (entry.offset > size || (uint64_t)entry.name_size + entry.bytes_size > size - entry.offset)
+            {
+                *error = "it is corrupted";
+                return false;
+            }
+            BT::BlackBoardRecord record;
+            record.name.assign(data + entry.offset, entry.name_size);
+            record.type = (BT::BlackBoardValueType)entry.type;
+            record.value_size = entry.value_size;
+            record.bytes.assign(data + entry.offset + entry.name_size, entry.bytes_size);
+            record.version = entry.version;
+            values->Add(header->session, record);
+        }
+        return true;
+    }
+
+    bool SyncDirectory(const std::string& directory)
+    {
+        int descriptor = open(directory.c_str(), O_RDONLY);
+        if (descriptor < 0)
+        {
+            return false;
+        }
+        bool is_synced = fsync(descriptor) == 0;
+        return close(descriptor) == 0 && is_synced;
+    }
+
+    // Writes and syncs the file next to the snapshot, then renames the snapshot to the previous one and the file
+    // to the snapshot, and syncs the directory: a crash leaves the snapshot or the previous one, never a partial one
+    void WriteSnapshot(const std::string& directory, unsigned int generation, uint32_t session,
+                       const std::vector<BT::BlackBoardRecord>& records)
+    {
+        std::string data;
+        uint64_t offset = sizeof(SnapshotHeader) + records.size() * sizeof(SnapshotEntry);
+        for (unsigned int i = 0; i < records.size(); i++)
+        {
+            SnapshotEntry entry;
+            entry.type = records[i].type;
+            entry.value_size = records[i].value_size;
+            entry.name_size = records[i].name.size();
+            entry.bytes_size = records[i].bytes.size();
+            entry.offset = offset;
+            entry.version = records[i].version;
+            AppendValue(&data, entry);
+            offset += (entry.name_size + entry.bytes_size + 7) & ~(uint64_t)7;
+        }
+        for (unsigned int i = 0; i < records.size(); i++)
+        {
+            data += records[i].name;
+            data += records[i].bytes;
+            data.resize((data.size() + 7) & ~(std::size_t)7, '\0');
+        }
+
+        SnapshotHeader header;
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.layout_version = BT::BLACKBOARD_JOURNAL_LAYOUT_VERSION;
+        header.generation = generation;
+        header.session = session;
+        header.entries_number = records.size();
+        header.checksum = Checksum(data.data(), data.size());
+        header.reserved = 0;
+        header.file_size = sizeof(SnapshotHeader) + data.size();
+
+        std::string path = BT::BlackBoardJournal::GetSnapshotPath(directory);
+        std::string temporary_path = path + ".tmp";
+        FILE* file = fopen(temporary_path.c_str(), "wb");
+        if (file == NULL)
+        {
+            throw BT::BehaviorTreeException("Cannot write the snapshot " + temporary_path);
+        }
+        bool is_written = fwrite(&header, sizeof(header), 1, file) == 1
+                && fwrite(data.data(), 1, data.size(), file) == data.size()
+                && fflush(file) == 0 && fsync(fileno(file)) == 0;
+        is_written = fclose(file) == 0 && is_written;
+        if (!is_written)
+        {
+            std::remove(temporary_path.c_str());
+            throw BT::BehaviorTreeException("Cannot write the snapshot " + path);
+        }
+        if ((IsFile(path) && std::rename(path.c_str(), BT::BlackBoardJournal::GetPreviousSnapshotPath(directory).c_str()) != 0)
+                || std::rename(temporary_path.c_str(), path.c_str()) != 0 || !SyncDirectory(directory))
+        {
+            std::remove(temporary_path.c_str());
+            throw BT::BehaviorTreeException("Cannot replace the snapshot " + path);
+        }
+    }
+}
+
+BT::BlackBoardJournal::BlackBoardJournal(TypedBlackBoard* blackboard, const std::string& directory, bool are_logs_kept)
+{
+    blackboard_ = blackboard;
+    directory_ = directory;
+    are_logs_kept_ = are_logs_kept;
+    session_ = 0;
+    log_file_ = NULL;
+    next_generation_ = 0;
+    first_generation_ = 0;
+    records_number_ = 0;
+    is_failed_ = false;
+    has_snapshot_ = false;
+    snapshot_generation_ = 0;
+    snapshot_records_number_ = 0;
+    replayed_records_number_ = 0;
+    is_previous_snapshot_restored_ = false;
+    is_running_ = false;
+
+    if (blackboard_->get_journal() != NULL)
+    {
+        throw BehaviorTreeException("the blackboard already has a journal");
+    }
+    Restore();
+
+    // the writes before the first log are dropped, but the snapshot reads them
+    blackboard_->set_journal(this);
+    try
+    {
+        Snapshot();
+    }
+    catch (const BehaviorTreeException&)
+    {
+        blackboard_->set_journal(NULL);
+        CloseLog();
+        throw;
+    }
+}
+
+BT::BlackBoardJournal::~BlackBoardJournal()
+{
+    Stop();
+    blackboard_->set_journal(NULL);
+    std::lock_guard<std::mutex> LockGuard(log_mutex_);
+    CloseLog();
+}
+
+void BT::BlackBoardJournal::Restore()
+{
+    std::string snapshot_path = GetSnapshotPath(directory_);
+    std::string previous_snapshot_path = GetPreviousSnapshotPath(directory_);
+    RestoredValues values;
+    SnapshotHeader header;
+    std::string error;
+    if (IsFile(snapshot_path))
+    {
+        has_snapshot_ = LoadSnapshot(snapshot_path, &values, &header, &error);
+        if (!has_snapshot_)
+        {
+            values.Clear();
+        }
+    }
+    // the latest snapshot is corrupted, or a crash happened between the renames of WriteSnapshot()
+    if (!has_snapshot_ && IsFile(previous_snapshot_path))
+    {
+        std::string previous_error;
+        if (!LoadSnapshot(previous_snapshot_path, &values, &header, &previous_error))
+        {
+            throw BehaviorTreeException("Cannot load the snapshot " + previous_snapshot_path + ": " + previous_error
+                                        + (error.empty() ? "" : " (nor " + snapshot_path + ": " + error + ")"));
+        }
+        has_snapshot_ = true;
+        is_previous_snapshot_restored_ = true;
+        // it is the latest one again, with its logs
+        if (std::rename(previous_snapshot_path.c_str(), snapshot_path.c_str()) != 0)
+        {
+            throw BehaviorTreeException("Cannot replace the snapshot " + snapshot_path);
+        }
+    }
+    else if (!has_snapshot_ && !error.empty())
+    {
+        // the first snapshot: all the logs are kept
+        std::remove(snapshot_path.c_str());
+    }
+
+    unsigned int generation = 0;
+    uint32_t last_session = 0;
+    if (has_snapshot_)
+    {
+        generation = header.generation;
+        last_session = header.session;
+        snapshot_generation_ = header.generation;
+        snapshot_records_number_ = header.entries_number;
+    }
+    // the logs kept with the previous snapshot, deleted by the next one
+    first_generation_ = generation;
+    while (first_generation_ > 0 && IsFile(GetLogPath(directory_, first_generation_ - 1)))
+    {
+        first_generation_--;
+    }
+
+    // the logs written after the snapshot, up to the first missing one
+    while (IsFile(GetLogPath(directory_, generation)))
+    {
+        BlackBoardLogReader reader(GetLogPath(directory_, generation));
+        BlackBoardLogRecord log_record;
+        while (reader.Next(&log_record))
+        {
+            if (values.Add(reader.get_session(), log_record.record))
+            {
+                replayed_records_number_++;
+            }
+        }
+        last_session = std::max(last_session, reader.get_session());
+        generation++;
+    }
+    next_generation_ = generation;
+    session_ = last_session + 1;
+    values.Set(blackboard_);
+}
+
+void BT::BlackBoardJournal::Snapshot()
+{
+    std::lock_guard<std::mutex> LockGuard(snapshot_mutex_);
+
+    unsigned int generation;
+    {
+        std::lock_guard<std::mutex> LockGuard(log_mutex_);
+        OpenNextLog();
+        generation = next_generation_ - 1;
+    }
+
+    // the values are read after the log has started: a write missing from the snapshot is in the log (a write
+    // appended to the previous log is read)
+    std::vector<BlackBoardRecord> records;
+    blackboard_->GetRecords(&records);
+    WriteSnapshot(directory_, generation, session_, records);
+
+    if (!are_logs_kept_ && has_snapshot_)
+    {
+        // the replaced snapshot is the previous one: its logs are kept
+        for (unsigned int i = first_generation_; i < snapshot_generation_; i++)
+        {
+            std::remove(GetLogPath(directory_, i).c_str());
+        }
+        first_generation_ = snapshot_generation_;
+    }
+    has_snapshot_ = true;
+    snapshot_generation_ = generation;
+}
+
+void BT::BlackBoardJournal::Flush()
+{
+    std::lock_guard<std::mutex> LockGuard(log_mutex_);
+    if (log_file_ != NULL && fflush(log_file_) != 0)
+    {
+        is_failed_ = true;
+    }
+}
+
+bool BT::BlackBoardJournal::Start(std::chrono::milliseconds flush_period, std::chrono::milliseconds snapshot_period)
+{
+    std::lock_guard<std::mutex> LockGuard(thread_mutex_);
+    if (is_running_)
+    {
+        return false;
+    }
+    is_running_ = true;
+    thread_ = std::thread(&BlackBoardJournal::Run, this, flush_period, snapshot_period);
+    return true;
+}
+
+void BT::BlackBoardJournal::Stop()
+{
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> LockGuard(thread_mutex_);
+        if (!is_running_)
+        {
+            return;
+        }
+        is_running_ = false;
+        thread.swap(thread_);
+    }
+    thread_condition_.notify_all();
+    thread.join();
+}
+
+void BT::BlackBoardJournal::Run(std::chrono::milliseconds flush_period, std::chrono::milliseconds snapshot_period)
+{
+    std::chrono::steady_clock::time_point next_flush_time = std::chrono::steady_clock::now() + flush_period;
+    std::chrono::steady_clock::time_point next_snapshot_time = std::chrono::steady_clock::now() + snapshot_period;
+
+    std::unique_lock<std::mutex> lock(thread_mutex_);
+    while (is_running_)
+    {
+        std::chrono::steady_clock::time_point wake_up_time = std::chrono::steady_clock::time_point::max();
+        if (flush_period.count() > 0)
+        {
+            wake_up_time = next_flush_time;
+        }
+        if (snapshot_period.count() > 0 && next_snapshot_time < wake_up_time)
+        {
+            wake_up_time = next_snapshot_time;
+        }
+        if (wake_up_time == std::chrono::steady_clock::time_point::max())
+        {
+            thread_condition_.wait(lock);
+            continue;
+        }
+        thread_condition_.wait_until(lock, wake_up_time);
+        if (!is_running_)
+        {
+            break;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        lock.unlock();
+        if (snapshot_period.count() > 0 && now >= next_snapshot_time)
+        {
+            try
+            {
+                // flushes the log too, by closing it
+                Snapshot();
+            }
+            catch (const BehaviorTreeException&)
+            {
+                std::lock_guard<std::mutex> LockGuard(log_mutex_);
+                is_failed_ = true;
+            }
+            next_snapshot_time = now + snapshot_period;
+            next_flush_time = now + flush_period;
+        }
+        else if (flush_period.count() > 0 && now >= next_flush_time)
+        {
+            Flush();
+            next_flush_time = now + flush_period;
+        }
+        lock.lock();
+    }
+}
+
+unsigned int BT::BlackBoardJournal::get_generation()
+{
+    std::lock_guard<std::mutex> LockGuard(log_mutex_);
+    return next_generation_ - 1;
+}
+
+uint64_t BT::BlackBoardJournal::get_records_number()
+{
+    std::lock_guard<std::mutex> LockGuard(log_mutex_);
+    return records_number_;
+}
+
+unsigned int BT::BlackBoardJournal::get_snapshot_records_number()
+{
+    return snapshot_records_number_;
+}
+
+uint64_t BT::BlackBoardJournal::get_replayed_records_number()
+{
+    return replayed_records_number_;
+}
+
+bool BT::BlackBoardJournal::is_previous_snapshot_restored()
+{
+    return is_previous_snapshot_restored_;
+}
+
+std::string BT::BlackBoardJournal::GetSnapshotPath(const std::string& directory)
+{
+    return directory + "/snapshot.bbs";
+}
+
+std::string BT::BlackBoardJournal::GetPreviousSnapshotPath(const std::string& directory)
+{
+    return directory + "/snapshot.bbs.previous";
+}
+
+std::string BT::BlackBoardJournal::GetLogPath(const std::string& directory, unsigned int generation)
+{
+    return directory + "/log_" + std::to_string(generation) + ".bbl";
+}
+
+void BT::BlackBoardJournal::Append(const BlackBoardSlot* slot, uint64_t version, const void* bytes, std::size_t size)
+{
+    int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                GetDefaultClock()->Now().time_since_epoch()).count();
+
+    std::lock_guard<std::mutex> LockGuard(log_mutex_);
+    if (log_file_ == NULL)
+    {
+        return;
+    }
+
+    if (slot->index >= is_key_logged_.size())
+    {
+        is_key_logged_.resize(slot->index + 1, 0);
+    }
+    record_buffer_.clear();
+    if (!is_key_logged_[slot->index])
+    {
+        std::size_t frame_position = record_buffer_.size();
+        AppendValue(&record_buffer_, RecordFrame());
+        AppendValue(&record_buffer_, (uint8_t)KEY_RECORD);
+        AppendValue(&record_buffer_, (uint32_t)slot->index);
+        AppendValue(&record_buffer_, (uint32_t)slot->type);
+        AppendValue(&record_buffer_, (uint32_t)slot->value_size);
+        record_buffer_ += slot->name;
+        RecordFrame frame;
+        frame.payload_size = record_buffer_.size() - frame_position - sizeof(RecordFrame);
+        frame.checksum = Checksum(&record_buffer_[frame_position + sizeof(RecordFrame)], frame.payload_size);
+        std::memcpy(&record_buffer_[frame_position], &frame, sizeof(frame));
+        is_key_logged_[slot->index] = 1;
+    }
+
+    std::size_t frame_position = record_buffer_.size();
+    AppendValue(&record_buffer_, RecordFrame());
+    AppendValue(&record_buffer_, (uint8_t)VALUE_RECORD);
+    AppendValue(&record_buffer_, (uint32_t)slot->index);
+    AppendValue(&record_buffer_, time);
+    AppendValue(&record_buffer_, version);
+    record_buffer_.append(static_cast<const char*>(bytes), size);
+    RecordFrame frame;
+    frame.payload_size = record_buffer_.size() - frame_position - sizeof(RecordFrame);
+    frame.checksum = Checksum(&record_buffer_[frame_position + sizeof(RecordFrame)], frame.payload_size);
+    std::memcpy(&record_buffer_[frame_position], &frame, sizeof(frame));
+
+    if (fwrite(record_buffer_.data(), 1, record_buffer_.size(), log_file_) != record_buffer_.size())
+    {
+        is_failed_ = true;
+        return;
+    }
+    records_number_++;
+}
+
+bool BT::BlackBoardJournal::is_failed()
+{
+    std::lock_guard<std::mutex> LockGuard(log_mutex_);
+    return is_failed_;
+}
+
+void BT::BlackBoardJournal::OpenNextLog()
+{
+    std::string path = GetLogPath(directory_, next_generation_);
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == NULL)
+    {
+        throw BehaviorTreeException("Cannot create the log " + path);
+    }
+    LogHeader header;
+    std::memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+    header.layout_version = BLACKBOARD_JOURNAL_LAYOUT_VERSION;
+    header.generation = next_generation_;
+    header.session = session_;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0)
+    {
+        fclose(file);
+        throw BehaviorTreeException("Cannot write the log " + path);
+    }
+
+    CloseLog();
+    log_file_ = file;
+    next_generation_++;
+    records_number_ = 0;
+    is_key_logged_.clear();
+}
+
+void BT::BlackBoardJournal::CloseLog()
+{
+    if (log_file_ != NULL)
+    {
+        if (fclose(log_file_) != 0)
+        {
+            is_failed_ = true;
+        }
+        log_file_ = NULL;
+    }
+}
+
+
+BT::BlackBoardLogReader::BlackBoardLogReader(const std::string& path)
+{
+    file_ = fopen(path.c_str(), "rb");
+    if (file_ == NULL)
+    {
+        throw BehaviorTreeException("Cannot open the log " + path);
+    }
+
+    LogHeader header;
+    if (fread(&header, sizeof(header), 1, file_) != 1)
+    {
+        // cut by a crash right after its creation: no records
+        generation_ = 0;
+        session_ = 0;
+        return;
+    }
+    std::string error;
+    if (std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0)
+    {
+        error = "it is not a log";
+    }
+    else if (header.layout_version != BLACKBOARD_JOURNAL_LAYOUT_VERSION)
+    {
+        error = "its layout version is " + std::to_string(header.layout_version)
+                + ", not " + std::to_string(BLACKBOARD_JOURNAL_LAYOUT_VERSION);
+    }
+    if (!error.empty())
+    {
+        fclose(file_);
+        throw BehaviorTreeException("Cannot read the log " + path + ": " + error);
+    }
+    generation_ = header.generation;
+    session_ = header.session;
+}
+
+BT::BlackBoardLogReader::~BlackBoardLogReader()
+{
+    fclose(file_);
+}
+
+bool BT::BlackBoardLogReader::Next(BlackBoardLogRecord* log_record)
+{
+    while (true)
+    {
+        RecordFrame frame;
+        if (fread(&frame, sizeof(frame), 1, file_) != 1 || frame.payload_size < RECORD_PREFIX_SIZE)
+        {
+            return false;
+        }
+        payload_.resize(frame.payload_size);
+        if (fread(&payload_[0], 1, frame.payload_size, file_) != frame.payload_size
+                || Checksum(payload_.data(), payload_.size()) != frame.checksum)
+        {
+            return false;
+        }
+
+        const char* data = payload_.data();
+        uint8_t kind = ReadValue<uint8_t>(data);
+        uint32_t key_index = ReadValue<uint32_t>(data + sizeof(uint8_t));
+        const char* fields = data + RECORD_PREFIX_SIZE;
+        std::size_t fields_size = payload_.size() - RECORD_PREFIX_SIZE;
+        if (kind == KEY_RECORD && fields_size >= 2 * sizeof(uint32_t))
+        {
+            BlackBoardRecord& key = keys_[key_index];
+            key.type = (BlackBoardValueType)ReadValue<uint32_t>(fields);
+            key.value_size = ReadValue<uint32_t>(fields + sizeof(uint32_t));
+            key.name.assign(fields + 2 * sizeof(uint32_t), fields_size - 2 * sizeof(uint32_t));
+            continue;
+        }
+
+        std::map<uint32_t, BlackBoardRecord>::iterator key = keys_.find(key_index);
+        if (kind != VALUE_RECORD || fields_size < sizeof(int64_t) + sizeof(uint64_t) || key == keys_.end())
+        {
+            // not written by BlackBoardJournal
+            return false;
+        }
+        log_record->time = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                                     std::chrono::nanoseconds(ReadValue<int64_t>(fields))));
+        log_record->record.name = key->second.name;
+        log_record->record.type = key->second.type;
+        log_record->record.value_size = key->second.value_size;
+        log_record->record.version = ReadValue<uint64_t>(fields + sizeof(int64_t));
+        log_record->record.bytes.assign(fields + sizeof(int64_t) + sizeof(uint64_t),
+                                        fields_size - sizeof(int64_t) - sizeof(uint64_t));
+        return true;
+    }
+}
+
+unsigned int BT::BlackBoardLogReader::get_generation()
+{
+    return generation_;
+}
+
+uint32_t BT::BlackBoardLogReader::get_session()
+{
+    return session_;
+}
+
+uint64_t BT::ReplayLog(const std::string& path, TypedBlackBoard* blackboard)
+{
+    BlackBoardLogReader reader(path);
+    BlackBoardLogRecord log_record;
+    std::map<std::string, uint64_t> versions;
+    uint64_t records_number = 0;
+    while (reader.Next(&log_record))
+    {
+        std::map<std::string, uint64_t>::iterator version = versions.find(log_record.record.name);
+        if (version != versions.end() && log_record.record.version <= version->second)
+        {
+            continue;
+        }
+        versions[log_record.record.name] = log_record.record.version;
+        blackboard->SetRecord(log_record.record);
+        records_number++;
+    }
+    return records_number;
+}
@@ -1,4 +1,6 @@
 #include "blackboard_server.h"
+#include <tick_trigger.h>
+#include <yarp/os/Network.h>
 
 
 //TODO add try-catch clause
@@ -6,6 +8,32 @@ BlackBoardServer::BlackBoardServer(yarp::os::Property* blackboard_ptr ) : BlackB
 {
     // content_ = new BlackBoard();
     blackboard_ptr_ = blackboard_ptr;
+    typed_blackboard_ = NULL;
+    stream_ = NULL;
+    is_streaming_ = false;
+    journal_ = NULL;
+    shared_blackboard_ = NULL;
+    shared_blackboard_mirror_ = NULL;
+}
+
+BlackBoardServer::BlackBoardServer(BT::TypedBlackBoard* typed_blackboard) : BlackBoardCmd(),yarp::os::RFModule()
+{
+    blackboard_ptr_ = NULL;
+    typed_blackboard_ = typed_blackboard;
+    stream_ = new BT::BlackBoardStream(typed_blackboard);
+    is_streaming_ = false;
+    journal_ = NULL;
+    shared_blackboard_ = NULL;
+    shared_blackboard_mirror_ = NULL;
+}
+
+BlackBoardServer::~BlackBoardServer()
+{
+    StopStreaming();
+    delete shared_blackboard_mirror_;
+    delete shared_blackboard_;
+    delete journal_;
+    delete stream_;
 }
 
 
@@ -20,6 +48,47 @@ bool BlackBoardServer::configure( yarp::os::ResourceFinder &rf )
             "module name (string)").asString().c_str();
     setName(moduleName.c_str());
     std::string slash="/";
+    if (typed_blackboard_ != NULL && rf.check("journal"))
+    {
+        // restored before the clients can write
+        std::string journal_directory = rf.find("journal").asString();
+        try
+        {
+            journal_ = new BT::BlackBoardJournal(typed_blackboard_, journal_directory);
+        }
+        catch (const BT::BehaviorTreeException& ex)
+        {
+            std::cout << getName() << ": Unable to restore the blackboard from " << journal_directory
+                      << ": " << ex.what() << std::endl;
+            return false;
+        }
+        if (journal_->is_previous_snapshot_restored())
+        {
+            std::cout << getName() << ": The latest snapshot in " << journal_directory
+                      << " is corrupted, restored the previous one" << std::endl;
+        }
+        journal_->Start(std::chrono::milliseconds(rf.check("journal_flush_period", yarp::os::Value(100),
+                                                           "milliseconds between the flushes of the log (int)").asInt()),
+                        std::chrono::milliseconds(rf.check("journal_snapshot_period", yarp::os::Value(10000),
+                                                           "milliseconds between the snapshots (int)").asInt()));
+    }
+    if (typed_blackboard_ != NULL && rf.check("shared_blackboard"))
+    {
+        // mirrored by the streaming thread
+        std::string segment_name = rf.find("shared_blackboard").asString();
+        try
+        {
+            shared_blackboard_ = new BT::SharedBlackBoard(segment_name,
+                                                          rf.check("shared_blackboard_keys", yarp::os::Value(256),
+                                                                   "keys of the shared blackboard (int)").asInt());
+        }
+        catch (const BT::BehaviorTreeException& ex)
+        {
+            std::cout << getName() << ": " << ex.what() << std::endl;
+            return false;
+        }
+        shared_blackboard_mirror_ = new BT::SharedBlackBoardMirror(stream_, shared_blackboard_);
+    }
     attach(cmd_port_);
     std::string cmd_port_name= "/";
     cmd_port_name+= getName();
@@ -28,6 +97,11 @@ bool BlackBoardServer::configure( yarp::os::ResourceFinder &rf )
         std::cout << getName() << ": Unable to open port " << cmd_port_name << std::endl;
         return false;
     }
+    if (stream_ != NULL)
+    {
+        is_streaming_ = true;
+        stream_thread_ = std::thread(&BlackBoardServer::StreamChanges, this);
+    }
     return true;
 }
 bool BlackBoardServer::updateModule()
@@ -37,18 +111,32 @@ bool BlackBoardServer::updateModule()
 bool BlackBoardServer::close()
 {
     cmd_port_.close();
+    StopStreaming();
+    delete shared_blackboard_mirror_;
+    shared_blackboard_mirror_ = NULL;
+    delete shared_blackboard_;
+    shared_blackboard_ = NULL;
+    delete journal_;
+    journal_ = NULL;
     return true;
 }
 
 
 void BlackBoardServer::SetI16(const std::string &name, const int16_t data)
 {
+    if (typed_blackboard_ != NULL)
+    {
+        SetTyped<int16_t>(name, data);
+        return;
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
     try
     {
         yarp::os::Value value = data;
 
         // content_->SetValue(name, "i16", value);
         blackboard_ptr_->put(name,value);
+        BT::GetDefaultTickTrigger()->Trigger();
     }
     catch( const std::invalid_argument & ex )
     {
@@ -58,12 +146,19 @@ void BlackBoardServer::SetI16(const std::string &name, const int16_t data)
 
 void BlackBoardServer::SetI32(const std::string &name, const int32_t data)
 {
+    if (typed_blackboard_ != NULL)
+    {
+        SetTyped<int32_t>(name, data);
+        return;
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
     try
     {
         yarp::os::Value value = data;
 
         // content_->SetValue(name, "i32", value);
         blackboard_ptr_->put(name,value);
+        BT::GetDefaultTickTrigger()->Trigger();
     }
     catch( const std::exception & ex )
     {
@@ -72,10 +167,18 @@ void BlackBoardServer::SetI32(const std::string &name, const int32_t data)
 }
 
 void BlackBoardServer::SetI64(const std::string &name, const YARP_INT64 data)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        SetTyped<int64_t>(name, (int64_t)data);
+        return;
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         // content_->SetValue(name, "i64", (int)data); //loosing data here but a yarp value does not have .makeInt64()
         blackboard_ptr_->put(name,(int)data);
+        BT::GetDefaultTickTrigger()->Trigger();
 
      }
      catch( const std::invalid_argument & ex )
@@ -85,10 +188,18 @@ void BlackBoardServer::SetI64(const std::string &name, const YARP_INT64 data)
 }
 
 void BlackBoardServer::SetByte(const std::string &name, const int8_t data)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        SetTyped<int8_t>(name, data);
+        return;
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         // content_->SetValue(name,"byte",data);
         blackboard_ptr_->put(name,data);
+        BT::GetDefaultTickTrigger()->Trigger();
      }
      catch( const std::invalid_argument & ex )
     {
@@ -98,12 +209,20 @@ void BlackBoardServer::SetByte(const std::string &name, const int8_t data)
 }
 
 void BlackBoardServer::SetDouble(const std::string &name, const double data)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        SetTyped<double>(name, data);
+        return;
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         yarp::os::Value value;
         value.makeDouble(data);
         // content_->SetValue(name,"double",data);
         blackboard_ptr_->put(name,data);
+        BT::GetDefaultTickTrigger()->Trigger();
 
      }
      catch( const std::invalid_argument & ex )
@@ -114,10 +233,18 @@ void BlackBoardServer::SetDouble(const std::string &name, const double data)
 }
 
 void BlackBoardServer::SetBool(const std::string &name, const double data)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        SetTyped<bool>(name, data != 0);
+        return;
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         // content_->SetValue(name, "bool", data);
                 blackboard_ptr_->put(name,data);
+                BT::GetDefaultTickTrigger()->Trigger();
      }
      catch( const std::invalid_argument & ex )
     {
@@ -127,12 +254,20 @@ void BlackBoardServer::SetBool(const std::string &name, const double data)
 }
 
 void BlackBoardServer::SetString(const std::string &name, const std::string &data)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        SetTyped<std::string>(name, data);
+        return;
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         yarp::os::Value value;
         value.makeString(data);
         // content_->SetValue(name,"string", *value.makeString(data));
                 blackboard_ptr_->put(name,data);
+                BT::GetDefaultTickTrigger()->Trigger();
 
      }
      catch( const std::invalid_argument & ex )
@@ -142,7 +277,13 @@ void BlackBoardServer::SetString(const std::string &name, const std::string &dat
 }
 
 int16_t BlackBoardServer::GetI16(const std::string &name)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        return GetTyped<int16_t>(name, -1);
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         // return content_->GetI16(name);
         return blackboard_ptr_->find(name).asInt();
@@ -155,7 +296,13 @@ int16_t BlackBoardServer::GetI16(const std::string &name)
 }
 
 int32_t BlackBoardServer::GetI32(const std::string &name)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        return GetTyped<int32_t>(name, 0);
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         return blackboard_ptr_->find(name).asInt();
      }
@@ -167,7 +314,13 @@ int32_t BlackBoardServer::GetI32(const std::string &name)
 }
 
 YARP_INT64 BlackBoardServer::GetI64(const std::string &name)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        return GetTyped<int64_t>(name, -1);
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         return blackboard_ptr_->find(name).asInt();
      }
@@ -179,7 +332,13 @@ YARP_INT64 BlackBoardServer::GetI64(const std::string &name)
 }
 
 int8_t BlackBoardServer::GetByte(const std::string &name)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        return GetTyped<int8_t>(name, -1);
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         return blackboard_ptr_->find(name).asInt();
      }
@@ -191,7 +350,13 @@ int8_t BlackBoardServer::GetByte(const std::string &name)
 }
 
 double BlackBoardServer::GetDouble(const std::string &name)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        return GetTyped<double>(name, -1.0);
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         return blackboard_ptr_->find(name).asDouble();
      }
@@ -204,7 +369,13 @@ double BlackBoardServer::GetDouble(const std::string &name)
 }
 
 bool BlackBoardServer::GetBool(const std::string &name)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        return GetTyped<bool>(name, false);
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         return blackboard_ptr_->find(name).asBool();
      }
@@ -217,7 +388,13 @@ bool BlackBoardServer::GetBool(const std::string &name)
 
 
 std::string BlackBoardServer::GetString(const std::string &name)
-{    try
+{
+    if (typed_blackboard_ != NULL)
+    {
+        return GetTyped<std::string>(name, "");
+    }
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    try
      {
         return blackboard_ptr_->find(name).asString();
      }
@@ -229,3 +406,587 @@ std::string BlackBoardServer::GetString(const std::string &name)
 
 }
 
+
+namespace
+{
+    bool IsNumber(const BlackBoardValue& value)
+    {
+        return value.type != STRING_TYPE && value.type != NO_TYPE;
+    }
+
+    double AsReal(const BlackBoardValue& value)
+    {
+        return value.type == DOUBLE_TYPE ? value.real : (double)value.integer;
+    }
+
+    // Numbers are compared as numbers, whatever their type
+    bool IsEqual(const BlackBoardValue& value, const BlackBoardValue& other_value)
+    {
+        if (IsNumber(value) && IsNumber(other_value))
+        {
+            if (value.type == DOUBLE_TYPE || other_value.type == DOUBLE_TYPE)
+            {
+                return AsReal(value) == AsReal(other_value);
+            }
+            return value.integer == other_value.integer;
+        }
+        if (value.type != other_value.type)
+        {
+            return false;
+        }
+        return value.type == NO_TYPE || value.text == other_value.text;
+    }
+
+    BlackBoardValue MakeValue(BlackBoardType type, YARP_INT64 integer, double real, const std::string& text)
+    {
+        BlackBoardValue value;
+        value.type = type;
+        value.integer = integer;
+        value.real = real;
+        value.text = text;
+        return value;
+    }
+
+    BlackBoardType ToCmdType(BT::BlackBoardValueType type)
+    {
+        switch (type)
+        {
+        case BT::INT16_VALUE:
+            return I16_TYPE;
+        case BT::INT32_VALUE:
+            return I32_TYPE;
+        case BT::INT64_VALUE:
+            return I64_TYPE;
+        case BT::BYTE_VALUE:
+            return BYTE_TYPE;
+        case BT::DOUBLE_VALUE:
+            return DOUBLE_TYPE;
+        case BT::BOOL_VALUE:
+            return BOOL_TYPE;
+        case BT::STRING_VALUE:
+            return STRING_TYPE;
+        default:
+            // blobs and structures are not served
+            return NO_TYPE;
+        }
+    }
+
+    template <typename T>
+    BT::BlackBoardRecord MakeRecord(const std::string& name, const T& value)
+    {
+        BT::BlackBoardRecord record;
+        record.name = name;
+        record.type = BT::BlackBoardTypeOf<T>::value;
+        record.value_size = sizeof(T);
+        record.bytes.assign(reinterpret_cast<const char*>(&value), sizeof(T));
+        record.version = 0;
+        return record;
+    }
+
+    // A value as a record of the typed blackboard (the value is settable, see IsSettable())
+    BT::BlackBoardRecord ToRecord(const std::string& name, const BlackBoardValue& value)
+    {
+        switch (value.type)
+        {
+        case I16_TYPE:
+            return MakeRecord<int16_t>(name, (int16_t)value.integer);
+        case I32_TYPE:
+            return MakeRecord<int32_t>(name, (int32_t)value.integer);
+        case I64_TYPE:
+            return MakeRecord<int64_t>(name, (int64_t)value.integer);
+        case BYTE_TYPE:
+            return MakeRecord<int8_t>(name, (int8_t)value.integer);
+        case DOUBLE_TYPE:
+            return MakeRecord<double>(name, value.real);
+        case BOOL_TYPE:
+            return MakeRecord<bool>(name, value.integer != 0);
+        default:
+        {
+            BT::BlackBoardRecord record;
+            record.name = name;
+            record.type = BT::STRING_VALUE;
+            record.value_size = 0;
+            record.bytes = value.text;
+            record.version = 0;
+            return record;
+        }
+        }
+    }
+
+    template <typename T>
+    T FromRecord(const BT::BlackBoardRecord& record)
+    {
+        T value;
+        std::memcpy(&value, record.bytes.data(), sizeof(T));
+        return value;
+    }
+
+    // A record read by TypedBlackBoard::GetMany(): NO_TYPE if never set
+    BlackBoardValue ToValue(const BT::BlackBoardRecord& record)
+    {
+        BlackBoardType type = ToCmdType(record.type);
+        if (record.version == 0)
+        {
+            return BlackBoardValue();
+        }
+        switch (type)
+        {
+        case I16_TYPE:
+            return MakeValue(type, FromRecord<int16_t>(record), 0.0, "");
+        case I32_TYPE:
+            return MakeValue(type, FromRecord<int32_t>(record), 0.0, "");
+        case I64_TYPE:
+            return MakeValue(type, FromRecord<int64_t>(record), 0.0, "");
+        case BYTE_TYPE:
+            return MakeValue(type, FromRecord<int8_t>(record), 0.0, "");
+        case DOUBLE_TYPE:
+            return MakeValue(type, 0, FromRecord<double>(record), "");
+        case BOOL_TYPE:
+            return MakeValue(type, FromRecord<bool>(record), 0.0, "");
+        case STRING_TYPE:
+            return MakeValue(type, 0, 0.0, record.bytes);
+        default:
+            return BlackBoardValue();
+        }
+    }
+}
+
+BlackBoardValue BlackBoardServer::GetValue(const std::string& name)
+{
+    if (typed_blackboard_ != NULL)
+    {
+        try
+        {
+            BlackBoardType type = ToCmdType(typed_blackboard_->GetType(name));
+            switch (type)
+            {
+            case DOUBLE_TYPE:
+                return MakeValue(type, 0, typed_blackboard_->GetByName<double>(name), "");
+            case STRING_TYPE:
+                return MakeValue(type, 0, 0.0, typed_blackboard_->GetByName<std::string>(name));
+            case NO_TYPE:
+                return BlackBoardValue();
+            default:
+                return MakeValue(type, typed_blackboard_->GetByName<int64_t>(name), 0.0, "");
+            }
+        }
+        catch( const std::exception & ex )
+        {
+            // never set
+            return BlackBoardValue();
+        }
+    }
+
+    if (!blackboard_ptr_->check(name))
+    {
+        return BlackBoardValue();
+    }
+    yarp::os::Value& value = blackboard_ptr_->find(name);
+    if (value.isString())
+    {
+        return MakeValue(STRING_TYPE, 0, 0.0, value.asString());
+    }
+    if (value.isDouble())
+    {
+        return MakeValue(DOUBLE_TYPE, 0, value.asDouble(), "");
+    }
+    if (value.isBool())
+    {
+        return MakeValue(BOOL_TYPE, value.asBool(), 0.0, "");
+    }
+    if (value.isInt())
+    {
+        return MakeValue(I32_TYPE, value.asInt(), 0.0, "");
+    }
+    return BlackBoardValue();
+}
+
+bool BlackBoardServer::IsSettable(const std::string& name, const BlackBoardValue& value)
+{
+    if (value.type == NO_TYPE)
+    {
+        return false;
+    }
+    if (typed_blackboard_ == NULL || !typed_blackboard_->Contains(name))
+    {
+        return true;
+    }
+    BlackBoardType type = ToCmdType(typed_blackboard_->GetType(name));
+    return type != NO_TYPE && (type == STRING_TYPE) == (value.type == STRING_TYPE);
+}
+
+bool BlackBoardServer::SetValue(const std::string& name, const BlackBoardValue& value)
+{
+    if (!IsSettable(name, value))
+    {
+        return false;
+    }
+
+    if (typed_blackboard_ != NULL)
+    {
+        // an in-process writer may have created the key with another type since the check
+        try
+        {
+            switch (value.type)
+            {
+            case I16_TYPE:
+                typed_blackboard_->SetByName<int16_t>(name, (int16_t)value.integer);
+                break;
+            case I32_TYPE:
+                typed_blackboard_->SetByName<int32_t>(name, (int32_t)value.integer);
+                break;
+            case I64_TYPE:
+                typed_blackboard_->SetByName<int64_t>(name, (int64_t)value.integer);
+                break;
+            case BYTE_TYPE:
+                typed_blackboard_->SetByName<int8_t>(name, (int8_t)value.integer);
+                break;
+            case DOUBLE_TYPE:
+                typed_blackboard_->SetByName<double>(name, value.real);
+                break;
+            case BOOL_TYPE:
+                typed_blackboard_->SetByName<bool>(name, value.integer != 0);
+                break;
+            default:
+                typed_blackboard_->SetByName<std::string>(name, value.text);
+                break;
+            }
+        }
+        catch( const std::exception & ex )
+        {
+            std::cout << ex.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    switch (value.type)
+    {
+    case DOUBLE_TYPE:
+        blackboard_ptr_->put(name, value.real);
+        break;
+    case STRING_TYPE:
+        blackboard_ptr_->put(name, value.text);
+        break;
+    default:
+        // a yarp::os::Value has no int64 (as in SetI64())
+        blackboard_ptr_->put(name, (int)value.integer);
+        break;
+    }
+    return true;
+}
+
+std::vector<BlackBoardValue> BlackBoardServer::GetMany(const std::vector<std::string>& names)
+{
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    std::vector<BlackBoardValue> values;
+    values.reserve(names.size());
+    if (typed_blackboard_ != NULL)
+    {
+        // a snapshot, consistent with the batches of SetMany()
+        std::vector<BT::BlackBoardRecord> records;
+        typed_blackboard_->GetMany(names, &records);
+        for (unsigned int i = 0; i < records.size(); i++)
+        {
+            values.push_back(ToValue(records[i]));
+        }
+        return values;
+    }
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+        values.push_back(GetValue(names[i]));
+    }
+    return values;
+}
+
+bool BlackBoardServer::SetMany(const std::vector<std::string>& names, const std::vector<BlackBoardValue>& values)
+{
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    if (names.size() != values.size())
+    {
+        std::cout << "SetMany: " << names.size() << " names for " << values.size() << " values" << std::endl;
+        return false;
+    }
+    // all or nothing: checked before the first set. A key new to a typed blackboard takes the type of its
+    // first value in the batch, which the next values of the key must then fit
+    std::map<std::string, bool> is_string_key;
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+        bool is_string = values[i].type == STRING_TYPE;
+        bool is_settable;
+        std::map<std::string, bool>::iterator key = is_string_key.find(names[i]);
+        if (key == is_string_key.end())
+        {
+            is_settable = IsSettable(names[i], values[i]);
+        }
+        else
+        {
+            // a yarp::os::Property takes any type
+            is_settable = values[i].type != NO_TYPE && (typed_blackboard_ == NULL || key->second == is_string);
+        }
+        if (!is_settable)
+        {
+            std::cout << "Cannot set variable " << names[i] << std::endl;
+            return false;
+        }
+        is_string_key[names[i]] = is_string;
+    }
+    if (typed_blackboard_ != NULL)
+    {
+        // atomic for the readers as well: GetMany() sees the whole batch or none of it
+        std::vector<BT::BlackBoardRecord> records;
+        records.reserve(names.size());
+        for (unsigned int i = 0; i < names.size(); i++)
+        {
+            records.push_back(ToRecord(names[i], values[i]));
+        }
+        try
+        {
+            typed_blackboard_->SetMany(records);
+        }
+        catch( const std::exception & ex )
+        {
+            // only if an in-process writer has created one of the keys with another type in the meantime
+            std::cout << "SetMany: " << ex.what() << std::endl;
+            return false;
+        }
+        BT::GetDefaultTickTrigger()->Trigger();
+        return true;
+    }
+    bool is_set = true;
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+        if (!SetValue(names[i], values[i]))
+        {
+            // only if an in-process writer has created the key with another type in the meantime
+            std::cout << "SetMany: variable " << names[i] << " not set" << std::endl;
+            is_set = false;
+        }
+    }
+    // a single tick for the whole batch
+    BT::GetDefaultTickTrigger()->Trigger();
+    return is_set;
+}
+
+bool BlackBoardServer::CompareAndSet(const std::string& name, const BlackBoardValue& expected,
+                                     const BlackBoardValue& desired)
+{
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    BlackBoardValue value = GetValue(name);
+    if (!IsEqual(value, expected) || !IsSettable(name, desired))
+    {
+        return false;
+    }
+
+    bool is_set = true;
+    if (typed_blackboard_ != NULL && expected.type != NO_TYPE)
+    {
+        // atomic with respect to the in-process writers as well
+        try
+        {
+            if (expected.type == STRING_TYPE)
+            {
+                is_set = typed_blackboard_->CompareAndSetByName<std::string>(name, expected.text, desired.text);
+            }
+            else if (expected.type == DOUBLE_TYPE || desired.type == DOUBLE_TYPE)
+            {
+                is_set = typed_blackboard_->CompareAndSetByName<double>(name, AsReal(expected), AsReal(desired));
+            }
+            else
+            {
+                is_set = typed_blackboard_->CompareAndSetByName<int64_t>(name, (int64_t)expected.integer,
+                                                                         (int64_t)desired.integer);
+            }
+        }
+        catch( const std::exception & ex )
+        {
+            std::cout << ex.what() << std::endl;
+            return false;
+        }
+    }
+    else
+    {
+        SetValue(name, desired);
+    }
+
+    if (is_set)
+    {
+        BT::GetDefaultTickTrigger()->Trigger();
+    }
+    return is_set;
+}
+
+BlackBoardValue BlackBoardServer::Increment(const std::string& name, const BlackBoardValue& delta)
+{
+    std::lock_guard<std::mutex> LockGuard(blackboard_mutex_);
+    if (!IsNumber(delta) || !IsSettable(name, delta))
+    {
+        std::cout << "Cannot increment variable " << name << std::endl;
+        return BlackBoardValue();
+    }
+
+    BlackBoardValue value;
+    if (typed_blackboard_ != NULL)
+    {
+        // atomic with respect to the in-process writers as well
+        try
+        {
+            // the type of a key never changes once set
+            if (delta.type == DOUBLE_TYPE
+                    || (typed_blackboard_->Contains(name) && typed_blackboard_->GetType(name) == BT::DOUBLE_VALUE))
+            {
+                double result = typed_blackboard_->AddByName<double>(name, delta.real);
+                value = MakeValue(DOUBLE_TYPE, (YARP_INT64)result, result, "");
+            }
+            else
+            {
+                int64_t result = typed_blackboard_->AddByName<int64_t>(name, (int64_t)delta.integer);
+                value = MakeValue(I64_TYPE, result, (double)result, "");
+            }
+            value.type = ToCmdType(typed_blackboard_->GetType(name));
+        }
+        catch( const std::exception & ex )
+        {
+            std::cout << ex.what() << std::endl;
+            return BlackBoardValue();
+        }
+    }
+    else
+    {
+        value = GetValue(name);
+        if (value.type == STRING_TYPE)
+        {
+            std::cout << "Cannot increment variable " << name << std::endl;
+            return BlackBoardValue();
+        }
+        if (value.type == NO_TYPE)
+        {
+            // 0 + delta
+            value = delta;
+        }
+        else if (value.type == DOUBLE_TYPE || delta.type == DOUBLE_TYPE)
+        {
+            value = MakeValue(DOUBLE_TYPE, 0, AsReal(value) + AsReal(delta), "");
+        }
+        else
+        {
+            value.integer += delta.integer;
+        }
+        SetValue(name, value);
+    }
+
+    BT::GetDefaultTickTrigger()->Trigger();
+    return value;
+}
+
+int32_t BlackBoardServer::Subscribe(const std::string& client_port, const std::vector<std::string>& patterns,
+                                    const double max_rate)
+{
+    if (stream_ == NULL)
+    {
+        std::cout << "Cannot stream the changes of a yarp::os::Property" << std::endl;
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> LockGuard(stream_mutex_);
+    unsigned int subscription_id = stream_->Subscribe(patterns, max_rate);
+    std::string port_name = "/" + getName() + "/stream/" + std::to_string(subscription_id);
+    yarp::os::BufferedPort<yarp::os::Bottle>* port = new yarp::os::BufferedPort<yarp::os::Bottle>();
+    if (!port->open(port_name) || !yarp::os::Network::connect(port_name, client_port))
+    {
+        std::cout << getName() << ": Unable to stream to port " << client_port << std::endl;
+        stream_->Unsubscribe(subscription_id);
+        port->close();
+        delete port;
+        return -1;
+    }
+    stream_ports_[subscription_id] = port;
+    return subscription_id;
+}
+
+bool BlackBoardServer::Unsubscribe(const int32_t subscription_id)
+{
+    if (stream_ == NULL || subscription_id < 0)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> LockGuard(stream_mutex_);
+    std::map<unsigned int, yarp::os::BufferedPort<yarp::os::Bottle>*>::iterator it = stream_ports_.find(subscription_id);
+    if (it == stream_ports_.end())
+    {
+        return false;
+    }
+    stream_->Unsubscribe(subscription_id);
+    it->second->close();
+    delete it->second;
+    stream_ports_.erase(it);
+    return true;
+}
+
+void BlackBoardServer::StreamChanges()
+{
+    while (is_streaming_)
+    {
+        // the timeout only bounds the reaction to close()
+        stream_->WaitForChanges(std::chrono::milliseconds(100));
+
+        if (shared_blackboard_mirror_ != NULL)
+        {
+            shared_blackboard_mirror_->Update();
+        }
+
+        std::lock_guard<std::mutex> LockGuard(stream_mutex_);
+        for (std::map<unsigned int, yarp::os::BufferedPort<yarp::os::Bottle>*>::iterator it = stream_ports_.begin();
+             it != stream_ports_.end(); ++it)
+        {
+            std::vector<BT::BlackBoardDelta> deltas = stream_->CollectDeltas(it->first);
+            if (deltas.empty())
+            {
+                continue;
+            }
+            yarp::os::Bottle& bottle = it->second->prepare();
+            bottle.clear();
+            for (unsigned int i = 0; i < deltas.size(); i++)
+            {
+                yarp::os::Bottle& delta_bottle = bottle.addList();
+                delta_bottle.addString(deltas[i].name);
+                BlackBoardType type = ToCmdType(deltas[i].type);
+                delta_bottle.addInt(type);
+                delta_bottle.addInt64((YARP_INT64)deltas[i].version);
+                if (type == DOUBLE_TYPE)
+                {
+                    delta_bottle.addDouble(deltas[i].real);
+                }
+                else if (type == STRING_TYPE)
+                {
+                    delta_bottle.addString(deltas[i].text);
+                }
+                else
+                {
+                    delta_bottle.addInt64((YARP_INT64)deltas[i].integer);
+                }
+            }
+            // does not wait for the client
+            it->second->write();
+        }
+    }
+}
+
+void BlackBoardServer::StopStreaming()
+{
+    if (is_streaming_.exchange(false))
+    {
+        stream_thread_.join();
+    }
+
+    std::lock_guard<std::mutex> LockGuard(stream_mutex_);
+    for (std::map<unsigned int, yarp::os::BufferedPort<yarp::os::Bottle>*>::iterator it = stream_ports_.begin();
+         it != stream_ports_.end(); ++it)
+    {
+        stream_->Unsubscribe(it->first);
+        it->second->close();
+        delete it->second;
+    }
+    stream_ports_.clear();
+}
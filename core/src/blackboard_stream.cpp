@@ -0,0 +1,212 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <blackboard_stream.h>
+#include <clock.h>
+#include <algorithm>
+
+bool BT::MatchesKeyPattern(const std::string& pattern, const std::string& name)
+{
+    // greedy matching with backtracking to the last '*'
+    unsigned int pattern_idx = 0;
+    unsigned int name_idx = 0;
+    unsigned int star_idx = pattern.size();
+    unsigned int star_name_idx = 0;
+    while (name_idx < name.size())
+    {
+        if (pattern_idx < pattern.size() && (pattern[pattern_idx] == '?' || pattern[pattern_idx] == name[name_idx]))
+        {
+            pattern_idx++;
+            name_idx++;
+        }
+        else if (pattern_idx < pattern.size() && pattern[pattern_idx] == '*')
+        {
+            star_idx = pattern_idx++;
+            star_name_idx = name_idx;
+        }
+        else if (star_idx < pattern.size())
+        {
+            // the last '*' takes one more character
+            pattern_idx = star_idx + 1;
+            name_idx = ++star_name_idx;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (pattern_idx < pattern.size() && pattern[pattern_idx] == '*')
+    {
+        pattern_idx++;
+    }
+    return pattern_idx == pattern.size();
+}
+
+BT::BlackBoardStream::BlackBoardStream(TypedBlackBoard* blackboard)
+{
+    blackboard_ = blackboard;
+    next_subscription_id_ = 0;
+    blackboard_->set_change_notified(true);
+}
+
+BT::BlackBoardStream::~BlackBoardStream()
+{
+    blackboard_->set_change_notified(false);
+}
+
+unsigned int BT::BlackBoardStream::Subscribe(const std::vector<std::string>& patterns, double max_rate)
+{
+    Subscription subscription;
+    subscription.patterns = patterns;
+    subscription.min_period = std::chrono::steady_clock::duration::zero();
+    if (max_rate > 0)
+    {
+        subscription.min_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(1.0 / max_rate));
+    }
+    subscription.next_message_time = std::chrono::steady_clock::time_point::min();
+    subscription.is_pending = false;
+
+    std::lock_guard<std::mutex> LockGuard(subscriptions_mutex_);
+    unsigned int subscription_id = next_subscription_id_++;
+    subscriptions_[subscription_id] = subscription;
+    // the keys already set are sent at once
+    blackboard_->get_change_trigger()->Trigger();
+    return subscription_id;
+}
+
+bool BT::BlackBoardStream::Unsubscribe(unsigned int subscription_id)
+{
+    std::lock_guard<std::mutex> LockGuard(subscriptions_mutex_);
+    return subscriptions_.erase(subscription_id) > 0;
+}
+
+std::vector<unsigned int> BT::BlackBoardStream::GetSubscriptions()
+{
+    std::lock_guard<std::mutex> LockGuard(subscriptions_mutex_);
+    std::vector<unsigned int> subscription_ids;
+    for (std::map<unsigned int, Subscription>::iterator it = subscriptions_.begin(); it != subscriptions_.end(); ++it)
+    {
+        subscription_ids.push_back(it->first);
+    }
+    return subscription_ids;
+}
+
+std::vector<BT::BlackBoardDelta> BT::BlackBoardStream::CollectDeltas(unsigned int subscription_id)
+{
+    std::vector<BlackBoardDelta> deltas;
+    std::vector<uint64_t> versions;
+    blackboard_->GetVersions(&versions);
+    std::vector<std::string> names;
+
+    std::lock_guard<std::mutex> LockGuard(subscriptions_mutex_);
+    std::map<unsigned int, Subscription>::iterator it = subscriptions_.find(subscription_id);
+    if (it == subscriptions_.end())
+    {
+        throw BehaviorTreeException("No subscription " + std::to_string(subscription_id));
+    }
+    Subscription& subscription = it->second;
+
+    if (subscription.is_key_matched.size() < versions.size())
+    {
+        // new keys: the names are needed only to match them
+        names = blackboard_->GetNames();
+        for (unsigned int i = subscription.is_key_matched.size(); i < versions.size(); i++)
+        {
+            char is_matched = 0;
+            for (unsigned int j = 0; j < subscription.patterns.size() && !is_matched; j++)
+            {
+                is_matched = MatchesKeyPattern(subscription.patterns[j], names[i]);
+            }
+            subscription.is_key_matched.push_back(is_matched);
+            subscription.sent_versions.push_back(0);
+        }
+    }
+
+    std::vector<unsigned int> changed_keys;
+    for (unsigned int i = 0; i < versions.size(); i++)
+    {
+        if (subscription.is_key_matched[i] && versions[i] > subscription.sent_versions[i])
+        {
+            changed_keys.push_back(i);
+        }
+    }
+    if (changed_keys.empty())
+    {
+        return deltas;
+    }
+
+    std::chrono::steady_clock::time_point now = BT::GetDefaultClock()->Now();
+    if (now < subscription.next_message_time)
+    {
+        subscription.is_pending = true;
+        return deltas;
+    }
+    subscription.is_pending = false;
+    subscription.next_message_time = now + subscription.min_period;
+
+    if (names.empty())
+    {
+        names = blackboard_->GetNames();
+    }
+    for (unsigned int i = 0; i < changed_keys.size(); i++)
+    {
+        unsigned int key_idx = changed_keys[i];
+        BlackBoardDelta delta;
+        delta.name = names[key_idx];
+        delta.type = blackboard_->GetType(delta.name);
+        // the value may be newer than the version: it is then sent again with its own version
+        delta.version = versions[key_idx];
+        delta.integer = 0;
+        delta.real = 0.0;
+        switch (delta.type)
+        {
+        case DOUBLE_VALUE:
+            delta.real = blackboard_->GetByName<double>(delta.name);
+            break;
+        case STRING_VALUE:
+            delta.text = blackboard_->GetByName<std::string>(delta.name);
+            break;
+        case BLOB_VALUE:
+        case FIXED_VALUE:
+            subscription.sent_versions[key_idx] = versions[key_idx];
+            continue;
+        default:
+            delta.integer = blackboard_->GetByName<int64_t>(delta.name);
+            break;
+        }
+        subscription.sent_versions[key_idx] = versions[key_idx];
+        deltas.push_back(delta);
+    }
+    return deltas;
+}
+
+bool BT::BlackBoardStream::WaitForChanges(std::chrono::milliseconds max_wait)
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(subscriptions_mutex_);
+        std::chrono::steady_clock::time_point now = BT::GetDefaultClock()->Now();
+        for (std::map<unsigned int, Subscription>::iterator it = subscriptions_.begin(); it != subscriptions_.end(); ++it)
+        {
+            if (it->second.is_pending)
+            {
+                std::chrono::milliseconds wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            it->second.next_message_time - now) + std::chrono::milliseconds(1);
+                if (wait < max_wait)
+                {
+                    max_wait = std::max(wait, std::chrono::milliseconds::zero());
+                }
+            }
+        }
+    }
+    return blackboard_->get_change_trigger()->WaitForTrigger(max_wait);
+}
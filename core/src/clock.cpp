@@ -0,0 +1,157 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <clock.h>
+#include <exceptions.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+    std::atomic<BT::Clock*> default_clock_(NULL);
+}
+
+const std::chrono::milliseconds BT::VirtualClock::POLLING_PERIOD(1);
+
+void BT::Clock::SleepFor(std::chrono::steady_clock::duration duration)
+{
+    SleepUntil(Now() + duration);
+}
+
+
+std::chrono::steady_clock::time_point BT::RealTimeClock::Now()
+{
+    return std::chrono::steady_clock::now();
+}
+
+void BT::RealTimeClock::SleepUntil(std::chrono::steady_clock::time_point time)
+{
+    std::this_thread::sleep_until(time);
+}
+
+bool BT::RealTimeClock::WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& condition_variable,
+                                  std::chrono::steady_clock::time_point deadline,
+                                  const std::function<bool()>& is_done)
+{
+    if (deadline == std::chrono::steady_clock::time_point::max())
+    {
+        condition_variable.wait(lock, is_done);
+        return true;
+    }
+    return condition_variable.wait_until(lock, deadline, is_done);
+}
+
+
+BT::VirtualClock::VirtualClock(std::chrono::steady_clock::time_point start_time)
+{
+    now_ = start_time;
+    activities_number_ = 0;
+}
+
+BT::VirtualClock::~VirtualClock() {}
+
+std::chrono::steady_clock::time_point BT::VirtualClock::Now()
+{
+    std::lock_guard<std::mutex> LockGuard(mutex_);
+    return now_;
+}
+
+void BT::VirtualClock::SleepUntil(std::chrono::steady_clock::time_point time)
+{
+    std::unique_lock<std::mutex> UniqueLock(mutex_);
+    if (time <= now_)
+    {
+        return;
+    }
+    if (activities_number_ <= 0)
+    {
+        throw BehaviorTreeException("VirtualClock::SleepUntil called outside of an activity");
+    }
+
+    wake_up_times_.insert(time);
+    activities_number_--;
+    AdvanceIfIdle();
+    // the activity is counted again by whoever moves the time to its wake up
+    condition_variable_.wait(UniqueLock, [this, time]() { return now_ >= time; });
+}
+
+bool BT::VirtualClock::WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& condition_variable,
+                                 std::chrono::steady_clock::time_point deadline,
+                                 const std::function<bool()>& is_done)
+{
+    while (!is_done())
+    {
+        std::chrono::steady_clock::time_point now = Now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+        lock.unlock();
+        SleepUntil(std::min(deadline, now + POLLING_PERIOD));
+        lock.lock();
+    }
+    return true;
+}
+
+void BT::VirtualClock::BeginActivity()
+{
+    std::lock_guard<std::mutex> LockGuard(mutex_);
+    activities_number_++;
+}
+
+void BT::VirtualClock::EndActivity()
+{
+    std::lock_guard<std::mutex> LockGuard(mutex_);
+    activities_number_--;
+    AdvanceIfIdle();
+}
+
+int BT::VirtualClock::get_activities_number()
+{
+    std::lock_guard<std::mutex> LockGuard(mutex_);
+    return activities_number_;
+}
+
+void BT::VirtualClock::AdvanceIfIdle()
+{
+    if (activities_number_ > 0 || wake_up_times_.empty())
+    {
+        return;
+    }
+
+    now_ = *wake_up_times_.begin();
+    // the woken activities are counted here, before any of them runs: the time cannot move again
+    // until they all sleep or end
+    while (!wake_up_times_.empty() && *wake_up_times_.begin() <= now_)
+    {
+        wake_up_times_.erase(wake_up_times_.begin());
+        activities_number_++;
+    }
+    condition_variable_.notify_all();
+}
+
+
+BT::Clock* BT::GetDefaultClock()
+{
+    // never deleted: action tasks may still be sleeping when the program exits
+    static Clock* real_time_clock = new RealTimeClock();
+
+    Clock* clock = default_clock_.load(std::memory_order_acquire);
+    return clock != NULL ? clock : real_time_clock;
+}
+
+void BT::SetDefaultClock(Clock* clock)
+{
+    default_clock_.store(clock, std::memory_order_release);
+}
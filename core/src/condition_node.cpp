@@ -12,16 +12,80 @@
 
 #include <condition_node.h>
 #include <string>
+#include <atomic>
+
+namespace
+{
+    std::atomic<bool> is_memoization_enabled_(false);
+    std::atomic<uint64_t> last_tick_epoch_(0);
+    thread_local uint64_t tick_epoch_ = 0;
+}
+
+void BT::SetConditionMemoization(bool is_enabled)
+{
+    is_memoization_enabled_.store(is_enabled);
+}
+
+bool BT::IsConditionMemoizationEnabled()
+{
+    return is_memoization_enabled_.load(std::memory_order_relaxed);
+}
+
+BT::TickEpochScope::TickEpochScope() : previous_epoch_(tick_epoch_)
+{
+    if (tick_epoch_ == 0)
+    {
+        tick_epoch_ = last_tick_epoch_.fetch_add(1) + 1;
+    }
+}
+
+BT::TickEpochScope::TickEpochScope(uint64_t epoch) : previous_epoch_(tick_epoch_)
+{
+    tick_epoch_ = epoch;
+}
+
+BT::TickEpochScope::~TickEpochScope()
+{
+    tick_epoch_ = previous_epoch_;
+}
+
+uint64_t BT::GetTickEpoch()
+{
+    return tick_epoch_;
+}
 
 BT::ConditionNode::ConditionNode(std::string name) : LeafNode::LeafNode(name)
 {
     type_ = BT::CONDITION_NODE;
+    memoized_epoch_ = 0;
+    memoized_status_ = BT::IDLE;
 }
 
 BT::ConditionNode::~ConditionNode() {}
 
 void BT::ConditionNode::Halt() {}
 
+BT::ReturnStatus BT::ConditionNode::TickOnce()
+{
+    uint64_t epoch = GetTickEpoch();
+    if (!IsConditionMemoizationEnabled() || epoch == 0)
+    {
+        return Tick();
+    }
+
+    std::lock_guard<std::mutex> LockGuard(memoization_mutex_);
+    if (memoized_epoch_ != epoch)
+    {
+        memoized_status_ = Tick();
+        memoized_epoch_ = epoch;
+    }
+    else
+    {
+        DEBUG_STDOUT(get_name() << " MEMOIZED IN EPOCH " << epoch);
+    }
+    return memoized_status_;
+}
+
 int BT::ConditionNode::DrawType()
 {
     return BT::CONDITION;
@@ -15,6 +15,70 @@
 #include <string>
 #include <vector>
 
+namespace
+{
+    std::atomic<int64_t> halt_deadline_milliseconds_(std::chrono::milliseconds::max().count());
+    std::atomic<unsigned long> missed_halt_deadlines_number_(0);
+}
+
+void BT::SetHaltDeadline(std::chrono::milliseconds halt_deadline)
+{
+    halt_deadline_milliseconds_.store(halt_deadline.count());
+}
+
+std::chrono::milliseconds BT::GetHaltDeadline()
+{
+    return std::chrono::milliseconds(halt_deadline_milliseconds_.load());
+}
+
+unsigned long BT::GetMissedHaltDeadlinesNumber()
+{
+    return missed_halt_deadlines_number_.load();
+}
+
+unsigned int BT::WaitForHaltResponses(const std::vector<TreeNode*>& halting_actions)
+{
+    std::chrono::milliseconds halt_deadline = GetHaltDeadline();
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    if (halt_deadline != std::chrono::milliseconds::max())
+    {
+        deadline = BT::GetDefaultClock()->Now() + halt_deadline;
+    }
+
+    // the actions are halting concurrently: the whole wait lasts as long as the slowest one
+    unsigned int missed_deadlines_number = 0;
+    for (unsigned int i = 0; i < halting_actions.size(); i++)
+    {
+        BT::ReturnStatus status = halting_actions[i]->WaitForHaltResponse(deadline);
+        if (status != BT::HALTED && status != BT::IDLE)
+        {
+            // counted and traced only: the halts run on the tick path, which must not block on I/O
+            BT_TRACE_EVENT(BT::Trace::HALT_DEADLINE_MISSED, halting_actions[i]->get_name(), status);
+            missed_deadlines_number++;
+        }
+    }
+    missed_halt_deadlines_number_ += missed_deadlines_number;
+    return missed_deadlines_number;
+}
+
+void BT::RequestActionHalt(TreeNode* action, std::vector<TreeNode*>* halting_actions)
+{
+    if (action->get_status() != BT::RUNNING || action->is_halt_requested())
+    {
+        return;
+    }
+    BT_TRACE_EVENT(BT::Trace::HALT_CHILD, action->get_name(), action->get_type());
+    if (action->get_type() == BT::YARP_ACTION_NODE)
+    {
+        static_cast<BT::ActionNode*>(action)->SendHalt();
+    }
+    else
+    {
+        action->halt_requested(true);
+    }
+    halting_actions->push_back(action);
+}
+
 BT::ControlNode::ControlNode(std::string name) : TreeNode::TreeNode(name)
 {
     type_ = BT::CONTROL_NODE;
@@ -48,9 +112,11 @@ unsigned int BT::ControlNode::GetChildrenNumber()
 
 void BT::ControlNode::Halt()
 {
-    std::cout << "HALTING: " << get_name() << std::endl;
-
-    DEBUG_STDOUT("HALTING: "<< get_name());
+    BT_TRACE_EVENT(BT::Trace::HALT, get_name(), get_status());
+    if (BT::Metrics::IsEnabled() && get_status() == BT::RUNNING)
+    {
+        RecordHaltStart();
+    }
     HaltChildren(0);
     set_status(BT::HALTED);
 }
@@ -81,45 +147,52 @@ void BT::ControlNode::Finalize()
 
 void BT::ControlNode::HaltChildren(int i)
 {
-    for (unsigned int j=i; j < children_nodes_.size(); j++)
+    // 1) the halt requests are sent at once to all the running actions of the subtree
+    std::vector<TreeNode*> halting_actions;
+    RequestHaltChildren(i, &halting_actions);
+
+    // 2) a single wait for all of them, bounded by the halt deadline
+    BT::WaitForHaltResponses(halting_actions);
+
+    // 3) the running control nodes (whose actions are now halted) reset their state
+    for (unsigned int j = i; j < children_nodes_.size(); j++)
     {
         if (children_nodes_[j]->get_type() == BT::CONDITION_NODE)
         {
             children_nodes_[j]->ResetColorState();
         }
-        else
+        else if (children_nodes_[j]->get_status() == BT::RUNNING)
         {
-            if (children_nodes_[j]->get_status() == BT::RUNNING)
+            if (children_nodes_[j]->get_type() == BT::CONTROL_NODE)
             {
-                DEBUG_STDOUT("SENDING HALT TO CHILD " << children_nodes_[j]-> get_name());
-                //children_nodes_[j]->Halt();
-                std::cout << "SENDING HALT TO CHILD " << children_nodes_[j]-> get_name() << std::endl;
-            if(children_nodes_[j]->get_type() == BT::ACTION_NODE){
-                // if it is an action, i need to halt using the halt_request 
-                children_nodes_[j]->halt_requested(true);
-                //wait for the child j to be halted
-                do
-                {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    //std::cout <<" Waiting fo halt of " << children_nodes_[j]-> get_name() <<  "status " << children_nodes_[j]->get_status()  <<  std::endl;
-                }
-                while (children_nodes_[j]->get_status() != BT::HALTED  && children_nodes_[j]->get_status() != BT::IDLE );
-            }
-            else
-            { // is a control flow node (or yarp action)
                 children_nodes_[j]->Halt();
-                std::cout << "SENDING HALT TO CHILD " << children_nodes_[j]-> get_name() << std::endl;
-
             }
+        }
+        else
+        {
+            BT_TRACE_EVENT(BT::Trace::NO_NEED_TO_HALT, children_nodes_[j]->get_name(),
+                           children_nodes_[j]->get_status());
+        }
+    }
+}
 
-            }
-            else
-            {
-                std::cout << "NO NEED TO HALT XXX" << children_nodes_[j]-> get_name()
-                          << "STATUS" << children_nodes_[j]->get_status() << std::endl;
-                DEBUG_STDOUT("NO NEED TO HALT " << children_nodes_[j]-> get_name()
-                             << "STATUS" << children_nodes_[j]->get_status());
-            }
+void BT::ControlNode::RequestHaltChildren(int i, std::vector<TreeNode*>* halting_actions)
+{
+    for (unsigned int j = i; j < children_nodes_.size(); j++)
+    {
+        TreeNode* child = children_nodes_[j];
+        if (child->get_status() != BT::RUNNING)
+        {
+            continue;
+        }
+
+        if (child->get_type() == BT::ACTION_NODE || child->get_type() == BT::YARP_ACTION_NODE)
+        {
+            BT::RequestActionHalt(child, halting_actions);
+        }
+        else if (child->get_type() == BT::CONTROL_NODE)
+        {
+            static_cast<BT::ControlNode*>(child)->RequestHaltChildren(0, halting_actions);
         }
     }
 }
@@ -141,12 +214,34 @@ int BT::ControlNode::Depth()
 
 
 
+BT::ReturnStatus BT::ControlNode::TickSynchronousChild(TreeNode* child)
+{
+    if (BT::Metrics::IsEnabled())
+    {
+        int64_t start_ns = BT::Metrics::NowNanoseconds();
+        BT::ReturnStatus status = child->get_type() == BT::CONDITION_NODE ?
+                    static_cast<BT::ConditionNode*>(child)->TickOnce() : child->Tick();
+        child->RecordTickDuration(BT::Metrics::NowNanoseconds() - start_ns);
+        return status;
+    }
+
+    if (child->get_type() == BT::CONDITION_NODE)
+    {
+        return static_cast<BT::ConditionNode*>(child)->TickOnce();
+    }
+    return child->Tick();
+}
+
+
 BT::RootNode::RootNode() : ControlNode::ControlNode("root") {}
 
 BT::RootNode::~RootNode() {}
 
 BT::ReturnStatus BT::RootNode::Tick()
 {
+    // each tick of the root is a new epoch for the memoized conditions (unless it is nested in one)
+    BT::TickEpochScope epoch;
+
     // gets the number of children. The number could change if, at runtime, one edits the tree.
     N_of_children_ = children_nodes_.size();
 
@@ -172,23 +267,17 @@ BT::ReturnStatus BT::RootNode::Tick()
         {
             // 1.1) If the action status is not running, the sequence node sends a tick to it.
          //   std::cout << get_name() << "NEEDS TO TICK " << children_nodes_[i]->get_name() << std::endl;
-            children_nodes_[0]->tick_engine.Tick();
+            static_cast<BT::ActionNode*>(children_nodes_[0])->SendTick();
 
-            // waits for the tick to arrive to the child
-            do
-            {
-                child_i_status_ = children_nodes_[0]->get_status();
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
-            while (child_i_status_ != BT::RUNNING && child_i_status_ != BT::SUCCESS
-                   && child_i_status_ != BT::FAILURE);
+            // waits for the tick to arrive to the child (woken up by the child's set_status)
+            child_i_status_ = children_nodes_[0]->WaitForTickResponse();
         }
     }
     else
     {
         // 2) if it's not an action:
         // Send the tick and wait for the response;
-        child_i_status_ = children_nodes_[0]->Tick();
+        child_i_status_ = TickSynchronousChild(children_nodes_[0]);
         children_nodes_[0]->set_status(child_i_status_);
     }
 
@@ -1,52 +1,92 @@
-#include <decorator_sync.h>
-
-#include <boost/interprocess/shared_memory_object.hpp>
-
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
 
+#include <decorator_sync.h>
+#include <string>
 
-using namespace boost::interprocess;
 
 BT::DecoratorSync::DecoratorSync(std::string name, std::string link_name) : ControlNode::ControlNode(name)
 {
+    link_ = BT::GetSyncLink(link_name);
+    link_->AddParticipant();
+    tick_id_ = link_->get_tick_id();
+    is_waiting_link_ = false;
+}
 
-    link_ = tick_engine.CreateSyncLink(link_name);
-    tick_id_ = 0;
-
+BT::DecoratorSync::~DecoratorSync()
+{
+    link_->RemoveParticipant();
 }
 
 
 BT::ReturnStatus BT::DecoratorSync::Tick()
 {
-    if (children_nodes_[0]->get_type() == BT::ACTION_NODE)
+    if (children_nodes_.size() != 1)
     {
-        throw std::string("DecoratorSync can only have actions as children");
+        throw BehaviorTreeException("DecoratorSync '" + get_name() + "' must have exactly one child");
     }
-    if(link_->is_tick_id_ready(tick_id_))
+
+    if (!is_waiting_link_)
     {
-        BT::ReturnStatus status = children_nodes_[0]->TickSync(tick_id_);
-        tick_id_++;
-        if (status == BT::SUCCESS || status == BT::FAILURE)
+        TreeNode* child = children_nodes_[0];
+        if (child->get_type() == BT::ACTION_NODE || child->get_type() == BT::YARP_ACTION_NODE)
         {
-            set_status(status);
-            return status;
+            child_i_status_ = child->get_status();
+            if (child_i_status_ == BT::IDLE || child_i_status_ == BT::HALTED)
+            {
+                static_cast<BT::ActionNode*>(child)->SendTick();
+                child_i_status_ = child->WaitForTickResponse();
+            }
         }
+        else
+        {
+            child_i_status_ = TickSynchronousChild(child);
+            child->set_status(child_i_status_);
+        }
+
+        if (child_i_status_ != BT::SUCCESS && child_i_status_ != BT::FAILURE)
+        {
+            set_status(child_i_status_);
+            return child_i_status_;
+        }
+
+        // the child is done with this tick: arrives at the barrier
+        link_->NodeDone(tick_id_);
+        tick_id_++;
+        is_waiting_link_ = true;
     }
-    set_status(BT::RUNNING);
-    return BT::RUNNING;
+
+    if (!link_->is_tick_id_ready(tick_id_))
+    {
+        DEBUG_STDOUT(get_name() << " WAITING LINK " << link_->get_name());
+        set_status(BT::RUNNING);
+        return BT::RUNNING;
+    }
+
+    is_waiting_link_ = false;
+    children_nodes_[0]->set_status(BT::IDLE);
+    set_status(child_i_status_);
+    return child_i_status_;
 }
 
 void BT::DecoratorSync::Halt()
 {
-
-    tick_id_ = 0;
+    // a participant that has already arrived at the barrier cannot leave it:
+    // tick_id_ and is_waiting_link_ are kept, the result is returned once the others arrive
     ControlNode::Halt();
-
 }
 
 
 int BT::DecoratorSync::DrawType()
 {
-    // Lock acquistion
-
     return BT::DECORATOR;
 }
@@ -0,0 +1,240 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <executor.h>
+#include <trace.h>
+#include <algorithm>
+
+namespace
+{
+    // The worker (if any) running on the current thread. Used to push the tasks
+    // submitted from a worker to its own deque.
+    thread_local BT::WorkStealingExecutor* current_executor_ = NULL;
+    thread_local unsigned int current_worker_idx_ = 0;
+
+    std::atomic<BT::Executor*> default_executor_(NULL);
+    std::mutex default_executor_mutex_;
+}
+
+BT::WorkStealingExecutor::WorkStealingExecutor(unsigned int workers_number, unsigned int max_workers_number)
+{
+    if (workers_number == 0)
+    {
+        workers_number = std::thread::hardware_concurrency();
+    }
+    if (workers_number == 0)
+    {
+        // the number of cores is not computable
+        workers_number = 1;
+    }
+    max_workers_number_ = std::min(std::max(workers_number, max_workers_number), MAX_WORKERS_NUMBER);
+    workers_number = std::min(workers_number, max_workers_number_);
+
+    next_worker_idx_ = 0;
+    pending_tasks_number_ = 0;
+    busy_workers_number_ = 0;
+    saturated_submits_number_ = 0;
+    stop_ = false;
+
+    for (unsigned int i = 0; i < workers_number; i++)
+    {
+        workers_[i] = new Worker();
+    }
+    workers_number_ = workers_number;
+    // the workers are started once all the deques exist (they steal from each other)
+    for (unsigned int i = 0; i < workers_number; i++)
+    {
+        workers_[i]->thread_ = std::thread(&WorkStealingExecutor::WorkerLoop, this, i);
+    }
+}
+
+BT::WorkStealingExecutor::~WorkStealingExecutor()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(idle_mutex_);
+        stop_ = true;
+    }
+    idle_condition_variable_.notify_all();
+
+    // no worker can be started once stop_ is set (a worker that submits a task must not wait for the join)
+    unsigned int workers_number;
+    {
+        std::lock_guard<std::mutex> LockGuard(grow_mutex_);
+        workers_number = workers_number_;
+    }
+    for (unsigned int i = 0; i < workers_number; i++)
+    {
+        workers_[i]->thread_.join();
+    }
+    // the deques are deleted only once no worker can steal from them anymore
+    for (unsigned int i = 0; i < workers_number; i++)
+    {
+        delete workers_[i];
+    }
+}
+
+void BT::WorkStealingExecutor::Submit(std::function<void()> task)
+{
+    unsigned int worker_idx;
+
+    if (current_executor_ == this)
+    {
+        // submitted by one of the workers, it goes in its own deque
+        worker_idx = current_worker_idx_;
+    }
+    else
+    {
+        worker_idx = next_worker_idx_++ % workers_number_.load(std::memory_order_acquire);
+    }
+
+    {
+        // the counter is incremented holding the idle mutex, so no worker can miss the notification.
+        // It is incremented before the push: a worker that pops the task at once cannot make it negative
+        std::lock_guard<std::mutex> LockGuard(idle_mutex_);
+        pending_tasks_number_++;
+    }
+    {
+        std::lock_guard<std::mutex> LockGuard(workers_[worker_idx]->mutex_);
+        workers_[worker_idx]->tasks_.push_back(task);
+    }
+    GrowIfBusy();
+    idle_condition_variable_.notify_one();
+}
+
+unsigned int BT::WorkStealingExecutor::get_workers_number()
+{
+    return workers_number_.load(std::memory_order_acquire);
+}
+
+unsigned long BT::WorkStealingExecutor::get_saturated_submits_number()
+{
+    return saturated_submits_number_.load(std::memory_order_relaxed);
+}
+
+void BT::WorkStealingExecutor::GrowIfBusy()
+{
+    if (busy_workers_number_ + pending_tasks_number_ <= (int)workers_number_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> LockGuard(grow_mutex_);
+    unsigned int workers_number = workers_number_.load(std::memory_order_relaxed);
+    int waiting_tasks_number = busy_workers_number_ + pending_tasks_number_ - (int)workers_number;
+    if (waiting_tasks_number <= 0)
+    {
+        return;
+    }
+    if (workers_number >= max_workers_number_)
+    {
+        // the task waits for a worker to finish its action
+        saturated_submits_number_.fetch_add(1, std::memory_order_relaxed);
+        BT_TRACE_EVENT(BT::Trace::EXECUTOR_SATURATED, "executor", waiting_tasks_number);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> LockGuard(idle_mutex_);
+        if (stop_)
+        {
+            return;
+        }
+    }
+    workers_[workers_number] = new Worker();
+    // the new deque is visible to the thieves before the worker starts
+    workers_number_.store(workers_number + 1, std::memory_order_release);
+    workers_[workers_number]->thread_ = std::thread(&WorkStealingExecutor::WorkerLoop, this, workers_number);
+}
+
+bool BT::WorkStealingExecutor::PopTask(unsigned int worker_idx, std::function<void()>& task)
+{
+    {
+        // 1) LIFO on its own deque
+        Worker* worker = workers_[worker_idx];
+        std::lock_guard<std::mutex> LockGuard(worker->mutex_);
+        if (!worker->tasks_.empty())
+        {
+            task = worker->tasks_.back();
+            worker->tasks_.pop_back();
+            return true;
+        }
+    }
+
+    // 2) FIFO on the deques of the others
+    unsigned int workers_number = workers_number_.load(std::memory_order_acquire);
+    for (unsigned int i = 1; i < workers_number; i++)
+    {
+        Worker* victim = workers_[(worker_idx + i) % workers_number];
+        std::lock_guard<std::mutex> LockGuard(victim->mutex_);
+        if (!victim->tasks_.empty())
+        {
+            task = victim->tasks_.front();
+            victim->tasks_.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void BT::WorkStealingExecutor::WorkerLoop(unsigned int worker_idx)
+{
+    current_executor_ = this;
+    current_worker_idx_ = worker_idx;
+
+    std::function<void()> task;
+
+    while (true)
+    {
+        if (PopTask(worker_idx, task))
+        {
+            busy_workers_number_++;
+            pending_tasks_number_--;
+            task();
+            task = nullptr;
+            busy_workers_number_--;
+            continue;
+        }
+
+        // nothing to do, waits for a new task
+        std::unique_lock<std::mutex> UniqueLock(idle_mutex_);
+        while (pending_tasks_number_ == 0 && !stop_)
+        {
+            idle_condition_variable_.wait(UniqueLock);
+        }
+        if (stop_ && pending_tasks_number_ == 0)
+        {
+            return;
+        }
+    }
+}
+
+BT::Executor* BT::GetDefaultExecutor()
+{
+    Executor* executor = default_executor_.load(std::memory_order_acquire);
+    if (executor == NULL)
+    {
+        std::lock_guard<std::mutex> LockGuard(default_executor_mutex_);
+        executor = default_executor_.load(std::memory_order_relaxed);
+        if (executor == NULL)
+        {
+            // never deleted: action tasks may still be running when the program exits
+            executor = new WorkStealingExecutor();
+            default_executor_.store(executor, std::memory_order_release);
+        }
+    }
+    return executor;
+}
+
+void BT::SetDefaultExecutor(Executor* executor)
+{
+    std::lock_guard<std::mutex> LockGuard(default_executor_mutex_);
+    default_executor_.store(executor, std::memory_order_release);
+}
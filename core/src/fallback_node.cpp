@@ -41,23 +41,17 @@ BT::ReturnStatus BT::FallbackNode::Tick()
                 {
                     // 1.1) If the action status is not running, the sequence node sends a tick to it.
                     DEBUG_STDOUT(get_name() << "NEEDS TO TICK " << children_nodes_[i]->get_name());
-                    children_nodes_[i]->tick_engine.Tick();
+                    static_cast<BT::ActionNode*>(children_nodes_[i])->SendTick();
 
-                    // waits for the tick to arrive to the child
-                    do
-                    {
-                        child_i_status_ = children_nodes_[i]->get_status();
-                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                    }
-                    while (child_i_status_ != BT::RUNNING && child_i_status_ != BT::SUCCESS
-                           && child_i_status_ != BT::FAILURE);
+                    // waits for the tick to arrive to the child (woken up by the child's set_status)
+                    child_i_status_ = children_nodes_[i]->WaitForTickResponse();
                 }
             }
             else
             {
                 // 2) if it's not an action:
                 // Send the tick and wait for the response;
-                child_i_status_ = children_nodes_[i]->Tick();
+                child_i_status_ = TickSynchronousChild(children_nodes_[i]);
                 children_nodes_[i]->set_status(child_i_status_);
 
             }
@@ -59,23 +59,17 @@ BT::ReturnStatus BT::FallbackNodeWithMemory::Tick()
             {
                 // 1.1) If the action status is not running, the sequence node sends a tick to it.
                 DEBUG_STDOUT(get_name() << "NEEDS TO TICK " << children_nodes_[current_child_idx_]->get_name());
-                children_nodes_[current_child_idx_]->tick_engine.Tick();
-
-                // waits for the tick to arrive to the child
-                do
-                {
-                    child_i_status_ = children_nodes_[current_child_idx_]->get_status();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-                while (child_i_status_ != BT::RUNNING && child_i_status_ != BT::SUCCESS
-                      && child_i_status_ != BT::FAILURE);
+                static_cast<BT::ActionNode*>(children_nodes_[current_child_idx_])->SendTick();
+
+                // waits for the tick to arrive to the child (woken up by the child's set_status)
+                child_i_status_ = children_nodes_[current_child_idx_]->WaitForTickResponse();
             }
         }
         else
         {
             // 2) if it's not an action:
             // Send the tick and wait for the response;
-            child_i_status_ = children_nodes_[current_child_idx_]->Tick();
+            child_i_status_ = TickSynchronousChild(children_nodes_[current_child_idx_]);
             children_nodes_[current_child_idx_]->set_status(child_i_status_);
 
         }
@@ -0,0 +1,185 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <hot_swap_node.h>
+#include <string>
+
+BT::HotSwapNode::HotSwapNode(std::string name) : ControlNode::ControlNode(name)
+{
+    current_version_ = NULL;
+    pending_version_ = NULL;
+    retired_versions_ = NULL;
+    swaps_number_ = 0;
+}
+
+BT::HotSwapNode::~HotSwapNode()
+{
+    if (current_version_ != NULL)
+    {
+        Retire(current_version_);
+    }
+    if (pending_version_.load() != NULL)
+    {
+        Retire(pending_version_.load());
+    }
+
+    // the halts of all the versions are requested at once, then each version is waited until quiescent
+    // (see BehaviorTree::Shutdown()) and destroyed
+    Version* versions = retired_versions_.exchange(NULL);
+    for (Version* version = versions; version != NULL; version = version->next)
+    {
+        version->tree->RequestHalt();
+    }
+    while (versions != NULL)
+    {
+        Version* next = versions->next;
+        versions->tree->Shutdown();
+        delete versions->tree;
+        delete versions;
+        versions = next;
+    }
+}
+
+BT::ReturnStatus BT::HotSwapNode::Tick()
+{
+    if (pending_version_.load(std::memory_order_acquire) != NULL)
+    {
+        // taken out first: Swap() may replace it meanwhile, and the one it replaces is destroyed
+        Version* pending_version = pending_version_.exchange(NULL, std::memory_order_acq_rel);
+        if (current_version_ != NULL && children_nodes_[0]->get_status() == BT::RUNNING
+                && pending_version->hand_over_policy == BT::FINISH_RUNNING_ACTIONS)
+        {
+            // the old version goes on: the new one is put back, unless an even newer one has been published
+            Version* expected_version = NULL;
+            if (!pending_version_.compare_exchange_strong(expected_version, pending_version,
+                                                          std::memory_order_acq_rel))
+            {
+                Retire(pending_version);
+            }
+        }
+        else
+        {
+            Adopt(pending_version);
+        }
+    }
+
+    if (current_version_ == NULL)
+    {
+        throw BehaviorTreeException("'" + get_name() + "' has no version to tick");
+    }
+
+    if (children_nodes_[0]->get_type() == BT::ACTION_NODE || children_nodes_[0]->get_type() == BT::YARP_ACTION_NODE)
+    {
+        child_i_status_ = children_nodes_[0]->get_status();
+        if (child_i_status_ == BT::IDLE || child_i_status_ == BT::HALTED)
+        {
+            static_cast<BT::ActionNode*>(children_nodes_[0])->SendTick();
+            child_i_status_ = children_nodes_[0]->WaitForTickResponse();
+        }
+    }
+    else
+    {
+        child_i_status_ = TickSynchronousChild(children_nodes_[0]);
+        children_nodes_[0]->set_status(child_i_status_);
+    }
+    return child_i_status_;
+}
+
+int BT::HotSwapNode::DrawType()
+{
+    return BT::SUBTREE;
+}
+
+void BT::HotSwapNode::Swap(BehaviorTree* version, HandOverPolicy hand_over_policy)
+{
+    if (version->get_root() == NULL)
+    {
+        throw BehaviorTreeException("the version swapped into '" + get_name() + "' has no root");
+    }
+    Version* new_version = new Version();
+    new_version->tree = version;
+    new_version->hand_over_policy = hand_over_policy;
+    new_version->next = NULL;
+
+    Version* replaced_version = pending_version_.exchange(new_version, std::memory_order_acq_rel);
+    if (replaced_version != NULL)
+    {
+        // never ticked
+        Retire(replaced_version);
+    }
+    CollectRetiredVersions();
+}
+
+unsigned int BT::HotSwapNode::CollectRetiredVersions()
+{
+    std::lock_guard<std::mutex> LockGuard(collect_mutex_);
+
+    // the whole stack is taken at once: Tick() keeps pushing onto an empty one
+    Version* version = retired_versions_.exchange(NULL, std::memory_order_acquire);
+    unsigned int retired_versions_number = 0;
+    while (version != NULL)
+    {
+        Version* next = version->next;
+        if (version->tree->IsQuiescent())
+        {
+            delete version->tree;
+            delete version;
+        }
+        else
+        {
+            Retire(version);
+            retired_versions_number++;
+        }
+        version = next;
+    }
+    return retired_versions_number;
+}
+
+unsigned int BT::HotSwapNode::get_swaps_number()
+{
+    return swaps_number_.load();
+}
+
+void BT::HotSwapNode::Adopt(Version* version)
+{
+    if (current_version_ != NULL)
+    {
+        // the halt of the old version is requested and not waited: the tick goes on with the new one.
+        // All its running actions, wherever they are in the version (the halts of the YARP actions are sent
+        // on the executor). The version is destroyed by CollectRetiredVersions() once they have returned
+        current_version_->tree->RequestHalt();
+        Retire(current_version_);
+    }
+
+    current_version_ = version;
+    if (children_nodes_.empty())
+    {
+        AddChild(version->tree->get_root());
+    }
+    else
+    {
+        children_nodes_[0] = version->tree->get_root();
+        children_states_[0] = BT::IDLE;
+    }
+    swaps_number_++;
+}
+
+void BT::HotSwapNode::Retire(Version* version)
+{
+    Version* head = retired_versions_.load(std::memory_order_relaxed);
+    do
+    {
+        version->next = head;
+    }
+    while (!retired_versions_.compare_exchange_weak(head, version, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+}
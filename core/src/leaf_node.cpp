@@ -21,7 +21,7 @@ BT::LeafNode::~LeafNode() {}
 
 void BT::LeafNode::ResetColorState()
 {
-    color_status_ = BT::IDLE;
+    set_color_status(BT::IDLE);
 }
 
 int BT::LeafNode::Depth()
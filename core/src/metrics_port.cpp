@@ -0,0 +1,65 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <metrics_port.h>
+
+namespace
+{
+    void AddSummary(const std::string& name, const BT::Metrics::HistogramSummary& summary, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& summary_bottle = bottle.addList();
+        summary_bottle.addString(name);
+        summary_bottle.addInt((int)summary.count);
+        summary_bottle.addDouble(summary.p50_ns / 1000.0);
+        summary_bottle.addDouble(summary.p99_ns / 1000.0);
+        summary_bottle.addDouble(summary.max_ns / 1000.0);
+    }
+}
+
+BT::MetricsPort::MetricsPort(std::string port_name)
+{
+    port_name_ = port_name;
+}
+
+BT::MetricsPort::~MetricsPort()
+{
+    Close();
+}
+
+bool BT::MetricsPort::Open()
+{
+    return port_.open(port_name_);
+}
+
+void BT::MetricsPort::Close()
+{
+    port_.close();
+}
+
+void BT::MetricsPort::Publish(TreeNode* root)
+{
+    std::vector<BT::Metrics::NodeReport> report = BT::Metrics::CollectReport(root);
+
+    yarp::os::Bottle& bottle = port_.prepare();
+    bottle.clear();
+    for (unsigned int i = 0; i < report.size(); i++)
+    {
+        yarp::os::Bottle& node_bottle = bottle.addList();
+        node_bottle.addString(report[i].name);
+        node_bottle.addInt((int)report[i].successes_number);
+        node_bottle.addInt((int)report[i].failures_number);
+        AddSummary("tick", report[i].tick_duration, node_bottle);
+        AddSummary("running", report[i].running_time, node_bottle);
+        AddSummary("halt", report[i].halt_latency, node_bottle);
+    }
+    port_.write();
+}
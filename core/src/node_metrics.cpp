@@ -0,0 +1,209 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <node_metrics.h>
+#include <control_node.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <set>
+
+std::atomic<bool> BT::Metrics::is_enabled_(false);
+
+namespace
+{
+    BT::Metrics::HistogramSummary Summarize(BT::Metrics::Histogram& histogram)
+    {
+        BT::Metrics::HistogramSummary summary;
+        summary.count = histogram.get_count();
+        summary.p50_ns = histogram.get_percentile(50);
+        summary.p99_ns = histogram.get_percentile(99);
+        summary.max_ns = histogram.get_max();
+        return summary;
+    }
+
+    void PrintSummary(const BT::Metrics::HistogramSummary& summary, std::ostream& stream)
+    {
+        stream << std::setw(10) << summary.count
+               << std::setw(12) << summary.p50_ns / 1000.0
+               << std::setw(12) << summary.p99_ns / 1000.0
+               << std::setw(12) << summary.max_ns / 1000.0;
+    }
+
+    void CollectNodeReport(BT::TreeNode* node, std::set<BT::TreeNode*>* visited_nodes,
+                           std::vector<BT::Metrics::NodeReport>* report)
+    {
+        if (!visited_nodes->insert(node).second)
+        {
+            return;
+        }
+
+        BT::Metrics::NodeMetrics* metrics = node->get_metrics();
+        if (metrics != NULL)
+        {
+            BT::Metrics::NodeReport node_report;
+            node_report.name = node->get_name();
+            node_report.tick_duration = Summarize(metrics->tick_duration);
+            node_report.running_time = Summarize(metrics->running_time);
+            node_report.halt_latency = Summarize(metrics->halt_latency);
+            node_report.successes_number = metrics->successes_number.load(std::memory_order_relaxed);
+            node_report.failures_number = metrics->failures_number.load(std::memory_order_relaxed);
+            report->push_back(node_report);
+        }
+
+        if (node->get_type() == BT::CONTROL_NODE)
+        {
+            std::vector<BT::TreeNode*> children = static_cast<BT::ControlNode*>(node)->GetChildren();
+            for (unsigned int i = 0; i < children.size(); i++)
+            {
+                CollectNodeReport(children[i], visited_nodes, report);
+            }
+        }
+    }
+}
+
+
+BT::Metrics::Histogram::Histogram()
+{
+    for (unsigned int i = 0; i < BUCKETS_NUMBER; i++)
+    {
+        buckets_[i] = 0;
+    }
+    count_ = 0;
+    max_ = 0;
+}
+
+unsigned int BT::Metrics::Histogram::BucketIndex(uint64_t value_ns)
+{
+    if (value_ns < SUB_BUCKETS_NUMBER)
+    {
+        return value_ns;
+    }
+
+    unsigned int exponent = 63 - __builtin_clzll(value_ns);
+    if (exponent > MAX_EXPONENT)
+    {
+        return BUCKETS_NUMBER - 1;
+    }
+    // the SUB_BUCKET_BITS bits after the most significant one select the sub-bucket
+    unsigned int sub_bucket = (value_ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS_NUMBER - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS_NUMBER + sub_bucket;
+}
+
+uint64_t BT::Metrics::Histogram::BucketLowerBound(unsigned int bucket_idx)
+{
+    if (bucket_idx < SUB_BUCKETS_NUMBER)
+    {
+        return bucket_idx;
+    }
+    unsigned int exponent = bucket_idx / SUB_BUCKETS_NUMBER + SUB_BUCKET_BITS - 1;
+    uint64_t sub_bucket = bucket_idx % SUB_BUCKETS_NUMBER;
+    return (SUB_BUCKETS_NUMBER + sub_bucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+void BT::Metrics::Histogram::Record(uint64_t value_ns)
+{
+    buckets_[BucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value_ns > max && !max_.compare_exchange_weak(max, value_ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t BT::Metrics::Histogram::get_count()
+{
+    return count_.load(std::memory_order_relaxed);
+}
+
+uint64_t BT::Metrics::Histogram::get_max()
+{
+    return max_.load(std::memory_order_relaxed);
+}
+
+uint64_t BT::Metrics::Histogram::get_percentile(double percentile)
+{
+    uint64_t count = get_count();
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // rank of the sample, in [1, count]
+    uint64_t rank = (uint64_t)(percentile / 100.0 * count + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, count));
+
+    uint64_t cumulative_count = 0;
+    for (unsigned int i = 0; i < BUCKETS_NUMBER - 1; i++)
+    {
+        cumulative_count += buckets_[i].load(std::memory_order_relaxed);
+        if (cumulative_count >= rank)
+        {
+            return std::min(BucketLowerBound(i + 1) - 1, get_max());
+        }
+    }
+    return get_max();
+}
+
+BT::Metrics::NodeMetrics::NodeMetrics()
+{
+    successes_number = 0;
+    failures_number = 0;
+    running_start_ns = 0;
+    halt_start_ns = 0;
+}
+
+void BT::Metrics::SetEnabled(bool is_enabled)
+{
+    is_enabled_.store(is_enabled);
+}
+
+std::vector<BT::Metrics::NodeReport> BT::Metrics::CollectReport(TreeNode* root)
+{
+    std::vector<NodeReport> report;
+    std::set<TreeNode*> visited_nodes;
+    CollectNodeReport(root, &visited_nodes, &report);
+    return report;
+}
+
+void BT::Metrics::PrintReport(const std::vector<NodeReport>& report, std::ostream& stream)
+{
+    stream << "# latencies in microseconds: count p50 p99 max for tick duration, running time and halt latency"
+           << std::endl;
+    stream << std::left << std::setw(24) << "# node" << std::right
+           << std::setw(10) << "successes" << std::setw(10) << "failures"
+           << std::setw(46) << "tick" << std::setw(46) << "running" << std::setw(46) << "halt" << std::endl;
+
+    for (unsigned int i = 0; i < report.size(); i++)
+    {
+        stream << std::left << std::setw(24) << report[i].name << std::right
+               << std::setw(10) << report[i].successes_number
+               << std::setw(10) << report[i].failures_number;
+        PrintSummary(report[i].tick_duration, stream);
+        PrintSummary(report[i].running_time, stream);
+        PrintSummary(report[i].halt_latency, stream);
+        stream << std::endl;
+    }
+}
+
+bool BT::Metrics::WriteReport(TreeNode* root, const std::string& file_name)
+{
+    std::ofstream file(file_name.c_str());
+    if (!file)
+    {
+        return false;
+    }
+    PrintReport(CollectReport(root), file);
+    return file.good();
+}
@@ -14,21 +14,112 @@
 
 #include <parallel_node.h>
 #include <string>
+#include <algorithm>
+#include <functional>
 
 BT::ParallelNode::ParallelNode(std::string name, int threshold_M) : ControlNode::ControlNode(name)
 {
     threshold_M_ = threshold_M;
     are_children_syncronized_ = true;
+    executor_ = NULL;
+}
+
+BT::ParallelNode::ParallelNode(std::string name, int threshold_M, Executor* executor) : ControlNode::ControlNode(name)
+{
+    threshold_M_ = threshold_M;
+    are_children_syncronized_ = false;
+    executor_ = executor;
 }
 
 BT::ParallelNode::~ParallelNode() {}
 
 BT::ReturnStatus BT::ParallelNode::Tick()
 {
+    if (executor_ != NULL)
+    {
+        return TickConcurrent();
+    }
     if (are_children_syncronized_)
     {
         return TickSync();
     }
+    return TickSequential();
+}
+
+BT::ReturnStatus BT::ParallelNode::TickSync()
+{// when ticking the children, they are suncronized
+    tick_id_ = 0;
+    return TickSequential();
+}
+
+BT::ReturnStatus BT::ParallelNode::TickChild(unsigned int i)
+{
+    DEBUG_STDOUT(get_name() << "TICKING " << children_nodes_[i]->get_name());
+
+    if (children_nodes_[i]->get_type() == BT::ACTION_NODE || children_nodes_[i]->get_type() == BT::YARP_ACTION_NODE)
+    {
+        // 1) If the child i is an action, read its state.
+        // Action nodes runs in another parallel, hence you cannot retrieve the status just by executing it.
+        BT::ReturnStatus child_status = children_nodes_[i]->get_status();
+
+        if (child_status == BT::IDLE || child_status == BT::HALTED)
+        {
+            // 1.1 If the action status is not running, the sequence node sends a tick to it.
+            DEBUG_STDOUT(get_name() << "NEEDS TO TICK " << children_nodes_[i]->get_name());
+            static_cast<BT::ActionNode*>(children_nodes_[i])->SendTick();
+
+            // waits for the tick to arrive to the child (woken up by the child's set_status)
+            child_status = children_nodes_[i]->WaitForTickResponse();
+        }
+        return child_status;
+    }
+    return TickSynchronousChild(children_nodes_[i]);
+}
+
+BT::ReturnStatus BT::ParallelNode::CountChildStatus(unsigned int i, BT::ReturnStatus child_status)
+{
+    switch (child_status)
+    {
+    case BT::SUCCESS:
+        children_nodes_[i]->set_status(BT::IDLE);  // the child goes in idle if it has returned success.
+        if (++success_childred_num_ == threshold_M_)
+        {
+            return BT::SUCCESS;
+        }
+        break;
+    case BT::FAILURE:
+        children_nodes_[i]->set_status(BT::IDLE);  // the child goes in idle if it has returned failure.
+        // == and not >: only one child can make the failures reach the threshold
+        if (++failure_childred_num_ == N_of_children_ - threshold_M_ + 1)
+        {
+            DEBUG_STDOUT("*******PARALLEL" << get_name()
+                         << " FAILED****** failure_childred_num_:" << failure_childred_num_);
+            return BT::FAILURE;
+        }
+        break;
+    case BT::RUNNING:
+        set_status(child_status);
+        break;
+    default:
+        break;
+    }
+    return BT::RUNNING;
+}
+
+BT::ReturnStatus BT::ParallelNode::ReturnTickStatus(BT::ReturnStatus status)
+{
+    if (status != BT::RUNNING)
+    {
+        success_childred_num_ = 0;
+        failure_childred_num_ = 0;
+        HaltChildren(0);  // halts all running children. The execution is done (or hopeless).
+        set_status(status);
+    }
+    return status;
+}
+
+BT::ReturnStatus BT::ParallelNode::TickSequential()
+{
     success_childred_num_ = 0;
     failure_childred_num_ = 0;
     // Vector size initialization. N_of_children_ could change at runtime if you edit the tree
@@ -37,69 +128,87 @@ BT::ReturnStatus BT::ParallelNode::Tick()
     // Routing the tree according to the sequence node's logic:
     for (unsigned int i = 0; i < N_of_children_; i++)
     {
-        DEBUG_STDOUT(get_name() << "TICKING " << children_nodes_[i]->get_name());
-
-        if (children_nodes_[i]->get_type() == BT::ACTION_NODE || children_nodes_[i]->get_type() == BT::YARP_ACTION_NODE  )
+        BT::ReturnStatus status = CountChildStatus(i, TickChild(i));
+        if (status != BT::RUNNING)
         {
-            // 1) If the child i is an action, read its state.
-            // Action nodes runs in another parallel, hence you cannot retrieve the status just by executing it.
-            child_i_status_ = children_nodes_[i]->get_status();
+            return ReturnTickStatus(status);
+        }
+    }
+    return BT::RUNNING;
+}
+
+BT::ReturnStatus BT::ParallelNode::TickConcurrent()
+{
+    success_childred_num_ = 0;
+    failure_childred_num_ = 0;
+    // Vector size initialization. N_of_children_ could change at runtime if you edit the tree
+    N_of_children_ = children_nodes_.size();
+    if (N_of_children_ == 0)
+    {
+        return BT::RUNNING;
+    }
+
+    std::shared_ptr<ForkJoin> fork_join = std::make_shared<ForkJoin>();
+    fork_join->children_number_ = N_of_children_;
+    fork_join->next_child_idx_ = 0;
+    fork_join->done_children_number_ = 0;
+    fork_join->status_ = BT::RUNNING;
+    fork_join->clock_ = BT::GetDefaultClock();
+    fork_join->tick_epoch_ = BT::GetTickEpoch();
+
+    // fork: one helper per child (up to the number of workers), this thread ticks the children too.
+    // If the workers are busy, this thread ticks all the children by itself
+    unsigned int helpers_number = std::min(N_of_children_ - 1, executor_->get_workers_number());
+    for (unsigned int i = 0; i < helpers_number; i++)
+    {
+        fork_join->clock_->BeginActivity();
+        executor_->Submit(std::bind(&ParallelNode::RunHelper, this, fork_join));
+    }
+    TickChildren(this, fork_join);
 
-            if (child_i_status_ == BT::IDLE || child_i_status_ == BT::HALTED)
+    // join
+    {
+        std::unique_lock<std::mutex> UniqueLock(fork_join->mutex_);
+        fork_join->clock_->WaitUntil(UniqueLock, fork_join->condition_variable_,
+                                     std::chrono::steady_clock::time_point::max(),
+                                     [&fork_join, this]() { return fork_join->done_children_number_ >= N_of_children_; });
+    }
+
+    return ReturnTickStatus((BT::ReturnStatus)fork_join->status_.load());
+}
+
+void BT::ParallelNode::TickChildren(ParallelNode* node, std::shared_ptr<ForkJoin> fork_join)
+{
+    unsigned int i;
+    // the node is used only while there are children left, i.e. before the join
+    while ((i = fork_join->next_child_idx_++) < fork_join->children_number_)
+    {
+        if (fork_join->status_ == BT::RUNNING)
+        {
+            BT::ReturnStatus status = node->CountChildStatus(i, node->TickChild(i));
+            if (status != BT::RUNNING)
             {
-                // 1.1 If the action status is not running, the sequence node sends a tick to it.
-                DEBUG_STDOUT(get_name() << "NEEDS TO TICK " << children_nodes_[i]->get_name());
-                children_nodes_[i]->tick_engine.Tick();
-
-                // waits for the tick to arrive to the child
-                do
-                {
-                    child_i_status_ = children_nodes_[i]->get_status();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-                while (child_i_status_ != BT::RUNNING && child_i_status_ != BT::SUCCESS
-                       && child_i_status_ != BT::FAILURE);
+                fork_join->status_ = status;
             }
         }
-        else
-        {
-            child_i_status_ = children_nodes_[i]->Tick();
-        }
-        switch (child_i_status_)
+        // else: the threshold has already been reached, the child is not ticked
+
+        if (++fork_join->done_children_number_ == fork_join->children_number_)
         {
-        case BT::SUCCESS:
-            children_nodes_[i]->set_status(BT::IDLE);  // the child goes in idle if it has returned success.
-            if (++success_childred_num_ == threshold_M_)
-            {
-                success_childred_num_ = 0;
-                failure_childred_num_ = 0;
-                HaltChildren(0);  // halts all running children. The execution is done.
-                set_status(child_i_status_);
-                return child_i_status_;
-            }
-            break;
-        case BT::FAILURE:
-            children_nodes_[i]->set_status(BT::IDLE);  // the child goes in idle if it has returned failure.
-            if (++failure_childred_num_ > N_of_children_- threshold_M_)
-            {
-                DEBUG_STDOUT("*******PARALLEL" << get_name()
-                             << " FAILED****** failure_childred_num_:" << failure_childred_num_);
-
-                success_childred_num_ = 0;
-                failure_childred_num_ = 0;
-                HaltChildren(0);  // halts all running children. The execution is hopeless.
-                set_status(child_i_status_);
-                return child_i_status_;
-            }
-            break;
-        case BT::RUNNING:
-            set_status(child_i_status_);
-            break;
-        default:
-            break;
+            std::lock_guard<std::mutex> LockGuard(fork_join->mutex_);
+            fork_join->condition_variable_.notify_all();
         }
     }
-    return BT::RUNNING;
+}
+
+void BT::ParallelNode::RunHelper(ParallelNode* node, std::shared_ptr<ForkJoin> fork_join)
+{
+    {
+        BT::TickEpochScope epoch(fork_join->tick_epoch_);
+        TickChildren(node, fork_join);
+    }
+    // the helper has been an activity of the clock since it was submitted
+    fork_join->clock_->EndActivity();
 }
 
 void BT::ParallelNode::Halt()
@@ -124,84 +233,3 @@ void BT::ParallelNode::set_threshold_M(unsigned int threshold_M)
 {
     threshold_M_ = threshold_M;
 }
-
-
-
-
-
-BT::ReturnStatus BT::ParallelNode::TickSync()
-{// when ticking the children, they are suncronized
-    tick_id_ = 0;
-
-    success_childred_num_ = 0;
-    failure_childred_num_ = 0;
-    // Vector size initialization. N_of_children_ could change at runtime if you edit the tree
-    N_of_children_ = children_nodes_.size();
-
-    // Routing the tree according to the sequence node's logic:
-    for (unsigned int i = 0; i < N_of_children_; i++)
-    {
-        DEBUG_STDOUT(get_name() << "TICKING " << children_nodes_[i]->get_name());
-
-        if (children_nodes_[i]->get_type() == BT::ACTION_NODE || children_nodes_[i]->get_type() == BT::YARP_ACTION_NODE)
-        {
-            // 1) If the child i is an action, read its state.
-            // Action nodes runs in another parallel, hence you cannot retrieve the status just by executing it.
-            child_i_status_ = children_nodes_[i]->get_status();
-
-            if (child_i_status_ == BT::IDLE || child_i_status_ == BT::HALTED)
-            {
-                // 1.1 If the action status is not running, the sequence node sends a tick to it.
-                DEBUG_STDOUT(get_name() << "NEEDS TO TICK " << children_nodes_[i]->get_name());
-                children_nodes_[i]->tick_engine.Tick();
-
-                // waits for the tick to arrive to the child
-                do
-                {
-                    child_i_status_ = children_nodes_[i]->get_status();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-                while (child_i_status_ != BT::RUNNING && child_i_status_ != BT::SUCCESS
-                       && child_i_status_ != BT::FAILURE);
-            }
-        }
-        else
-        {
-            child_i_status_ = children_nodes_[i]->Tick();
-        }
-        switch (child_i_status_)
-        {
-        case BT::SUCCESS:
-            children_nodes_[i]->set_status(BT::IDLE);  // the child goes in idle if it has returned success.
-            if (++success_childred_num_ == threshold_M_)
-            {
-                success_childred_num_ = 0;
-                failure_childred_num_ = 0;
-                HaltChildren(0);  // halts all running children. The execution is done.
-                set_status(child_i_status_);
-                return child_i_status_;
-            }
-            break;
-        case BT::FAILURE:
-            children_nodes_[i]->set_status(BT::IDLE);  // the child goes in idle if it has returned failure.
-            if (++failure_childred_num_ > N_of_children_- threshold_M_)
-            {
-                DEBUG_STDOUT("*******PARALLEL" << get_name()
-                             << " FAILED****** failure_childred_num_:" << failure_childred_num_);
-
-                success_childred_num_ = 0;
-                failure_childred_num_ = 0;
-                HaltChildren(0);  // halts all running children. The execution is hopeless.
-                set_status(child_i_status_);
-                return child_i_status_;
-            }
-            break;
-        case BT::RUNNING:
-            set_status(child_i_status_);
-            break;
-        default:
-            break;
-        }
-    }
-    return BT::RUNNING;
-}
@@ -3,7 +3,29 @@
 
 PyObject *python_state_,*python_state_2;
 PyObject *python_tick_fn_, *python_halt_fn_, *python_finalize_fn_; //TODO Figure out why if It cannot find Python.h in the header
-     yarp::os::Property* blackboard_ptr_;
+// The blackboard written by the scripts (see SetValueOnBlackboard())
+BT::TypedBlackBoard* python_blackboard_ = NULL;
+
+// Sets the value on the blackboard and wakes the reactive ticks. A value of another type than the one of its key
+// is dropped
+template <typename T>
+static void SetOnBlackboard(BT::TypedBlackBoard* blackboard, const std::string& key, const T& value)
+{
+    if (blackboard == NULL)
+    {
+        return;
+    }
+    try
+    {
+        blackboard->SetByName<T>(key, value);
+    }
+    catch (const BT::BehaviorTreeException& exception)
+    {
+        std::cout << "Cannot set " << key << " on the blackboard: " << exception.what() << std::endl;
+        return;
+    }
+    BT::GetDefaultTickTrigger()->Trigger();
+}
 
 PyObject *
 SetValueOnBlackboard(PyObject *self, PyObject *args)
@@ -15,29 +37,29 @@ SetValueOnBlackboard(PyObject *self, PyObject *args)
     int int_value;
     char *str_value;
     float float_value;
-    bool bool_value;
+    int bool_value;
 
 
     if (PyArg_ParseTuple(args, "si", &key, &int_value))
     {
         std::cout << "*****************Setting Value int **********************" << key << int_value << std::endl;
-        //blackboard_ptr_->put(key,int_value);
-       // blackboard_ptr_->put("z", 30);
-
-
+        SetOnBlackboard<int32_t>(python_blackboard_, key, int_value);
     }
     else if (PyArg_ParseTuple(args, "sf", &key, &float_value))
     {
         std::cout << "*****************Setting Value float**********************" << key << float(float_value) << std::endl;
+        SetOnBlackboard<double>(python_blackboard_, key, float_value);
     }
 
     else if (PyArg_ParseTuple(args, "ss", &key, &str_value))
     {
         std::cout << "*****************Setting Value str **********************" << key << str_value << std::endl;
+        SetOnBlackboard<std::string>(python_blackboard_, key, str_value);
     }
         else if (PyArg_ParseTuple(args, "sp", &key, &bool_value))
     {
         std::cout << "*****************Setting Value bool **********************" << key << bool_value << std::endl;
+        SetOnBlackboard<bool>(python_blackboard_, key, bool_value != 0);
     }
     else
     {
@@ -81,18 +103,34 @@ static struct PyModuleDef blackboard_module = {
 
     void BT::PythonActionNode::WriteOnBlackboard(std::string key, yarp::os::Value value)
     {
-        blackboard_ptr_->put(key,value);
+        if (value.isString())
+        {
+            SetOnBlackboard<std::string>(blackboard_ptr_, key, value.asString());
+        }
+        else if (value.isDouble())
+        {
+            SetOnBlackboard<double>(blackboard_ptr_, key, value.asDouble());
+        }
+        else if (value.isBool())
+        {
+            SetOnBlackboard<bool>(blackboard_ptr_, key, value.asBool());
+        }
+        else if (value.isInt())
+        {
+            SetOnBlackboard<int32_t>(blackboard_ptr_, key, value.asInt());
+        }
     }
 
 
 
 
-BT::PythonActionNode::PythonActionNode(std::string name, std::string filename, yarp::os::Property *blackboard_ptr) : BT::ActionNode::ActionNode(name)
+BT::PythonActionNode::PythonActionNode(std::string name, std::string filename, BT::TypedBlackBoard *blackboard_ptr) : BT::ActionNode::ActionNode(name)
 {
 
     std::cout << "Node created" << std::endl;
     filename_ = filename;
     blackboard_ptr_ = blackboard_ptr;
+    python_blackboard_ = blackboard_ptr;
 
 // blackboard_ptr_->put("x", 10);
 WriteOnBlackboard("y",20);
@@ -0,0 +1,189 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <rcu.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // A thread reading, or that has read, within a read-side section. The records are never deleted:
+    // the record of an exited thread is reused by a new one
+    struct ReaderRecord
+    {
+        // epoch at the beginning of the outermost section in progress, 0 if none
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> is_used;
+        ReaderRecord* next;
+        // accessed only by the owner thread
+        int nesting;
+    };
+
+    struct RetiredObject
+    {
+        void* object;
+        void (*deleter)(void* object);
+        // the global epoch when the object has been retired
+        uint64_t epoch;
+    };
+
+    // once this many objects are retired, Retire() tries to delete them
+    const unsigned int RECLAIM_THRESHOLD = 64;
+
+    std::atomic<uint64_t> global_epoch_(1);
+    std::atomic<ReaderRecord*> readers_(NULL);
+
+    std::mutex& RetiredMutex()
+    {
+        static std::mutex retired_mutex;
+        return retired_mutex;
+    }
+
+    std::vector<RetiredObject>& RetiredObjects()
+    {
+        static std::vector<RetiredObject> retired_objects;
+        return retired_objects;
+    }
+
+    ReaderRecord* AcquireRecord()
+    {
+        for (ReaderRecord* record = readers_.load(std::memory_order_acquire); record != NULL; record = record->next)
+        {
+            bool is_used = false;
+            if (!record->is_used.load(std::memory_order_relaxed)
+                    && record->is_used.compare_exchange_strong(is_used, true, std::memory_order_acquire))
+            {
+                return record;
+            }
+        }
+
+        ReaderRecord* record = new ReaderRecord();
+        record->epoch = 0;
+        record->is_used = true;
+        record->nesting = 0;
+        ReaderRecord* head = readers_.load(std::memory_order_relaxed);
+        do
+        {
+            record->next = head;
+        }
+        while (!readers_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        return record;
+    }
+
+    // Releases the record of the thread when it exits
+    struct ThreadRecord
+    {
+        ThreadRecord() : record(AcquireRecord()) {}
+        ~ThreadRecord() { record->is_used.store(false, std::memory_order_release); }
+
+        ReaderRecord* record;
+    };
+
+    ReaderRecord* GetThreadRecord()
+    {
+        static thread_local ThreadRecord thread_record;
+        return thread_record.record;
+    }
+
+    // Smallest epoch of the read-side sections in progress, UINT64_MAX if none
+    uint64_t GetMinReaderEpoch()
+    {
+        uint64_t min_epoch = UINT64_MAX;
+        for (ReaderRecord* record = readers_.load(std::memory_order_acquire); record != NULL; record = record->next)
+        {
+            uint64_t epoch = record->epoch.load();
+            if (epoch != 0 && epoch < min_epoch)
+            {
+                min_epoch = epoch;
+            }
+        }
+        return min_epoch;
+    }
+
+    // Deletes the objects that no read-side section can be using anymore. Called with the retired mutex held
+    void Reclaim()
+    {
+        uint64_t min_epoch = GetMinReaderEpoch();
+        std::vector<RetiredObject>& retired_objects = RetiredObjects();
+        unsigned int kept_number = 0;
+        for (unsigned int i = 0; i < retired_objects.size(); i++)
+        {
+            // a section that began at the retirement epoch or earlier may have loaded the object
+            if (retired_objects[i].epoch < min_epoch)
+            {
+                retired_objects[i].deleter(retired_objects[i].object);
+            }
+            else
+            {
+                retired_objects[kept_number++] = retired_objects[i];
+            }
+        }
+        retired_objects.resize(kept_number);
+    }
+}
+
+
+BT::Rcu::ReadGuard::ReadGuard()
+{
+    ReaderRecord* record = GetThreadRecord();
+    if (record->nesting++ == 0)
+    {
+        record->epoch.store(global_epoch_.load());
+        // the epoch is published before any object is loaded (see Reclaim())
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+BT::Rcu::ReadGuard::~ReadGuard()
+{
+    ReaderRecord* record = GetThreadRecord();
+    if (--record->nesting == 0)
+    {
+        record->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void BT::Rcu::Retire(void* object, void (*deleter)(void* object))
+{
+    // the readers that begin from now on cannot load the object anymore
+    uint64_t epoch = global_epoch_.fetch_add(1);
+
+    std::lock_guard<std::mutex> LockGuard(RetiredMutex());
+    RetiredObject retired_object;
+    retired_object.object = object;
+    retired_object.deleter = deleter;
+    retired_object.epoch = epoch;
+    RetiredObjects().push_back(retired_object);
+    if (RetiredObjects().size() >= RECLAIM_THRESHOLD)
+    {
+        Reclaim();
+    }
+}
+
+void BT::Rcu::Synchronize()
+{
+    uint64_t epoch = global_epoch_.fetch_add(1);
+    while (GetMinReaderEpoch() <= epoch)
+    {
+        std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> LockGuard(RetiredMutex());
+    Reclaim();
+}
+
+unsigned int BT::Rcu::get_retired_number()
+{
+    std::lock_guard<std::mutex> LockGuard(RetiredMutex());
+    return RetiredObjects().size();
+}
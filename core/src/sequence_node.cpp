@@ -45,17 +45,10 @@ BT::ReturnStatus BT::SequenceNode::Tick()
             {
                 // 1.1) If the action status is not running, the sequence node sends a tick to it.
              //   std::cout << get_name() << "NEEDS TO TICK " << children_nodes_[i]->get_name() << std::endl;
-                children_nodes_[i]->tick_engine.Tick();
-
-                // waits for the tick to arrive to the child
-                do
-                {
-                    child_i_status_ = children_nodes_[i]->get_status();
-                    std::cout << "waiting for return status" << std::endl;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-                while (child_i_status_ != BT::RUNNING && child_i_status_ != BT::SUCCESS
-                       && child_i_status_ != BT::FAILURE);
+                static_cast<BT::ActionNode*>(children_nodes_[i])->SendTick();
+
+                // waits for the tick to arrive to the child (woken up by the child's set_status)
+                child_i_status_ = children_nodes_[i]->WaitForTickResponse();
 
             }
             else
@@ -70,7 +63,7 @@ BT::ReturnStatus BT::SequenceNode::Tick()
 
             // 2) if it's not an action:
             // Send the tick and wait for the response;
-            child_i_status_ = children_nodes_[i]->Tick();
+            child_i_status_ = TickSynchronousChild(children_nodes_[i]);
             children_nodes_[i]->set_status(child_i_status_);
         }
         // Ponderate on which status to send to the parent
@@ -86,7 +79,7 @@ BT::ReturnStatus BT::SequenceNode::Tick()
 
             HaltChildren(i+1);
             set_status(child_i_status_);
-            std::cout << get_name() <<" return status" << child_i_status_ << std::endl;
+            BT_TRACE_EVENT(BT::Trace::TICK_RETURN, get_name(), child_i_status_);
             return child_i_status_;
         }
         else
@@ -99,7 +92,7 @@ BT::ReturnStatus BT::SequenceNode::Tick()
                 // If the  child status is success, and it is the last child to be ticked,
                 // then the sequence has succeeded.
                 set_status(BT::SUCCESS);
-                std::cout << " return status success " << std::endl;
+                BT_TRACE_EVENT(BT::Trace::TICK_RETURN, get_name(), BT::SUCCESS);
                 return BT::SUCCESS;
             }
         }
@@ -0,0 +1,348 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <shared_blackboard.h>
+#include <cerrno>
+#include <new>
+#include <thread>
+#include <signal.h>
+#include <unistd.h>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+namespace
+{
+    // "BTBBSHM" and a NUL
+    const uint64_t SHARED_BLACKBOARD_MAGIC = 0x004d485342425442ULL;
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+                  "the atomics in shared memory must be lock-free (i.e. address-free)");
+    static_assert(sizeof(BT::SharedBlackBoardHeader) <= BT::SharedBlackBoard::SLOTS_OFFSET,
+                  "the header must fit before the slots");
+    static_assert(sizeof(BT::SharedBlackBoardSlot) % sizeof(uint64_t) == 0, "the words of a slot must be aligned");
+
+    // Spins between two checks of whether the owner of a lock is still alive (a system call)
+    const unsigned int LIVENESS_CHECK_PERIOD = 1024;
+
+    uint32_t GetSlotSize(uint32_t value_capacity)
+    {
+        return sizeof(BT::SharedBlackBoardSlot) + value_capacity;
+    }
+
+    // A pid reused by a new process is taken as alive: the lock is then only taken over once that one exits
+    bool IsProcessDead(uint32_t pid)
+    {
+        return kill((pid_t)pid, 0) == -1 && errno == ESRCH;
+    }
+
+    // A spinlock between the processes (their mutexes are not shared), which holds the pid of its owner.
+    // Takes the lock over from an owner that has died
+    void LockForProcess(std::atomic<uint32_t>* lock)
+    {
+        const uint32_t pid = (uint32_t)getpid();
+        uint32_t owner = 0;
+        for (unsigned int spins = 1;
+             !lock->compare_exchange_weak(owner, pid, std::memory_order_acquire, std::memory_order_relaxed); spins++)
+        {
+            // owner is 0 after a spurious failure, a dead owner is replaced by the next exchange
+            if (owner != 0 && !(spins % LIVENESS_CHECK_PERIOD == 0 && IsProcessDead(owner)))
+            {
+                owner = 0;
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+BT::SharedBlackBoard::SharedBlackBoard(const std::string& segment_name, unsigned int keys_capacity,
+                                       unsigned int string_capacity)
+{
+    using namespace boost::interprocess;
+
+    segment_name_ = segment_name;
+    is_owner_ = true;
+
+    // room for a structure, or for the length and the bytes of a string
+    uint32_t value_capacity = std::max<uint32_t>(FIXED_VALUE_MAX_SIZE,
+                                                 sizeof(uint64_t) * (1 + (string_capacity + sizeof(uint64_t) - 1) / sizeof(uint64_t)));
+    try
+    {
+        shared_memory_object::remove(segment_name.c_str());
+        shared_memory_object segment(create_only, segment_name.c_str(), read_write);
+        segment.truncate(SLOTS_OFFSET + (offset_t)keys_capacity * GetSlotSize(value_capacity));
+        region_ = new mapped_region(segment, read_write);
+    }
+    catch (const interprocess_exception& ex)
+    {
+        throw BehaviorTreeException("Cannot create the shared blackboard " + segment_name + ": " + ex.what());
+    }
+
+    // the segment is zero-filled: all the slots are empty, all the sequences 0
+    header_ = new (region_->get_address()) SharedBlackBoardHeader();
+    header_->layout_version = SHARED_BLACKBOARD_LAYOUT_VERSION;
+    header_->keys_capacity = keys_capacity;
+    header_->value_capacity = value_capacity;
+    header_->slot_size = GetSlotSize(value_capacity);
+    header_->keys_number = 0;
+    header_->intern_lock = 0;
+    slots_ = static_cast<char*>(region_->get_address()) + SLOTS_OFFSET;
+    header_->magic.store(SHARED_BLACKBOARD_MAGIC, std::memory_order_release);
+}
+
+BT::SharedBlackBoard::SharedBlackBoard(const std::string& segment_name)
+{
+    using namespace boost::interprocess;
+
+    segment_name_ = segment_name;
+    is_owner_ = false;
+    try
+    {
+        shared_memory_object segment(open_only, segment_name.c_str(), read_write);
+        region_ = new mapped_region(segment, read_write);
+    }
+    catch (const interprocess_exception& ex)
+    {
+        throw BehaviorTreeException("Cannot open the shared blackboard " + segment_name + ": " + ex.what());
+    }
+
+    header_ = static_cast<SharedBlackBoardHeader*>(region_->get_address());
+    slots_ = static_cast<char*>(region_->get_address()) + SLOTS_OFFSET;
+    std::string error;
+    if (region_->get_size() < SLOTS_OFFSET || header_->magic.load(std::memory_order_acquire) != SHARED_BLACKBOARD_MAGIC)
+    {
+        error = "it is not an initialized blackboard";
+    }
+    else if (header_->layout_version != SHARED_BLACKBOARD_LAYOUT_VERSION
+             || header_->slot_size != GetSlotSize(header_->value_capacity))
+    {
+        error = "its layout version is " + std::to_string(header_->layout_version)
+                + ", not " + std::to_string(SHARED_BLACKBOARD_LAYOUT_VERSION);
+    }
+    else if (region_->get_size() < SLOTS_OFFSET + (std::size_t)header_->keys_capacity * header_->slot_size)
+    {
+        error = "it is truncated";
+    }
+    if (!error.empty())
+    {
+        delete region_;
+        throw BehaviorTreeException("Cannot open the shared blackboard " + segment_name + ": " + error);
+    }
+}
+
+BT::SharedBlackBoard::~SharedBlackBoard()
+{
+    delete region_;
+    if (is_owner_)
+    {
+        // the processes that have mapped it keep their mapping
+        boost::interprocess::shared_memory_object::remove(segment_name_.c_str());
+    }
+}
+
+bool BT::SharedBlackBoard::Remove(const std::string& segment_name)
+{
+    return boost::interprocess::shared_memory_object::remove(segment_name.c_str());
+}
+
+BT::SharedBlackBoardSlot* BT::SharedBlackBoard::FindSlot(const std::string& name)
+{
+    unsigned int keys_number = header_->keys_number.load(std::memory_order_acquire);
+    for (unsigned int i = 0; i < keys_number; i++)
+    {
+        SharedBlackBoardSlot* slot = get_slot(i);
+        if (name == slot->name)
+        {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+BT::SharedBlackBoardSlot* BT::SharedBlackBoard::InternSlot(const std::string& name, BlackBoardValueType type,
+                                                           uint32_t value_size)
+{
+    if (name.size() >= SHARED_KEY_NAME_MAX_SIZE)
+    {
+        throw BehaviorTreeException("the key '" + name + "' is longer than "
+                                    + std::to_string(SHARED_KEY_NAME_MAX_SIZE - 1) + " characters");
+    }
+
+    SharedBlackBoardSlot* slot = FindSlot(name);
+    if (slot == NULL)
+    {
+        // a creator that has died has not published its slot, which is then written again
+        LockForProcess(&header_->intern_lock);
+
+        // another process may have created it meanwhile
+        slot = FindSlot(name);
+        unsigned int keys_number = header_->keys_number.load(std::memory_order_relaxed);
+        if (slot == NULL && keys_number < header_->keys_capacity)
+        {
+            slot = get_slot(keys_number);
+            // the name fits, with its NUL
+            std::memcpy(slot->name, name.c_str(), name.size() + 1);
+            slot->type = type;
+            slot->value_size = value_size;
+            header_->keys_number.store(keys_number + 1, std::memory_order_release);
+        }
+        header_->intern_lock.store(0, std::memory_order_release);
+
+        if (slot == NULL)
+        {
+            throw BehaviorTreeException("the shared blackboard " + segment_name_ + " is full ("
+                                        + std::to_string(header_->keys_capacity) + " keys)");
+        }
+    }
+
+    if (slot->type != (uint32_t)type || slot->value_size != value_size)
+    {
+        throw BehaviorTreeException("the key '" + name + "' has been created with another type");
+    }
+    return slot;
+}
+
+uint64_t BT::SharedBlackBoard::BeginWrite(SharedBlackBoardSlot* slot)
+{
+    LockForProcess(&slot->writer_pid);
+    uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    if (sequence & 1)
+    {
+        // the lock has been taken over from a writer that has died within its write: this write ends it,
+        // the readers never get the torn value
+        return sequence - 1;
+    }
+    return Seqlock::BeginWrite(&slot->sequence);
+}
+
+void BT::SharedBlackBoard::EndWrite(SharedBlackBoardSlot* slot, uint64_t sequence)
+{
+    Seqlock::EndWrite(&slot->sequence, sequence + 2);
+    slot->writer_pid.store(0, std::memory_order_release);
+}
+
+uint64_t BT::SharedBlackBoard::BeginRead(SharedBlackBoardSlot* slot)
+{
+    uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    for (unsigned int spins = 1; sequence & 1; spins++)
+    {
+        if (spins % LIVENESS_CHECK_PERIOD == 0)
+        {
+            uint32_t writer_pid = slot->writer_pid.load(std::memory_order_relaxed);
+            if (writer_pid != 0 && IsProcessDead(writer_pid))
+            {
+                throw BehaviorTreeException("the key '" + std::string(slot->name) + "' of the shared blackboard "
+                                            + segment_name_ + " has been left half-written by the process "
+                                            + std::to_string(writer_pid) + ", which has died");
+            }
+        }
+        std::this_thread::yield();
+        sequence = slot->sequence.load(std::memory_order_acquire);
+    }
+    return sequence;
+}
+
+bool BT::SharedBlackBoard::Contains(const std::string& name)
+{
+    return FindSlot(name) != NULL;
+}
+
+std::vector<std::string> BT::SharedBlackBoard::GetNames()
+{
+    std::vector<std::string> names;
+    unsigned int keys_number = header_->keys_number.load(std::memory_order_acquire);
+    for (unsigned int i = 0; i < keys_number; i++)
+    {
+        names.push_back(get_slot(i)->name);
+    }
+    return names;
+}
+
+unsigned int BT::SharedBlackBoard::get_keys_number()
+{
+    return header_->keys_number.load(std::memory_order_acquire);
+}
+
+unsigned int BT::SharedBlackBoard::get_keys_capacity()
+{
+    return header_->keys_capacity;
+}
+
+unsigned int BT::SharedBlackBoard::get_string_capacity()
+{
+    return header_->value_capacity - sizeof(uint64_t);
+}
+
+BT::SharedBlackBoardMirror::SharedBlackBoardMirror(BlackBoardStream* stream, SharedBlackBoard* shared_blackboard)
+{
+    stream_ = stream;
+    shared_blackboard_ = shared_blackboard;
+    subscription_id_ = stream->Subscribe(std::vector<std::string>(1, "*"), 0);
+    skipped_number_ = 0;
+}
+
+BT::SharedBlackBoardMirror::~SharedBlackBoardMirror()
+{
+    stream_->Unsubscribe(subscription_id_);
+}
+
+unsigned int BT::SharedBlackBoardMirror::Update()
+{
+    std::vector<BlackBoardDelta> deltas = stream_->CollectDeltas(subscription_id_);
+    unsigned int copied_number = 0;
+    for (unsigned int i = 0; i < deltas.size(); i++)
+    {
+        const BlackBoardDelta& delta = deltas[i];
+        try
+        {
+            switch (delta.type)
+            {
+            case INT16_VALUE:
+                Copy<int16_t>(delta.name, (int16_t)delta.integer);
+                break;
+            case INT32_VALUE:
+                Copy<int32_t>(delta.name, (int32_t)delta.integer);
+                break;
+            case INT64_VALUE:
+                Copy<int64_t>(delta.name, delta.integer);
+                break;
+            case BYTE_VALUE:
+                Copy<int8_t>(delta.name, (int8_t)delta.integer);
+                break;
+            case DOUBLE_VALUE:
+                Copy<double>(delta.name, delta.real);
+                break;
+            case BOOL_VALUE:
+                Copy<bool>(delta.name, delta.integer != 0);
+                break;
+            case STRING_VALUE:
+                Copy<std::string>(delta.name, delta.text);
+                break;
+            default:
+                // not streamed
+                continue;
+            }
+            copied_number++;
+        }
+        catch (const BehaviorTreeException& ex)
+        {
+            skipped_number_++;
+        }
+    }
+    return copied_number;
+}
+
+uint64_t BT::SharedBlackBoardMirror::get_skipped_number()
+{
+    return skipped_number_;
+}
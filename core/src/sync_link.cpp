@@ -0,0 +1,89 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <sync_link.h>
+#include <exceptions.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+BT::SyncLink::SyncLink(std::string name)
+{
+    name_ = name;
+    participants_number_ = 0;
+    arrived_participants_number_ = 0;
+    tick_id_ = 0;
+}
+
+BT::SyncLink::~SyncLink() {}
+
+void BT::SyncLink::AddParticipant()
+{
+    participants_number_++;
+}
+
+void BT::SyncLink::RemoveParticipant()
+{
+    participants_number_--;
+}
+
+unsigned int BT::SyncLink::get_participants_number()
+{
+    return participants_number_.load(std::memory_order_relaxed);
+}
+
+bool BT::SyncLink::is_tick_id_ready(uint64_t tick_id)
+{
+    return tick_id <= tick_id_.load(std::memory_order_acquire);
+}
+
+void BT::SyncLink::NodeDone(uint64_t tick_id)
+{
+    if (tick_id != tick_id_.load(std::memory_order_acquire))
+    {
+        throw BehaviorTreeException("Sync link '" + name_ + "': a participant is done with the wrong tick");
+    }
+
+    if (arrived_participants_number_.fetch_add(1, std::memory_order_acq_rel) + 1
+            == participants_number_.load(std::memory_order_relaxed))
+    {
+        // last one: the others cannot arrive again before the new tick ID is published
+        arrived_participants_number_.store(0, std::memory_order_relaxed);
+        tick_id_.store(tick_id + 1, std::memory_order_release);
+    }
+}
+
+uint64_t BT::SyncLink::get_tick_id()
+{
+    return tick_id_.load(std::memory_order_acquire);
+}
+
+std::string BT::SyncLink::get_name()
+{
+    return name_;
+}
+
+BT::SyncLink* BT::GetSyncLink(const std::string& name)
+{
+    // taken only when a DecoratorSync is constructed, never while ticking
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::unique_ptr<SyncLink> > registry;
+
+    std::lock_guard<std::mutex> LockGuard(registry_mutex);
+    std::unique_ptr<SyncLink>& link = registry[name];
+    if (!link)
+    {
+        link.reset(new SyncLink(name));
+    }
+    return link.get();
+}
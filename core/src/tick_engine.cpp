@@ -25,8 +25,11 @@ void TickEngine::Wait()
     std::unique_lock<std::mutex> UniqueLock(mutex_);
 
     // If the state is 0 then we have to wait for a signal
-    if (value_ == 0)
+    // (in a loop: a spurious wake up or another waiter may have taken the tick)
+    while (value_ == 0)
+    {
         condition_variable_.wait(UniqueLock);
+    }
 
     // Once here we decrement the state
     value_--;
@@ -44,58 +47,3 @@ void TickEngine::Tick()
     // Notification
     condition_variable_.notify_all();
 }
-
-TickEngine::SyncLink* TickEngine::CreateSyncLink(std::string name)
-{
-    std::vector<std::string>::iterator pos = std::find(sync_link_name_vec_.begin(), sync_link_name_vec_.end(), name);
-
-    if (pos == sync_link_name_vec_.end()) {
-      // the link does not exists, add it
-      sync_link_name_vec_.push_back(name);
-      sync_link_vec_.push_back(new SyncLink(name));
-      return sync_link_vec_.back();
-    }
-    else
-    {
-        return sync_link_vec_.at(distance(sync_link_name_vec_.begin(), pos));
-    }
-
-}
-
-
-TickEngine::SyncLink::SyncLink(std::string name)
-{
-    name_ = name;
-    current_tick_id_ = 0;
-
-}
-
-TickEngine::SyncLink::~SyncLink() {}
-
-
-
-bool TickEngine::SyncLink::is_tick_id_ready(unsigned int tick_id)
-{
-    std::lock_guard<std::mutex> LockGuard(current_tick_id_mutex_);
-
-    return tick_id <= current_tick_id_;
-
-}
-
-void TickEngine::SyncLink::NodeDone(unsigned int tick_id)
-{
-    std::lock_guard<std::mutex> LockGuard(current_tick_id_mutex_);
-
-    if(tick_id != current_tick_id_)
-    {
-        throw std::string("ERROR IN TICK ID");
-    }
-
-    if (++number_of_nodes_done_ == number_of_nodes_)
-    {
-        current_tick_id_++;
-    }
-
-}
-
-
@@ -0,0 +1,296 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <tick_program.h>
+#include <parallel_node.h>
+#include <condition_node.h>
+#include <string>
+
+namespace
+{
+    BT::ReturnStatus TickCondition(BT::TreeNode* leaf)
+    {
+        return static_cast<BT::ConditionNode*>(leaf)->TickOnce();
+    }
+
+    // Same hand-off as the control nodes: the tick is sent only if the action is not already running
+    BT::ReturnStatus TickAction(BT::TreeNode* leaf)
+    {
+        BT::ReturnStatus status = leaf->get_status();
+        if (status == BT::IDLE || status == BT::HALTED)
+        {
+            static_cast<BT::ActionNode*>(leaf)->SendTick();
+            status = leaf->WaitForTickResponse();
+        }
+        if (status == BT::SUCCESS || status == BT::FAILURE)
+        {
+            // the action goes in idle once its parent has read the result
+            leaf->set_status(BT::IDLE);
+        }
+        return status;
+    }
+
+    // Sends the halt request, the action is waited together with the others (see BT::WaitForHaltResponses())
+    void HaltAction(BT::TreeNode* leaf, std::vector<BT::TreeNode*>* halting_actions)
+    {
+        BT::RequestActionHalt(leaf, halting_actions);
+    }
+}
+
+
+BT::TickProgram::TickProgram(TreeNode* root)
+{
+    if (root->DrawType() == BT::ROOT)
+    {
+        std::vector<TreeNode*> children = static_cast<ControlNode*>(root)->GetChildren();
+        if (children.size() != 1)
+        {
+            throw BehaviorTreeException("the root must have exactly one child");
+        }
+        root = children[0];
+    }
+
+    // Breadth-first visit: the children of each node are appended, contiguously, at the end
+    std::vector<TreeNode*> nodes;
+    nodes.push_back(root);
+
+    for (unsigned int i = 0; i < nodes.size(); i++)
+    {
+        TreeNode* node = nodes[i];
+        uint32_t threshold = 0;
+
+        if (node->get_type() == BT::ACTION_NODE || node->get_type() == BT::YARP_ACTION_NODE)
+        {
+            kinds_.push_back(ACTION_KIND);
+            first_children_.push_back(leaves_.size());
+            children_numbers_.push_back(0);
+            leaf_tick_functions_.push_back(&TickAction);
+            leaf_halt_functions_.push_back(&HaltAction);
+            leaves_.push_back(node);
+        }
+        else if (node->get_type() == BT::CONDITION_NODE)
+        {
+            kinds_.push_back(CONDITION_KIND);
+            first_children_.push_back(leaves_.size());
+            children_numbers_.push_back(0);
+            leaf_tick_functions_.push_back(&TickCondition);
+            leaf_halt_functions_.push_back(NULL);
+            leaves_.push_back(node);
+        }
+        else
+        {
+            switch (node->DrawType())
+            {
+            case BT::SEQUENCE:
+                kinds_.push_back(SEQUENCE_KIND);
+                break;
+            case BT::SELECTOR:
+                kinds_.push_back(FALLBACK_KIND);
+                break;
+            case BT::PARALLEL:
+                kinds_.push_back(PARALLEL_KIND);
+                threshold = static_cast<ParallelNode*>(node)->get_threshold_M();
+                break;
+            default:
+                throw BehaviorTreeException("'" + node->get_name() + "' cannot be compiled");
+            }
+
+            std::vector<TreeNode*> children = static_cast<ControlNode*>(node)->GetChildren();
+            first_children_.push_back(nodes.size());
+            children_numbers_.push_back(children.size());
+            nodes.insert(nodes.end(), children.begin(), children.end());
+        }
+        thresholds_.push_back(threshold);
+        statuses_.push_back(BT::IDLE);
+    }
+}
+
+BT::TickProgram::~TickProgram() {}
+
+BT::ReturnStatus BT::TickProgram::Tick()
+{
+    BT::TickEpochScope epoch;
+    return TickNode(0);
+}
+
+void BT::TickProgram::Halt()
+{
+    if (statuses_[0] != BT::RUNNING)
+    {
+        return;
+    }
+    std::vector<TreeNode*> halting_actions;
+    if (kinds_[0] == ACTION_KIND)
+    {
+        HaltAction(leaves_[first_children_[0]], &halting_actions);
+    }
+    else
+    {
+        RequestHaltChildren(0, 0, &halting_actions);
+    }
+    BT::WaitForHaltResponses(halting_actions);
+    statuses_[0] = BT::HALTED;
+}
+
+unsigned int BT::TickProgram::get_nodes_number()
+{
+    return kinds_.size();
+}
+
+BT::ReturnStatus BT::TickProgram::get_status(unsigned int node_idx)
+{
+    return (BT::ReturnStatus)statuses_[node_idx];
+}
+
+BT::ReturnStatus BT::TickProgram::TickNode(uint32_t node_idx)
+{
+    BT::ReturnStatus status;
+
+    switch (kinds_[node_idx])
+    {
+    case SEQUENCE_KIND:
+        status = TickSequence(node_idx);
+        break;
+    case FALLBACK_KIND:
+        status = TickFallback(node_idx);
+        break;
+    case PARALLEL_KIND:
+        status = TickParallel(node_idx);
+        break;
+    default:
+        {
+            uint32_t leaf_idx = first_children_[node_idx];
+            status = leaf_tick_functions_[leaf_idx](leaves_[leaf_idx]);
+        }
+        break;
+    }
+    statuses_[node_idx] = status;
+    return status;
+}
+
+BT::ReturnStatus BT::TickProgram::TickSequence(uint32_t node_idx)
+{
+    uint32_t first_child = first_children_[node_idx];
+    uint32_t children_number = children_numbers_[node_idx];
+
+    for (uint32_t i = 0; i < children_number; i++)
+    {
+        BT::ReturnStatus child_status = TickNode(first_child + i);
+        if (child_status != BT::SUCCESS)
+        {
+            if (child_status == BT::FAILURE)
+            {
+                statuses_[first_child + i] = BT::IDLE;
+            }
+            HaltChildren(node_idx, i + 1);
+            return child_status;
+        }
+        statuses_[first_child + i] = BT::IDLE;
+    }
+    return children_number == 0 ? BT::EXIT : BT::SUCCESS;
+}
+
+BT::ReturnStatus BT::TickProgram::TickFallback(uint32_t node_idx)
+{
+    uint32_t first_child = first_children_[node_idx];
+    uint32_t children_number = children_numbers_[node_idx];
+
+    for (uint32_t i = 0; i < children_number; i++)
+    {
+        BT::ReturnStatus child_status = TickNode(first_child + i);
+        if (child_status != BT::FAILURE)
+        {
+            if (child_status == BT::SUCCESS)
+            {
+                statuses_[first_child + i] = BT::IDLE;
+            }
+            HaltChildren(node_idx, i + 1);
+            return child_status;
+        }
+        statuses_[first_child + i] = BT::IDLE;
+    }
+    return children_number == 0 ? BT::EXIT : BT::FAILURE;
+}
+
+BT::ReturnStatus BT::TickProgram::TickParallel(uint32_t node_idx)
+{
+    uint32_t first_child = first_children_[node_idx];
+    uint32_t children_number = children_numbers_[node_idx];
+    uint32_t threshold_M = thresholds_[node_idx];
+    uint32_t success_children_number = 0;
+    uint32_t failure_children_number = 0;
+
+    for (uint32_t i = 0; i < children_number; i++)
+    {
+        switch (TickNode(first_child + i))
+        {
+        case BT::SUCCESS:
+            statuses_[first_child + i] = BT::IDLE;
+            if (++success_children_number == threshold_M)
+            {
+                HaltChildren(node_idx, 0);  // halts all running children. The execution is done.
+                return BT::SUCCESS;
+            }
+            break;
+        case BT::FAILURE:
+            statuses_[first_child + i] = BT::IDLE;
+            if (++failure_children_number > children_number - threshold_M)
+            {
+                HaltChildren(node_idx, 0);  // halts all running children. The execution is hopeless.
+                return BT::FAILURE;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return BT::RUNNING;
+}
+
+void BT::TickProgram::HaltChildren(uint32_t node_idx, uint32_t child_idx)
+{
+    std::vector<TreeNode*> halting_actions;
+    RequestHaltChildren(node_idx, child_idx, &halting_actions);
+    BT::WaitForHaltResponses(halting_actions);
+}
+
+void BT::TickProgram::RequestHaltChildren(uint32_t node_idx, uint32_t child_idx,
+                                          std::vector<TreeNode*>* halting_actions)
+{
+    uint32_t first_child = first_children_[node_idx];
+    uint32_t children_number = children_numbers_[node_idx];
+
+    for (uint32_t i = child_idx; i < children_number; i++)
+    {
+        uint32_t child = first_child + i;
+        switch (kinds_[child])
+        {
+        case CONDITION_KIND:
+            statuses_[child] = BT::IDLE;
+            break;
+        case ACTION_KIND:
+            leaf_halt_functions_[first_children_[child]](leaves_[first_children_[child]], halting_actions);
+            if (statuses_[child] == BT::RUNNING)
+            {
+                statuses_[child] = BT::HALTED;
+            }
+            break;
+        default:
+            if (statuses_[child] == BT::RUNNING)
+            {
+                RequestHaltChildren(child, 0, halting_actions);
+                statuses_[child] = BT::HALTED;
+            }
+            break;
+        }
+    }
+}
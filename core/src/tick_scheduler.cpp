@@ -0,0 +1,132 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <tick_scheduler.h>
+
+BT::TickScheduler::TickScheduler(std::chrono::microseconds period, OverrunPolicy overrun_policy)
+{
+    clock_ = BT::GetDefaultClock();
+    period_ = period;
+    overrun_policy_ = overrun_policy;
+    is_started_ = false;
+
+    ticks_number_ = 0;
+    overruns_number_ = 0;
+    skipped_ticks_number_ = 0;
+    max_jitter_ = std::chrono::microseconds(0);
+    jitter_histogram_.assign(JITTER_BINS_NUMBER, 0);
+}
+
+BT::TickScheduler::~TickScheduler() {}
+
+void BT::TickScheduler::WaitForNextTick()
+{
+    std::chrono::steady_clock::time_point now = clock_->Now();
+
+    if (!is_started_)
+    {
+        // the schedule starts with the first tick
+        is_started_ = true;
+        next_deadline_ = now;
+    }
+    else if (now > next_deadline_)
+    {
+        // the last tick has ended after the deadline of this one
+        overruns_number_++;
+
+        switch (overrun_policy_)
+        {
+        case SKIP_MISSED_TICKS:
+        {
+            unsigned long missed_ticks_number = (now - next_deadline_) / period_ + 1;
+            next_deadline_ += missed_ticks_number * period_;
+            skipped_ticks_number_ += missed_ticks_number;
+            break;
+        }
+        case STRETCH_PERIOD:
+            next_deadline_ = now;
+            break;
+        case CATCH_UP:
+        default:
+            // the deadline stays in the past: no sleep
+            break;
+        }
+    }
+
+    clock_->SleepUntil(next_deadline_);
+
+    std::chrono::microseconds jitter = std::chrono::duration_cast<std::chrono::microseconds>(
+                clock_->Now() - next_deadline_);
+    if (jitter > max_jitter_)
+    {
+        max_jitter_ = jitter;
+    }
+    unsigned int bin = 0;
+    for (long long jitter_us = jitter.count(); jitter_us > 0 && bin < JITTER_BINS_NUMBER - 1; jitter_us >>= 1)
+    {
+        bin++;
+    }
+    jitter_histogram_[bin]++;
+
+    ticks_number_++;
+    next_deadline_ += period_;
+}
+
+std::chrono::steady_clock::time_point BT::TickScheduler::get_next_deadline()
+{
+    return next_deadline_;
+}
+
+unsigned long BT::TickScheduler::get_ticks_number()
+{
+    return ticks_number_;
+}
+
+unsigned long BT::TickScheduler::get_overruns_number()
+{
+    return overruns_number_;
+}
+
+unsigned long BT::TickScheduler::get_skipped_ticks_number()
+{
+    return skipped_ticks_number_;
+}
+
+std::chrono::microseconds BT::TickScheduler::get_max_jitter()
+{
+    return max_jitter_;
+}
+
+std::vector<unsigned long> BT::TickScheduler::get_jitter_histogram()
+{
+    return jitter_histogram_;
+}
+
+void BT::TickScheduler::PrintStatistics(std::ostream& stream)
+{
+    stream << "ticks: " << ticks_number_
+           << " overruns: " << overruns_number_
+           << " skipped ticks: " << skipped_ticks_number_
+           << " max jitter: " << max_jitter_.count() << " us" << std::endl;
+
+    for (unsigned int i = 0; i < JITTER_BINS_NUMBER; i++)
+    {
+        if (jitter_histogram_[i] > 0 && i < JITTER_BINS_NUMBER - 1)
+        {
+            stream << "  jitter < " << (1L << i) << " us: " << jitter_histogram_[i] << std::endl;
+        }
+        else if (jitter_histogram_[i] > 0)
+        {
+            stream << "  jitter >= " << (1L << (i - 1)) << " us: " << jitter_histogram_[i] << std::endl;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <tick_trigger.h>
+
+BT::TickTrigger::TickTrigger()
+{
+    is_triggered_ = false;
+    triggers_number_ = 0;
+}
+
+BT::TickTrigger::~TickTrigger() {}
+
+void BT::TickTrigger::Trigger()
+{
+    triggers_number_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!is_triggered_.exchange(true))
+    {
+        // taking the mutex guarantees that the waiter is either before its check or already sleeping
+        std::lock_guard<std::mutex> LockGuard(mutex_);
+        condition_variable_.notify_one();
+    }
+}
+
+bool BT::TickTrigger::WaitForTrigger(std::chrono::milliseconds max_wait)
+{
+    {
+        BT::Clock* clock = BT::GetDefaultClock();
+        std::unique_lock<std::mutex> UniqueLock(mutex_);
+        clock->WaitUntil(UniqueLock, condition_variable_, clock->Now() + max_wait,
+                         [this]() { return is_triggered_.load(); });
+    }
+    return is_triggered_.exchange(false);
+}
+
+unsigned long BT::TickTrigger::get_triggers_number()
+{
+    return triggers_number_.load(std::memory_order_relaxed);
+}
+
+BT::TickTrigger* BT::GetDefaultTickTrigger()
+{
+    static TickTrigger default_tick_trigger;
+    return &default_tick_trigger;
+}
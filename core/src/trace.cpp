@@ -0,0 +1,251 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // must be a power of two
+    const uint32_t RING_BUFFER_CAPACITY = 1024;
+
+    // Written only by its thread (head_) and only by the drain (tail_)
+    struct RingBuffer
+    {
+        BT::Trace::Event events_[RING_BUFFER_CAPACITY];
+        std::atomic<uint32_t> head_;
+        std::atomic<uint32_t> tail_;
+        // false once the thread has exited: the drain deletes the buffer when it is empty
+        std::atomic<bool> is_thread_alive_;
+    };
+
+    // Registers the ring buffer of the thread at its first event and releases it when the thread exits
+    struct RingBufferOwner
+    {
+        RingBuffer* buffer_;
+
+        RingBufferOwner() : buffer_(NULL) {}
+        ~RingBufferOwner()
+        {
+            if (buffer_ != NULL)
+            {
+                buffer_->is_thread_alive_.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local RingBufferOwner ring_buffer_owner_;
+
+    std::atomic<uint64_t> dropped_events_number_(0);
+
+    // protects buffers_ (taken only at the first event of a thread and by the drain)
+    std::mutex buffers_mutex_;
+    std::vector<RingBuffer*> buffers_;
+    uint32_t next_thread_idx_ = 0;
+
+    // protects the drain state
+    std::mutex drain_mutex_;
+    std::condition_variable drain_condition_variable_;
+    std::thread drain_thread_;
+    FILE* file_ = NULL;
+    bool stop_ = false;
+
+    RingBuffer* RegisterThread()
+    {
+        RingBuffer* buffer = new RingBuffer();
+        buffer->head_ = 0;
+        buffer->tail_ = 0;
+        buffer->is_thread_alive_ = true;
+
+        std::lock_guard<std::mutex> LockGuard(buffers_mutex_);
+        for (uint32_t i = 0; i < RING_BUFFER_CAPACITY; i++)
+        {
+            buffer->events_[i].thread_idx = next_thread_idx_;
+        }
+        next_thread_idx_++;
+        buffers_.push_back(buffer);
+        return buffer;
+    }
+
+    // Writes the pending events of every buffer. Called only by the drain thread (or by Stop() once it has exited)
+    void DrainBuffers()
+    {
+        std::lock_guard<std::mutex> LockGuard(buffers_mutex_);
+
+        for (unsigned int i = 0; i < buffers_.size(); )
+        {
+            RingBuffer* buffer = buffers_[i];
+            // read before head_: if the thread is dead, head_ is final
+            bool is_thread_alive = buffer->is_thread_alive_.load(std::memory_order_acquire);
+            uint32_t tail = buffer->tail_.load(std::memory_order_relaxed);
+            uint32_t head = buffer->head_.load(std::memory_order_acquire);
+
+            for (; tail != head; tail++)
+            {
+                fwrite(&buffer->events_[tail & (RING_BUFFER_CAPACITY - 1)], sizeof(BT::Trace::Event), 1, file_);
+            }
+            buffer->tail_.store(tail, std::memory_order_release);
+
+            if (!is_thread_alive)
+            {
+                delete buffer;
+                buffers_.erase(buffers_.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        fflush(file_);
+    }
+
+    void DrainLoop(unsigned int drain_period_milliseconds)
+    {
+        std::unique_lock<std::mutex> UniqueLock(drain_mutex_);
+        while (!stop_)
+        {
+            drain_condition_variable_.wait_for(UniqueLock, std::chrono::milliseconds(drain_period_milliseconds));
+            DrainBuffers();
+        }
+    }
+}
+
+
+std::atomic<bool> BT::Trace::is_running_flag(false);
+
+void BT::Trace::Record(EventType type, const std::string& text, int value)
+{
+    if (!BT::Trace::is_running_flag.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    RingBuffer* buffer = ring_buffer_owner_.buffer_;
+    if (buffer == NULL)
+    {
+        buffer = RegisterThread();
+        ring_buffer_owner_.buffer_ = buffer;
+    }
+
+    uint32_t head = buffer->head_.load(std::memory_order_relaxed);
+    if (head - buffer->tail_.load(std::memory_order_acquire) == RING_BUFFER_CAPACITY)
+    {
+        // the drain is late, the event is lost
+        dropped_events_number_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event& event = buffer->events_[head & (RING_BUFFER_CAPACITY - 1)];
+    event.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    event.type = type;
+    event.value = value;
+    size_t text_length = std::min(text.size(), sizeof(event.text) - 1);
+    memcpy(event.text, text.data(), text_length);
+    event.text[text_length] = '\0';
+
+    // publishes the event to the drain
+    buffer->head_.store(head + 1, std::memory_order_release);
+}
+
+bool BT::Trace::Start(const std::string& file_name, unsigned int drain_period_milliseconds)
+{
+    std::lock_guard<std::mutex> LockGuard(drain_mutex_);
+    if (file_ != NULL)
+    {
+        return false;
+    }
+
+    file_ = fopen(file_name.c_str(), "wb");
+    if (file_ == NULL)
+    {
+        return false;
+    }
+
+    const char magic[8] = {'B', 'T', 'T', 'R', 'A', 'C', 'E', '1'};
+    uint32_t event_size = sizeof(Event);
+    fwrite(magic, sizeof(magic), 1, file_);
+    fwrite(&event_size, sizeof(event_size), 1, file_);
+
+    stop_ = false;
+    drain_thread_ = std::thread(DrainLoop, drain_period_milliseconds);
+    BT::Trace::is_running_flag.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void BT::Trace::Stop()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(drain_mutex_);
+        if (file_ == NULL)
+        {
+            return;
+        }
+        BT::Trace::is_running_flag.store(false, std::memory_order_relaxed);
+        stop_ = true;
+    }
+    drain_condition_variable_.notify_all();
+    drain_thread_.join();
+
+    std::lock_guard<std::mutex> LockGuard(drain_mutex_);
+    // the events recorded while the drain was stopping
+    DrainBuffers();
+    fclose(file_);
+    file_ = NULL;
+}
+
+uint64_t BT::Trace::get_dropped_events_number()
+{
+    return dropped_events_number_.load(std::memory_order_relaxed);
+}
+
+const char* BT::Trace::EventTypeName(EventType type)
+{
+    switch (type)
+    {
+    case MESSAGE:
+        return "MESSAGE";
+    case SET_STATUS:
+        return "SET_STATUS";
+    case HALT:
+        return "HALT";
+    case HALT_CHILD:
+        return "HALT_CHILD";
+    case NO_NEED_TO_HALT:
+        return "NO_NEED_TO_HALT";
+    case TICK_RETURN:
+        return "TICK_RETURN";
+    case REQUEST_TICK:
+        return "REQUEST_TICK";
+    case TICK_REQUESTED:
+        return "TICK_REQUESTED";
+    case REQUEST_HALT:
+        return "REQUEST_HALT";
+    case HALT_REQUESTED:
+        return "HALT_REQUESTED";
+    case HALT_DEADLINE_MISSED:
+        return "HALT_DEADLINE_MISSED";
+    case EXECUTOR_SATURATED:
+        return "EXECUTOR_SATURATED";
+    default:
+        return "UNKNOWN";
+    }
+}
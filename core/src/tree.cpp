@@ -20,25 +20,27 @@ int main(int argc, char **argv)
     try
     {
         int TickPeriod_milliseconds = 1000;
+        // owns the nodes
+        BT::BehaviorTree tree;
 
-        BT::ActionTestNode* action1 = new BT::ActionTestNode("Action 1");
-        // BT::ConditionTestNode* condition1 = new BT::ConditionTestNode("Condition 1");  // commented-out as unused
-        BT:: SequenceNode* sequence1 = new BT::SequenceNode("seq1");
+        BT::ActionTestNode* action1 = tree.CreateNode<BT::ActionTestNode>("Action 1");
+        // BT::ConditionTestNode* condition1 = tree.CreateNode<BT::ConditionTestNode>("Condition 1");  // commented-out as unused
+        BT::SequenceNode* sequence1 = tree.CreateNode<BT::SequenceNode>("seq1");
 
 
-        BT::ActionTestNode* action2 = new BT::ActionTestNode("Action 2");
-        BT::ConditionTestNode* condition2 = new BT::ConditionTestNode("Condition 2");
-        BT:: SequenceNode* sequence2 = new BT::SequenceNode("seq1");
+        BT::ActionTestNode* action2 = tree.CreateNode<BT::ActionTestNode>("Action 2");
+        BT::ConditionTestNode* condition2 = tree.CreateNode<BT::ConditionTestNode>("Condition 2");
+        BT::SequenceNode* sequence2 = tree.CreateNode<BT::SequenceNode>("seq1");
 
-        BT::ActionTestNode* action3 = new BT::ActionTestNode("Action 3");
-        BT::ConditionTestNode* condition3 = new BT::ConditionTestNode("Condition 3");
-        BT:: SequenceNode* sequence3 = new BT::SequenceNode("seq1");
+        BT::ActionTestNode* action3 = tree.CreateNode<BT::ActionTestNode>("Action 3");
+        BT::ConditionTestNode* condition3 = tree.CreateNode<BT::ConditionTestNode>("Condition 3");
+        BT::SequenceNode* sequence3 = tree.CreateNode<BT::SequenceNode>("seq1");
 
 
         // Commented-out as unused variables
-        // BT::ActionTestNode* action4 = new BT::ActionTestNode("Action 4");
-        // BT::ConditionTestNode* condition4 = new BT::ConditionTestNode("Condition 4");
-        // BT:: SequenceNode* sequence4 = new BT::SequenceNode("seq1");
+        // BT::ActionTestNode* action4 = tree.CreateNode<BT::ActionTestNode>("Action 4");
+        // BT::ConditionTestNode* condition4 = tree.CreateNode<BT::ConditionTestNode>("Condition 4");
+        // BT::SequenceNode* sequence4 = tree.CreateNode<BT::SequenceNode>("seq1");
 
 
         sequence1->AddChild(condition2);
@@ -0,0 +1,248 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <tree_arena.h>
+#include <action_node.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace
+{
+    std::string TypeName(const std::type_info& type)
+    {
+#ifdef __GNUG__
+        int status;
+        char* demangled_name = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+        if (status == 0)
+        {
+            std::string type_name(demangled_name);
+            std::free(demangled_name);
+            return type_name;
+        }
+#endif
+        return type.name();
+    }
+}
+
+BT::TreeArena::TreeArena(size_t block_size)
+{
+    block_size_ = block_size;
+    next_ = NULL;
+    end_ = NULL;
+    allocated_bytes_ = 0;
+}
+
+BT::TreeArena::~TreeArena()
+{
+    for (unsigned int i = 0; i < blocks_.size(); i++)
+    {
+        ::operator delete(blocks_[i]);
+    }
+}
+
+void* BT::TreeArena::Allocate(size_t size, size_t alignment)
+{
+    uintptr_t address = (reinterpret_cast<uintptr_t>(next_) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+    if (next_ == NULL || address + size > reinterpret_cast<uintptr_t>(end_))
+    {
+        // the rest of the current block is wasted
+        size_t new_block_size = std::max(block_size_, size + alignment);
+        char* block = static_cast<char*>(::operator new(new_block_size));
+        blocks_.push_back(block);
+        next_ = block;
+        end_ = block + new_block_size;
+        address = (reinterpret_cast<uintptr_t>(next_) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    next_ = reinterpret_cast<char*>(address + size);
+    allocated_bytes_ += size;
+    return reinterpret_cast<void*>(address);
+}
+
+size_t BT::TreeArena::get_allocated_bytes()
+{
+    return allocated_bytes_;
+}
+
+unsigned int BT::TreeArena::get_blocks_number()
+{
+    return blocks_.size();
+}
+
+
+BT::BehaviorTree::BehaviorTree(size_t arena_block_size) : arena_(arena_block_size)
+{
+    root_ = NULL;
+    is_shut_down_ = false;
+}
+
+BT::BehaviorTree::~BehaviorTree()
+{
+    Shutdown();
+
+    // in reverse order of creation, as automatic objects (the nodes do not touch each other when destroyed)
+    for (unsigned int i = nodes_.size(); i > 0; i--)
+    {
+        nodes_[i - 1].destroy(nodes_[i - 1].node);
+    }
+    // the arena releases its blocks
+}
+
+void BT::BehaviorTree::set_root(TreeNode* root)
+{
+    root_ = root;
+}
+
+BT::TreeNode* BT::BehaviorTree::get_root()
+{
+    return root_;
+}
+
+void BT::BehaviorTree::RequestHalt()
+{
+    for (unsigned int i = 0; i < nodes_.size(); i++)
+    {
+        TreeNode* node = nodes_[i].node;
+        if ((node->get_type() == BT::ACTION_NODE || node->get_type() == BT::YARP_ACTION_NODE)
+                && node->get_status() == BT::RUNNING && !node->is_halt_requested())
+        {
+            if (node->get_type() == BT::YARP_ACTION_NODE)
+            {
+                static_cast<ActionNode*>(node)->SendHalt();
+            }
+            else
+            {
+                node->halt_requested(true);
+            }
+        }
+    }
+}
+
+void BT::BehaviorTree::Shutdown()
+{
+    if (is_shut_down_)
+    {
+        return;
+    }
+    is_shut_down_ = true;
+
+    // 1) all the halt requests, the running actions stop concurrently
+    RequestHalt();
+    std::vector<ActionNode*> actions;
+    for (unsigned int i = 0; i < nodes_.size(); i++)
+    {
+        TreeNode* node = nodes_[i].node;
+        if (node->get_type() == BT::ACTION_NODE || node->get_type() == BT::YARP_ACTION_NODE)
+        {
+            actions.push_back(static_cast<ActionNode*>(node));
+        }
+    }
+
+    // 2) the executor tasks may still be using the nodes after their last status change:
+    // they are waited until they have returned (in real time, a VirtualClock moves on with the tasks)
+    for (unsigned int i = 0; i < actions.size(); i++)
+    {
+        actions[i]->WaitForTickReturn();
+    }
+
+    // 3) the nodes that still run a thread of their own
+    for (unsigned int i = 0; i < nodes_.size(); i++)
+    {
+        nodes_[i].node->JoinThread();
+    }
+}
+
+bool BT::BehaviorTree::IsQuiescent()
+{
+    for (unsigned int i = 0; i < nodes_.size(); i++)
+    {
+        TreeNode* node = nodes_[i].node;
+        if (node->get_type() == BT::ACTION_NODE || node->get_type() == BT::YARP_ACTION_NODE)
+        {
+            if (node->get_status() == BT::RUNNING || static_cast<ActionNode*>(node)->is_tick_in_flight())
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+unsigned int BT::BehaviorTree::get_nodes_number()
+{
+    return nodes_.size();
+}
+
+size_t BT::BehaviorTree::get_allocated_bytes()
+{
+    return arena_.get_allocated_bytes();
+}
+
+std::vector<BT::NodeTypeMemory> BT::BehaviorTree::GetMemoryReport()
+{
+    std::vector<NodeTypeMemory> report;
+    std::vector<const std::type_info*> types;
+
+    for (unsigned int i = 0; i < nodes_.size(); i++)
+    {
+        unsigned int type_idx = 0;
+        while (type_idx < types.size() && *types[type_idx] != *nodes_[i].type)
+        {
+            type_idx++;
+        }
+        if (type_idx == types.size())
+        {
+            NodeTypeMemory type_memory;
+            type_memory.type_name = TypeName(*nodes_[i].type);
+            type_memory.nodes_number = 0;
+            type_memory.node_size = nodes_[i].size;
+            type_memory.side_tables_bytes = 0;
+            report.push_back(type_memory);
+            types.push_back(nodes_[i].type);
+        }
+        report[type_idx].nodes_number++;
+        report[type_idx].side_tables_bytes += nodes_[i].node->get_side_tables_size();
+    }
+    return report;
+}
+
+void BT::BehaviorTree::PrintMemoryReport(std::ostream& stream)
+{
+    std::vector<NodeTypeMemory> report = GetMemoryReport();
+    unsigned int nodes_number = 0;
+    size_t node_bytes = 0;
+    size_t side_tables_bytes = 0;
+
+    stream << std::left << std::setw(32) << "node type" << std::right
+           << std::setw(8) << "nodes" << std::setw(12) << "bytes/node"
+           << std::setw(14) << "node bytes" << std::setw(14) << "side tables" << std::endl;
+    for (unsigned int i = 0; i < report.size(); i++)
+    {
+        stream << std::left << std::setw(32) << report[i].type_name << std::right
+               << std::setw(8) << report[i].nodes_number << std::setw(12) << report[i].node_size
+               << std::setw(14) << report[i].nodes_number * report[i].node_size
+               << std::setw(14) << report[i].side_tables_bytes << std::endl;
+        nodes_number += report[i].nodes_number;
+        node_bytes += report[i].nodes_number * report[i].node_size;
+        side_tables_bytes += report[i].side_tables_bytes;
+    }
+    stream << std::left << std::setw(32) << "total" << std::right
+           << std::setw(8) << nodes_number << std::setw(12) << ""
+           << std::setw(14) << node_bytes << std::setw(14) << side_tables_bytes << std::endl;
+}
@@ -13,81 +13,244 @@
 #include <tree_node.h>
 #include <string>
 
-BT::TreeNode::TreeNode(std::string name) : tick_engine(0)
+BT::TreeNode::TreeNode(std::string name)
 {
     // Initialization
     name_ = name;
-    is_state_updated_ = false;
-    is_halt_requested_ = false;
-    set_status(BT::IDLE);
+    status_word_ = BT::IDLE | (BT::IDLE << BT::STATUS_WORD_COLOR_SHIFT);
+    waiters_number_ = 0;
+    metrics_ = NULL;
+    wait_state_ = NULL;
+    draw_state_ = NULL;
+    thread_state_ = NULL;
 }
 
-BT::TreeNode::~TreeNode() {}
+BT::TreeNode::~TreeNode()
+{
+    delete metrics_.load();
+    delete wait_state_.load();
+    delete draw_state_;
+    delete thread_state_;
+}
 
 void BT::TreeNode::set_status(ReturnStatus new_status)
 {
+    BT_TRACE_EVENT(BT::Trace::SET_STATUS, get_name(), new_status);
 
+    uint32_t old_word = status_word_.load(std::memory_order_relaxed);
+    uint32_t new_word;
+    do
+    {
+        new_word = (old_word & ~BT::STATUS_WORD_STATUS_MASK) | new_status;
+        if (new_status != BT::IDLE)
+        {
+            new_word = (new_word & ~BT::STATUS_WORD_COLOR_MASK) | (new_status << BT::STATUS_WORD_COLOR_SHIFT);
+        }
+    }
+    while (!status_word_.compare_exchange_weak(old_word, new_word));
 
-    if (new_status != BT::IDLE)
+    if (BT::Metrics::IsEnabled())
     {
-        set_color_status(new_status);
+        RecordStatusChange((BT::ReturnStatus)(old_word & BT::STATUS_WORD_STATUS_MASK), new_status);
     }
+    NotifyStatusChange();
+}
 
-    // Lock acquistion
-    std::unique_lock<std::mutex> UniqueLock(state_mutex_);
-    std::cout << get_name() << " is setting its status to " << new_status <<std::endl;
+bool BT::TreeNode::compare_and_set_status(ReturnStatus expected_status, ReturnStatus new_status)
+{
+    uint32_t old_word = status_word_.load(std::memory_order_relaxed);
+    uint32_t new_word;
+    do
+    {
+        if ((old_word & BT::STATUS_WORD_STATUS_MASK) != (uint32_t)expected_status)
+        {
+            return false;
+        }
+        new_word = (old_word & ~BT::STATUS_WORD_STATUS_MASK) | new_status;
+        if (new_status != BT::IDLE)
+        {
+            new_word = (new_word & ~BT::STATUS_WORD_COLOR_MASK) | (new_status << BT::STATUS_WORD_COLOR_SHIFT);
+        }
+    }
+    while (!status_word_.compare_exchange_weak(old_word, new_word));
 
-    // state_ update
-    status_ = new_status;
+    if (BT::Metrics::IsEnabled())
+    {
+        RecordStatusChange(expected_status, new_status);
+    }
+    NotifyStatusChange();
+    return true;
 }
 
 BT::ReturnStatus BT::TreeNode::get_status()
 {
-    // Lock acquistion
+    return (BT::ReturnStatus)(status_word_.load(std::memory_order_acquire) & BT::STATUS_WORD_STATUS_MASK);
+}
 
+void BT::TreeNode::NotifyStatusChange()
+{
+    // The status word is updated with a sequentially consistent CAS before reading waiters_number_, and
+    // the waiters increment waiters_number_ before reading the status: at least one of the two sees the other.
+    // A waiter allocates the wait state before incrementing waiters_number_, hence it is not NULL here.
+    if (waiters_number_.load() > 0)
+    {
+        NodeWaitState* wait_state = wait_state_.load();
+        // taking the mutex guarantees that the waiter is either before its check or already sleeping
+        std::lock_guard<std::mutex> LockGuard(wait_state->mutex);
+        wait_state->condition_variable.notify_all();
+    }
+}
 
+BT::ReturnStatus BT::TreeNode::WaitForTickResponse()
+{
+    return WaitForStatus((1 << BT::RUNNING) | (1 << BT::SUCCESS) | (1 << BT::FAILURE));
+}
 
-    std::lock_guard<std::mutex> LockGuard(state_mutex_);
-    std::cout << get_name() << " status is " << status_ <<std::endl;
+BT::ReturnStatus BT::TreeNode::WaitForHaltResponse()
+{
+    return WaitForStatus((1 << BT::HALTED) | (1 << BT::IDLE));
+}
 
-    return status_;
+BT::ReturnStatus BT::TreeNode::WaitForHaltResponse(std::chrono::steady_clock::time_point deadline)
+{
+    return WaitForStatus((1 << BT::HALTED) | (1 << BT::IDLE), deadline);
 }
 
-BT::ReturnStatus BT::TreeNode::get_color_status()
+BT::ReturnStatus BT::TreeNode::WaitForStatus(uint32_t status_mask, std::chrono::steady_clock::time_point deadline)
 {
-    // Lock acquistion
-    std::lock_guard<std::mutex> LockGuard(color_state_mutex_);
+    BT::ReturnStatus status = get_status();
+    if (status_mask & (1 << status))
+    {
+        return status;
+    }
 
-    return color_status_;
+    NodeWaitState* wait_state = this->wait_state();
+    waiters_number_++;
+    {
+        // Lock acquistion (need a unique lock for the condition variable usage)
+        std::unique_lock<std::mutex> UniqueLock(wait_state->mutex);
+        BT::GetDefaultClock()->WaitUntil(UniqueLock, wait_state->condition_variable, deadline,
+                                         [this, status_mask]() { return (status_mask & (1 << get_status())) != 0; });
+        status = get_status();
+    }
+    waiters_number_--;
+
+    return status;
+}
+
+BT::ReturnStatus BT::TreeNode::get_color_status()
+{
+    return (BT::ReturnStatus)((status_word_.load(std::memory_order_acquire) & BT::STATUS_WORD_COLOR_MASK)
+                              >> BT::STATUS_WORD_COLOR_SHIFT);
 }
 
 void BT::TreeNode::set_color_status(ReturnStatus new_color_status)
 {
-    // Lock acquistion
-    std::lock_guard<std::mutex> LockGuard(color_state_mutex_);
-    // state_ update
-    color_status_ = new_color_status;
+    uint32_t old_word = status_word_.load(std::memory_order_relaxed);
+    uint32_t new_word;
+    do
+    {
+        new_word = (old_word & ~BT::STATUS_WORD_COLOR_MASK) | (new_color_status << BT::STATUS_WORD_COLOR_SHIFT);
+    }
+    while (!status_word_.compare_exchange_weak(old_word, new_word, std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+BT::NodeWaitState* BT::TreeNode::wait_state()
+{
+    BT::NodeWaitState* wait_state = wait_state_.load();
+    if (wait_state == NULL)
+    {
+        // two threads may race here: the loser deletes its copy
+        BT::NodeWaitState* new_wait_state = new BT::NodeWaitState();
+        if (wait_state_.compare_exchange_strong(wait_state, new_wait_state))
+        {
+            wait_state = new_wait_state;
+        }
+        else
+        {
+            delete new_wait_state;
+        }
+    }
+    return wait_state;
+}
+
+BT::NodeDrawState* BT::TreeNode::draw_state()
+{
+    if (draw_state_ == NULL)
+    {
+        draw_state_ = new BT::NodeDrawState();
+    }
+    return draw_state_;
 }
 
 float BT::TreeNode::get_x_pose()
 {
-    return x_pose_;
+    return draw_state_ == NULL ? 0 : draw_state_->x_pose;
 }
 
 void BT::TreeNode::set_x_pose(float x_pose)
 {
-    x_pose_ = x_pose;
+    draw_state()->x_pose = x_pose;
 }
 
 
 float BT::TreeNode::get_x_shift()
 {
-    return x_shift_;
+    return draw_state_ == NULL ? 0 : draw_state_->x_shift;
 }
 
 void BT::TreeNode::set_x_shift(float x_shift)
 {
-    x_shift_ = x_shift;
+    draw_state()->x_shift = x_shift;
+}
+
+std::thread& BT::TreeNode::get_thread()
+{
+    if (thread_state_ == NULL)
+    {
+        thread_state_ = new BT::NodeThreadState();
+    }
+    return thread_state_->thread;
+}
+
+TickEngine& BT::TreeNode::get_tick_engine()
+{
+    if (thread_state_ == NULL)
+    {
+        thread_state_ = new BT::NodeThreadState();
+    }
+    return thread_state_->tick_engine;
+}
+
+void BT::TreeNode::JoinThread()
+{
+    if (thread_state_ != NULL && thread_state_->thread.joinable())
+    {
+        thread_state_->thread.join();
+    }
+}
+
+size_t BT::TreeNode::get_side_tables_size()
+{
+    size_t size = 0;
+    if (metrics_.load() != NULL)
+    {
+        size += sizeof(BT::Metrics::NodeMetrics);
+    }
+    if (wait_state_.load() != NULL)
+    {
+        size += sizeof(BT::NodeWaitState);
+    }
+    if (draw_state_ != NULL)
+    {
+        size += sizeof(BT::NodeDrawState);
+    }
+    if (thread_state_ != NULL)
+    {
+        size += sizeof(BT::NodeThreadState);
+    }
+    return size;
 }
 
 void BT::TreeNode::set_name(std::string new_name)
@@ -95,7 +258,7 @@ void BT::TreeNode::set_name(std::string new_name)
     name_ = new_name;
 }
 
-std::string BT::TreeNode::get_name()
+const std::string& BT::TreeNode::get_name()
 {
     return name_;
 }
@@ -123,12 +286,121 @@ void BT::TreeNode::Finalize()
 
 bool BT::TreeNode::is_halt_requested()
 {
-    std::lock_guard<std::mutex> LockGuard(is_halt_requested_mutex_);
-    return is_halt_requested_;
+    return (status_word_.load(std::memory_order_acquire) & BT::STATUS_WORD_HALT_REQUESTED) != 0;
 }
 
 void BT::TreeNode::halt_requested(bool is_halt_requested)
 {
-    std::lock_guard<std::mutex> LockGuard(is_halt_requested_mutex_);
-    is_halt_requested_ = is_halt_requested;
+    if (is_halt_requested)
+    {
+        if (BT::Metrics::IsEnabled())
+        {
+            RecordHaltStart();
+        }
+        status_word_.fetch_or(BT::STATUS_WORD_HALT_REQUESTED, std::memory_order_release);
+    }
+    else
+    {
+        status_word_.fetch_and(~BT::STATUS_WORD_HALT_REQUESTED, std::memory_order_release);
+    }
+}
+
+void BT::TreeNode::set_halted()
+{
+    uint32_t old_word = status_word_.load(std::memory_order_relaxed);
+    uint32_t new_word;
+    do
+    {
+        new_word = (old_word & ~(BT::STATUS_WORD_STATUS_MASK | BT::STATUS_WORD_COLOR_MASK | BT::STATUS_WORD_HALT_REQUESTED))
+                | BT::HALTED | (BT::HALTED << BT::STATUS_WORD_COLOR_SHIFT);
+    }
+    while (!status_word_.compare_exchange_weak(old_word, new_word));
+
+    if (BT::Metrics::IsEnabled())
+    {
+        RecordStatusChange((BT::ReturnStatus)(old_word & BT::STATUS_WORD_STATUS_MASK), BT::HALTED);
+    }
+    NotifyStatusChange();
+}
+
+BT::Metrics::NodeMetrics* BT::TreeNode::get_metrics()
+{
+    return metrics_.load(std::memory_order_acquire);
+}
+
+BT::Metrics::NodeMetrics* BT::TreeNode::metrics()
+{
+    BT::Metrics::NodeMetrics* metrics = metrics_.load(std::memory_order_acquire);
+    if (metrics == NULL)
+    {
+        // two threads may race here: the loser deletes its copy
+        BT::Metrics::NodeMetrics* new_metrics = new BT::Metrics::NodeMetrics();
+        if (metrics_.compare_exchange_strong(metrics, new_metrics, std::memory_order_acq_rel))
+        {
+            metrics = new_metrics;
+        }
+        else
+        {
+            delete new_metrics;
+        }
+    }
+    return metrics;
+}
+
+void BT::TreeNode::RecordTickDuration(int64_t duration_ns)
+{
+    metrics()->tick_duration.Record(duration_ns);
+}
+
+void BT::TreeNode::RecordHaltStart()
+{
+    int64_t expected_start_ns = 0;
+    // the first request counts, a halt already in progress is not restarted
+    metrics()->halt_start_ns.compare_exchange_strong(expected_start_ns, BT::Metrics::NowNanoseconds(),
+                                                     std::memory_order_relaxed);
+}
+
+void BT::TreeNode::RecordStatusChange(ReturnStatus old_status, ReturnStatus new_status)
+{
+    if (old_status == new_status)
+    {
+        return;
+    }
+
+    BT::Metrics::NodeMetrics* node_metrics = metrics();
+    int64_t now_ns = BT::Metrics::NowNanoseconds();
+
+    if (new_status == BT::RUNNING)
+    {
+        node_metrics->running_start_ns.store(now_ns, std::memory_order_relaxed);
+    }
+    else if (old_status == BT::RUNNING)
+    {
+        int64_t running_start_ns = node_metrics->running_start_ns.exchange(0, std::memory_order_relaxed);
+        if (running_start_ns != 0)
+        {
+            node_metrics->running_time.Record(now_ns - running_start_ns);
+        }
+    }
+
+    switch (new_status)
+    {
+    case BT::SUCCESS:
+        node_metrics->successes_number.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case BT::FAILURE:
+        node_metrics->failures_number.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case BT::HALTED:
+    {
+        int64_t halt_start_ns = node_metrics->halt_start_ns.exchange(0, std::memory_order_relaxed);
+        if (halt_start_ns != 0)
+        {
+            node_metrics->halt_latency.Record(now_ns - halt_start_ns);
+        }
+        break;
+    }
+    default:
+        break;
+    }
 }
@@ -0,0 +1,711 @@
+/* Copyright (C) 2015-2017 Michele Colledanchise - All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <typed_blackboard.h>
+#include <blackboard_journal.h>
+#include <algorithm>
+#include <map>
+
+BT::TypedBlackBoard::TypedBlackBoard()
+{
+    is_change_notified_ = false;
+    tick_trigger_ = GetDefaultTickTrigger();
+    journal_ = NULL;
+}
+
+BT::TypedBlackBoard::~TypedBlackBoard()
+{
+    for (unsigned int i = 0; i < slots_.size(); i++)
+    {
+        // no reader can be left once the blackboard is destroyed
+        void* rcu_value = slots_[i]->rcu_value.load();
+        if (slots_[i]->type == STRING_VALUE)
+        {
+            delete static_cast<std::string*>(rcu_value);
+        }
+        else if (slots_[i]->type == BLOB_VALUE)
+        {
+            delete static_cast<BlackBoardBlob*>(rcu_value);
+        }
+        delete slots_[i];
+    }
+}
+
+BT::BlackBoardSlot* BT::TypedBlackBoard::InternSlot(const std::string& name, BlackBoardValueType type,
+                                                     uint32_t value_size, bool is_type_checked)
+{
+    std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+
+    std::unordered_map<std::string, BlackBoardSlot*>::iterator it = slots_by_name_.find(name);
+    if (it != slots_by_name_.end())
+    {
+        if ((is_type_checked && it->second->type != type)
+                || (it->second->type == type && it->second->value_size != value_size))
+        {
+            throw BehaviorTreeException("the key '" + name + "' has been interned with another type");
+        }
+        return it->second;
+    }
+
+    BlackBoardSlot* slot = new BlackBoardSlot();
+    slot->name = name;
+    slot->type = type;
+    slot->index = slots_.size();
+    slot->value_size = value_size;
+    slot->sequence = 0;
+    for (unsigned int i = 0; i < BlackBoardSlot::WORDS_NUMBER; i++)
+    {
+        slot->words[i] = 0;
+    }
+    // a string or a blob is never NULL, so that the readers need no check
+    if (type == STRING_VALUE)
+    {
+        slot->rcu_value = new std::string();
+    }
+    else if (type == BLOB_VALUE)
+    {
+        slot->rcu_value = new BlackBoardBlob();
+    }
+    else
+    {
+        slot->rcu_value = NULL;
+    }
+    slots_.push_back(slot);
+    slots_by_name_[name] = slot;
+    return slot;
+}
+
+BT::BlackBoardSlot* BT::TypedBlackBoard::FindSetSlot(const std::string& name)
+{
+    BlackBoardSlot* slot = NULL;
+    {
+        std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+        std::unordered_map<std::string, BlackBoardSlot*>::iterator it = slots_by_name_.find(name);
+        if (it != slots_by_name_.end())
+        {
+            slot = it->second;
+        }
+    }
+    if (slot == NULL || slot->sequence.load(std::memory_order_acquire) == 0)
+    {
+        throw BehaviorTreeException("Cannot find variable " + name);
+    }
+    return slot;
+}
+
+bool BT::TypedBlackBoard::Contains(const std::string& name)
+{
+    std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+    return slots_by_name_.find(name) != slots_by_name_.end();
+}
+
+std::vector<std::string> BT::TypedBlackBoard::GetNames()
+{
+    std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+    std::vector<std::string> names;
+    for (unsigned int i = 0; i < slots_.size(); i++)
+    {
+        names.push_back(slots_[i]->name);
+    }
+    return names;
+}
+
+BT::BlackBoardValueType BT::TypedBlackBoard::GetType(const std::string& name)
+{
+    std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+    std::unordered_map<std::string, BlackBoardSlot*>::iterator it = slots_by_name_.find(name);
+    if (it == slots_by_name_.end())
+    {
+        throw BehaviorTreeException("Cannot find variable " + name);
+    }
+    return it->second->type;
+}
+
+unsigned int BT::TypedBlackBoard::get_keys_number()
+{
+    std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+    return slots_.size();
+}
+
+void BT::TypedBlackBoard::GetVersions(std::vector<uint64_t>* versions)
+{
+    std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+    versions->resize(slots_.size());
+    for (unsigned int i = 0; i < slots_.size(); i++)
+    {
+        (*versions)[i] = slots_[i]->sequence.load(std::memory_order_acquire) / 2;
+    }
+}
+
+void BT::TypedBlackBoard::set_change_notified(bool is_change_notified)
+{
+    is_change_notified_ = is_change_notified;
+}
+
+BT::TickTrigger* BT::TypedBlackBoard::get_change_trigger()
+{
+    return &change_trigger_;
+}
+
+void BT::TypedBlackBoard::set_tick_trigger(TickTrigger* tick_trigger)
+{
+    tick_trigger_ = tick_trigger;
+}
+
+void BT::TypedBlackBoard::GetRecords(std::vector<BlackBoardRecord>* records)
+{
+    std::vector<BlackBoardSlot*> slots;
+    {
+        std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+        slots = slots_;
+    }
+
+    records->clear();
+    for (unsigned int i = 0; i < slots.size(); i++)
+    {
+        BlackBoardSlot* slot = slots[i];
+        if (slot->sequence.load(std::memory_order_acquire) == 0)
+        {
+            continue;
+        }
+        BlackBoardRecord record;
+        record.name = slot->name;
+        record.type = slot->type;
+        record.value_size = slot->value_size;
+        if (slot->type == STRING_VALUE || slot->type == BLOB_VALUE)
+        {
+            // read before the value, which is then the one of this version or of a later one
+            record.version = slot->sequence.load(std::memory_order_acquire) / 2;
+            Rcu::ReadGuard read_guard;
+            const void* value = slot->rcu_value.load(std::memory_order_acquire);
+            if (slot->type == STRING_VALUE)
+            {
+                record.bytes = *static_cast<const std::string*>(value);
+            }
+            else
+            {
+                const BlackBoardBlob* blob = static_cast<const BlackBoardBlob*>(value);
+                record.bytes.assign(blob->begin(), blob->end());
+            }
+        }
+        else
+        {
+            // Seqlock::Read(), keeping the sequence of the value
+            uint64_t words[BlackBoardSlot::WORDS_NUMBER];
+            const unsigned int words_number = (slot->value_size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+            uint64_t sequence;
+            do
+            {
+                sequence = Seqlock::BeginRead(&slot->sequence);
+                for (unsigned int i = 0; i < words_number; i++)
+                {
+                    words[i] = slot->words[i].load(std::memory_order_relaxed);
+                }
+            }
+            while (!Seqlock::IsReadValid(&slot->sequence, sequence));
+            record.version = sequence / 2;
+            record.bytes.assign(reinterpret_cast<const char*>(words), slot->value_size);
+        }
+        records->push_back(record);
+    }
+}
+
+uint32_t BT::TypedBlackBoard::GetValueSize(const BlackBoardRecord& record)
+{
+    uint32_t value_size;
+    switch (record.type)
+    {
+    case INT16_VALUE:
+        value_size = sizeof(int16_t);
+        break;
+    case INT32_VALUE:
+        value_size = sizeof(int32_t);
+        break;
+    case INT64_VALUE:
+        value_size = sizeof(int64_t);
+        break;
+    case BYTE_VALUE:
+        value_size = sizeof(int8_t);
+        break;
+    case DOUBLE_VALUE:
+        value_size = sizeof(double);
+        break;
+    case BOOL_VALUE:
+        value_size = sizeof(bool);
+        break;
+    case STRING_VALUE:
+        value_size = sizeof(std::string);
+        break;
+    case BLOB_VALUE:
+        value_size = sizeof(BlackBoardBlob);
+        break;
+    case FIXED_VALUE:
+        value_size = record.value_size;
+        if (value_size == 0 || value_size > FIXED_VALUE_MAX_SIZE)
+        {
+            throw BehaviorTreeException("the structure of " + record.name + " has an invalid size");
+        }
+        break;
+    default:
+        throw BehaviorTreeException("the record of " + record.name + " has an invalid type");
+    }
+    return value_size;
+}
+
+void BT::TypedBlackBoard::SetRecord(const BlackBoardRecord& record)
+{
+    uint32_t value_size = GetValueSize(record);
+    BlackBoardSlot* slot = InternSlot(record.name, record.type, value_size);
+    if (record.type == STRING_VALUE)
+    {
+        Set(BlackBoardKey<std::string>(slot), record.bytes);
+        return;
+    }
+    if (record.type == BLOB_VALUE)
+    {
+        Set(BlackBoardKey<BlackBoardBlob>(slot), BlackBoardBlob(record.bytes.begin(), record.bytes.end()));
+        return;
+    }
+    if (record.bytes.size() != value_size)
+    {
+        throw BehaviorTreeException("the record of " + record.name + " has " + std::to_string(record.bytes.size())
+                                    + " bytes instead of " + std::to_string(value_size));
+    }
+
+    // the numbers and the structures as words, as StoreLocked()
+    uint64_t words[BlackBoardSlot::WORDS_NUMBER] = {0};
+    std::memcpy(words, record.bytes.data(), value_size);
+    uint64_t sequence = BeginWrite(slot);
+    Seqlock::Write(slot->words, words, (value_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    Seqlock::EndWrite(&slot->sequence, sequence + 2);
+    if (journal_.load(std::memory_order_relaxed) != NULL)
+    {
+        JournalBytes(slot, sequence / 2 + 1, record.bytes.data(), value_size);
+    }
+    NotifyChange();
+}
+
+namespace
+{
+    // A write of TypedBlackBoard::SetMany(), with the new value ready before its key is locked
+    struct BatchWrite
+    {
+        BT::BlackBoardSlot* slot;
+        const BT::BlackBoardRecord* record;
+        uint64_t words[BT::BlackBoardSlot::WORDS_NUMBER];
+        // a new string or blob, then the old one
+        void* rcu_value;
+        uint64_t sequence;
+    };
+
+    bool IsBefore(const BatchWrite& write, const BatchWrite& other_write)
+    {
+        return write.slot->index < other_write.slot->index;
+    }
+
+    void DeleteRcuValue(BT::BlackBoardValueType type, void* rcu_value)
+    {
+        if (type == BT::STRING_VALUE)
+        {
+            delete static_cast<std::string*>(rcu_value);
+        }
+        else
+        {
+            delete static_cast<BT::BlackBoardBlob*>(rcu_value);
+        }
+    }
+}
+
+void BT::TypedBlackBoard::SetMany(const std::vector<BlackBoardRecord>& records)
+{
+    // the last record of each key
+    std::map<std::string, const BlackBoardRecord*> last_records;
+    for (unsigned int i = 0; i < records.size(); i++)
+    {
+        last_records[records[i].name] = &records[i];
+    }
+
+    // converted to the types of the keys before any key is locked: a value that does not fit sets nothing
+    std::vector<BatchWrite> writes;
+    writes.reserve(last_records.size());
+    try
+    {
+        for (std::map<std::string, const BlackBoardRecord*>::iterator it = last_records.begin();
+             it != last_records.end(); ++it)
+        {
+            const BlackBoardRecord& record = *it->second;
+            BatchWrite write;
+            write.slot = InternSlot(record.name, record.type, GetValueSize(record), false);
+            write.record = &record;
+            write.rcu_value = NULL;
+            std::memset(write.words, 0, sizeof(write.words));
+            if (write.slot->type != record.type)
+            {
+                // a number of another type (throws otherwise)
+                ToWords(write.slot, ToNumber(record), write.words);
+            }
+            else if (record.type == STRING_VALUE)
+            {
+                write.rcu_value = new std::string(record.bytes);
+            }
+            else if (record.type == BLOB_VALUE)
+            {
+                write.rcu_value = new BlackBoardBlob(record.bytes.begin(), record.bytes.end());
+            }
+            else if (record.bytes.size() != write.slot->value_size)
+            {
+                throw BehaviorTreeException("the record of " + record.name + " has " + std::to_string(record.bytes.size())
+                                            + " bytes instead of " + std::to_string(write.slot->value_size));
+            }
+            else
+            {
+                std::memcpy(write.words, record.bytes.data(), record.bytes.size());
+            }
+            writes.push_back(write);
+        }
+    }
+    catch (const BehaviorTreeException&)
+    {
+        for (unsigned int i = 0; i < writes.size(); i++)
+        {
+            if (writes[i].rcu_value != NULL)
+            {
+                DeleteRcuValue(writes[i].slot->type, writes[i].rcu_value);
+            }
+        }
+        throw;
+    }
+
+    std::sort(writes.begin(), writes.end(), IsBefore);
+    for (unsigned int i = 0; i < writes.size(); i++)
+    {
+        writes[i].sequence = BeginWrite(writes[i].slot);
+    }
+    for (unsigned int i = 0; i < writes.size(); i++)
+    {
+        BlackBoardSlot* slot = writes[i].slot;
+        if (writes[i].rcu_value != NULL)
+        {
+            writes[i].rcu_value = slot->rcu_value.exchange(writes[i].rcu_value);
+        }
+        else
+        {
+            Seqlock::Write(slot->words, writes[i].words, (slot->value_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        }
+    }
+    for (unsigned int i = 0; i < writes.size(); i++)
+    {
+        Seqlock::EndWrite(&writes[i].slot->sequence, writes[i].sequence + 2);
+    }
+
+    for (unsigned int i = 0; i < writes.size(); i++)
+    {
+        BlackBoardSlot* slot = writes[i].slot;
+        if (writes[i].rcu_value != NULL)
+        {
+            if (slot->type == STRING_VALUE)
+            {
+                Rcu::Retire(writes[i].rcu_value, &Rcu::Delete<std::string>);
+            }
+            else
+            {
+                Rcu::Retire(writes[i].rcu_value, &Rcu::Delete<BlackBoardBlob>);
+            }
+        }
+        if (journal_.load(std::memory_order_relaxed) != NULL)
+        {
+            if (slot->type == STRING_VALUE || slot->type == BLOB_VALUE)
+            {
+                JournalBytes(slot, writes[i].sequence / 2 + 1, writes[i].record->bytes.data(),
+                             writes[i].record->bytes.size());
+            }
+            else
+            {
+                JournalBytes(slot, writes[i].sequence / 2 + 1, writes[i].words, slot->value_size);
+            }
+        }
+    }
+    NotifyChange();
+}
+
+void BT::TypedBlackBoard::GetMany(const std::vector<std::string>& names, std::vector<BlackBoardRecord>* records)
+{
+    std::vector<BlackBoardSlot*> slots(names.size(), NULL);
+    {
+        std::lock_guard<std::mutex> LockGuard(intern_mutex_);
+        for (unsigned int i = 0; i < names.size(); i++)
+        {
+            std::unordered_map<std::string, BlackBoardSlot*>::iterator it = slots_by_name_.find(names[i]);
+            if (it != slots_by_name_.end())
+            {
+                slots[i] = it->second;
+            }
+        }
+    }
+
+    // Seqlock::Read() over all the keys: valid only if none has been written while the others were read
+    records->resize(names.size());
+    std::vector<uint64_t> sequences(names.size(), 0);
+    bool is_read_valid;
+    do
+    {
+        for (unsigned int i = 0; i < slots.size(); i++)
+        {
+            if (slots[i] != NULL)
+            {
+                sequences[i] = Seqlock::BeginRead(&slots[i]->sequence);
+            }
+        }
+        {
+            Rcu::ReadGuard read_guard;
+            for (unsigned int i = 0; i < slots.size(); i++)
+            {
+                BlackBoardRecord& record = (*records)[i];
+                BlackBoardSlot* slot = slots[i];
+                record.name = names[i];
+                record.bytes.clear();
+                if (slot == NULL)
+                {
+                    record.type = FIXED_VALUE;
+                    record.value_size = 0;
+                    continue;
+                }
+                record.type = slot->type;
+                record.value_size = slot->value_size;
+                if (sequences[i] == 0)
+                {
+                    continue;
+                }
+                if (slot->type == STRING_VALUE)
+                {
+                    record.bytes = *static_cast<const std::string*>(slot->rcu_value.load(std::memory_order_acquire));
+                }
+                else if (slot->type == BLOB_VALUE)
+                {
+                    const BlackBoardBlob* blob = static_cast<const BlackBoardBlob*>(slot->rcu_value.load(std::memory_order_acquire));
+                    record.bytes.assign(blob->begin(), blob->end());
+                }
+                else
+                {
+                    uint64_t words[BlackBoardSlot::WORDS_NUMBER];
+                    for (unsigned int j = 0; j < (slot->value_size + sizeof(uint64_t) - 1) / sizeof(uint64_t); j++)
+                    {
+                        words[j] = slot->words[j].load(std::memory_order_relaxed);
+                    }
+                    record.bytes.assign(reinterpret_cast<const char*>(words), slot->value_size);
+                }
+            }
+        }
+        is_read_valid = true;
+        for (unsigned int i = 0; i < slots.size() && is_read_valid; i++)
+        {
+            is_read_valid = slots[i] == NULL || Seqlock::IsReadValid(&slots[i]->sequence, sequences[i]);
+        }
+    }
+    while (!is_read_valid);
+
+    for (unsigned int i = 0; i < slots.size(); i++)
+    {
+        (*records)[i].version = sequences[i] / 2;
+    }
+}
+
+void BT::TypedBlackBoard::set_journal(BlackBoardJournal* journal)
+{
+    if (journal == NULL)
+    {
+        journal_ = NULL;
+        // the writers that have loaded the old journal are in a read-side section
+        Rcu::Synchronize();
+        return;
+    }
+    BlackBoardJournal* no_journal = NULL;
+    if (!journal_.compare_exchange_strong(no_journal, journal) && no_journal != journal)
+    {
+        throw BehaviorTreeException("the blackboard already has a journal");
+    }
+}
+
+BT::BlackBoardJournal* BT::TypedBlackBoard::get_journal()
+{
+    return journal_;
+}
+
+void BT::TypedBlackBoard::JournalBytes(BlackBoardSlot* slot, uint64_t version, const void* bytes, std::size_t size)
+{
+    Rcu::ReadGuard read_guard;
+    BlackBoardJournal* journal = journal_.load();
+    if (journal != NULL)
+    {
+        journal->Append(slot, version, bytes, size);
+    }
+}
+
+BT::TypedBlackBoard::Number BT::TypedBlackBoard::GetNumber(BlackBoardSlot* slot)
+{
+    switch (slot->type)
+    {
+    case INT16_VALUE:
+        return ToNumber(Get(BlackBoardKey<int16_t>(slot)));
+    case INT32_VALUE:
+        return ToNumber(Get(BlackBoardKey<int32_t>(slot)));
+    case INT64_VALUE:
+        return ToNumber(Get(BlackBoardKey<int64_t>(slot)));
+    case BYTE_VALUE:
+        return ToNumber(Get(BlackBoardKey<int8_t>(slot)));
+    case DOUBLE_VALUE:
+        return ToNumber(Get(BlackBoardKey<double>(slot)));
+    case BOOL_VALUE:
+        return ToNumber(Get(BlackBoardKey<bool>(slot)));
+    default:
+        throw BehaviorTreeException("the variable " + slot->name + " is not a number");
+    }
+}
+
+void BT::TypedBlackBoard::SetNumber(BlackBoardSlot* slot, Number number)
+{
+    switch (slot->type)
+    {
+    case INT16_VALUE:
+        {
+            int16_t value;
+            FromNumber(number, &value);
+            Set(BlackBoardKey<int16_t>(slot), value);
+        }
+        break;
+    case INT32_VALUE:
+        {
+            int32_t value;
+            FromNumber(number, &value);
+            Set(BlackBoardKey<int32_t>(slot), value);
+        }
+        break;
+    case INT64_VALUE:
+        {
+            int64_t value;
+            FromNumber(number, &value);
+            Set(BlackBoardKey<int64_t>(slot), value);
+        }
+        break;
+    case BYTE_VALUE:
+        {
+            int8_t value;
+            FromNumber(number, &value);
+            Set(BlackBoardKey<int8_t>(slot), value);
+        }
+        break;
+    case DOUBLE_VALUE:
+        {
+            double value;
+            FromNumber(number, &value);
+            Set(BlackBoardKey<double>(slot), value);
+        }
+        break;
+    case BOOL_VALUE:
+        {
+            bool value;
+            FromNumber(number, &value);
+            Set(BlackBoardKey<bool>(slot), value);
+        }
+        break;
+    default:
+        throw BehaviorTreeException("the variable " + slot->name + " is not a number");
+    }
+}
+
+BT::TypedBlackBoard::Number BT::TypedBlackBoard::ToNumber(const BlackBoardRecord& record)
+{
+    if (record.bytes.size() != GetValueSize(record))
+    {
+        throw BehaviorTreeException("the record of " + record.name + " is not a number");
+    }
+    switch (record.type)
+    {
+    case INT16_VALUE:
+        return ToNumberAs<int16_t>(record.bytes);
+    case INT32_VALUE:
+        return ToNumberAs<int32_t>(record.bytes);
+    case INT64_VALUE:
+        return ToNumberAs<int64_t>(record.bytes);
+    case BYTE_VALUE:
+        return ToNumberAs<int8_t>(record.bytes);
+    case DOUBLE_VALUE:
+        return ToNumberAs<double>(record.bytes);
+    case BOOL_VALUE:
+        return ToNumberAs<bool>(record.bytes);
+    default:
+        throw BehaviorTreeException("the record of " + record.name + " is not a number");
+    }
+}
+
+void BT::TypedBlackBoard::ToWords(BlackBoardSlot* slot, Number number, uint64_t* words)
+{
+    switch (slot->type)
+    {
+    case INT16_VALUE:
+        return ToWordsAs<int16_t>(number, words);
+    case INT32_VALUE:
+        return ToWordsAs<int32_t>(number, words);
+    case INT64_VALUE:
+        return ToWordsAs<int64_t>(number, words);
+    case BYTE_VALUE:
+        return ToWordsAs<int8_t>(number, words);
+    case DOUBLE_VALUE:
+        return ToWordsAs<double>(number, words);
+    case BOOL_VALUE:
+        return ToWordsAs<bool>(number, words);
+    default:
+        throw BehaviorTreeException("the variable " + slot->name + " is not a number");
+    }
+}
+
+bool BT::TypedBlackBoard::CompareAndSetNumber(BlackBoardSlot* slot, Number expected, Number desired)
+{
+    switch (slot->type)
+    {
+    case INT16_VALUE:
+        return CompareAndSetAs<int16_t>(slot, expected, desired);
+    case INT32_VALUE:
+        return CompareAndSetAs<int32_t>(slot, expected, desired);
+    case INT64_VALUE:
+        return CompareAndSetAs<int64_t>(slot, expected, desired);
+    case BYTE_VALUE:
+        return CompareAndSetAs<int8_t>(slot, expected, desired);
+    case DOUBLE_VALUE:
+        return CompareAndSetAs<double>(slot, expected, desired);
+    case BOOL_VALUE:
+        return CompareAndSetAs<bool>(slot, expected, desired);
+    default:
+        throw BehaviorTreeException("the variable " + slot->name + " is not a number");
+    }
+}
+
+BT::TypedBlackBoard::Number BT::TypedBlackBoard::AddNumber(BlackBoardSlot* slot, Number delta)
+{
+    switch (slot->type)
+    {
+    case INT16_VALUE:
+        return AddAs<int16_t>(slot, delta);
+    case INT32_VALUE:
+        return AddAs<int32_t>(slot, delta);
+    case INT64_VALUE:
+        return AddAs<int64_t>(slot, delta);
+    case BYTE_VALUE:
+        return AddAs<int8_t>(slot, delta);
+    case DOUBLE_VALUE:
+        return AddAs<double>(slot, delta);
+    case BOOL_VALUE:
+        return AddAs<bool>(slot, delta);
+    default:
+        throw BehaviorTreeException("the variable " + slot->name + " is not a number");
+    }
+}
@@ -58,13 +58,13 @@ BT::YARPActionNode::~YARPActionNode()
 
 BT::ReturnStatus BT::YARPActionNode::Tick()
 {
-    std::cout << "requesting tick" << std::endl;
+    BT_TRACE_EVENT(BT::Trace::REQUEST_TICK, get_name(), 0);
 
     set_status(BT::RUNNING);
 
 
     int32_t status = action_tick_server_.request_tick();
-    std::cout << "tick requested" << std::endl;
+    BT_TRACE_EVENT(BT::Trace::TICK_REQUESTED, get_name(), status);
 
     set_status((BT::ReturnStatus)status);
     return (BT::ReturnStatus)status;
@@ -89,9 +89,9 @@ BT::ReturnStatus BT::YARPActionNode::Tick()
 
 void BT::YARPActionNode::Halt()
 {
-    std::cout << "requesting halt" << std::endl;
+    BT_TRACE_EVENT(BT::Trace::REQUEST_HALT, get_name(), 0);
     action_halt_server_.request_halt();
-    std::cout << "halt requested" << std::endl;
+    BT_TRACE_EVENT(BT::Trace::HALT_REQUESTED, get_name(), 0);
 
 }
 
@@ -52,7 +52,7 @@ BT::ReturnStatus BT::YARPConditionNode::Tick()
 {
 
     int32_t status = condition_server_.request_tick();
-    std::cout << "tick requested" << std::endl;
+    BT_TRACE_EVENT(BT::Trace::TICK_REQUESTED, get_name(), status);
 
     //set_status((BT::ReturnStatus)status);
     return (BT::ReturnStatus)status;
@@ -12,7 +12,7 @@
 #include <QStandardItemModel>
 #include <QStandardItem>
 #include "BlackboardNodeModel.h"
-#include <yarp/os/Property.h> // the blackboard is a yarp property
+#include <sstream>
 
 
 
@@ -24,7 +24,7 @@ BlackboardNodeModel::BlackboardNodeModel(QString name, const NodeFactory::Parame
     _label->setText(name);
 
     // TODO use QTableView to make the BB editable
-    blackboard_ = new yarp::os::Property();
+    blackboard_ = NULL;
 
     blackboard_content_ = new QLabel(_main_widget);
     //blackboard_content_->setText("init");
@@ -90,11 +90,54 @@ QString BlackboardNodeModel::caption() const
     return type();
 }
 
-void BlackboardNodeModel::set_blackboard(yarp::os::Property *blackboard)
+// One "name value" line per key set so far, as yarp::os::Property::toString() did
+static std::string BlackboardToString(BT::TypedBlackBoard *blackboard)
+{
+    std::ostringstream text;
+    std::vector<std::string> names = blackboard->GetNames();
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+        std::ostringstream value;
+        try
+        {
+            switch (blackboard->GetType(names[i]))
+            {
+            case BT::INT16_VALUE:
+            case BT::INT32_VALUE:
+            case BT::INT64_VALUE:
+            case BT::BYTE_VALUE:
+                value << blackboard->GetByName<int64_t>(names[i]);
+                break;
+            case BT::DOUBLE_VALUE:
+                value << blackboard->GetByName<double>(names[i]);
+                break;
+            case BT::BOOL_VALUE:
+                value << (blackboard->GetByName<bool>(names[i]) ? "true" : "false");
+                break;
+            case BT::STRING_VALUE:
+                value << "\"" << blackboard->GetByName<std::string>(names[i]) << "\"";
+                break;
+            default:
+                // blobs and structures
+                value << "<binary>";
+                break;
+            }
+        }
+        catch (const BT::BehaviorTreeException &exception)
+        {
+            // interned but never set
+            continue;
+        }
+        text << names[i] << " " << value.str() << std::endl;
+    }
+    return text.str();
+}
+
+void BlackboardNodeModel::set_blackboard(BT::TypedBlackBoard *blackboard)
 {
     blackboard_ = blackboard;
     std::cout << "****************************************** BB set ******************************************" << std::endl;
-        std::cout << blackboard_->toString()<< std::endl;
+        std::cout << BlackboardToString(blackboard_) << std::endl;
             std::cout << "****************************************** OK ******************************************" << std::endl;
 
 
@@ -229,7 +272,11 @@ void BlackboardNodeModel::lock(bool locked)
 
 void BlackboardNodeModel::update_blackboard()
 {
-    std::string blackboard_as_str = blackboard_->toString() ;
+    if (blackboard_ == NULL)
+    {
+        return;
+    }
+    std::string blackboard_as_str = BlackboardToString(blackboard_);
     if (!blackboard_as_str.empty())
     {
 
@@ -16,7 +16,7 @@
 #include "NodeFactory.hpp"
 #include <QTableView>
 
-#include <yarp/os/Property.h> // the blackboard is a yarp property
+#include <typed_blackboard.h>
 
 
 using QtNodes::PortType;
@@ -65,7 +65,7 @@ public:
   void lastComboItem();
   //bool eventFilter(QObject *object, QEvent *event);
 
-void set_blackboard(yarp::os::Property *blackboard );
+void set_blackboard(BT::TypedBlackBoard *blackboard );
 //QLabel* blackboard_content_ ;
 
 void set_blackboard_text(QString text);
@@ -80,7 +80,8 @@ private:
   QString    _ID;
   QLabel* blackboard_content_;
   //QTextEdit * _text_edit;
-  yarp::os::Property *blackboard_ ;
+  // NULL until the tree runs
+  BT::TypedBlackBoard *blackboard_ ;
   QString     source_code_;
   const NodeFactory::ParametersModel& _parameter_model;
 
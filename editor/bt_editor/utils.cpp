@@ -6,7 +6,6 @@
 #include <bt_editor/BehaviorTreeNodeModel.hpp>
 #include <bt_editor/YARPNodeModel.h>
 #include <bt_editor/PythonNodeModel.h>
-#include <yarp/os/Property.h> // the blackboard is a yarp property
 #include <thread>
 #include <functional>
 #include <iostream>
@@ -425,7 +424,8 @@ void SubtreeReorder(QtNodes::FlowScene &scene, QtNodes::Node &root_node)
     scene.setSceneRect(-30, -30, right + 60, bottom + 60);
 }
 
-BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::os::Property *blackboard)
+BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, BT::TypedBlackBoard *blackboard,
+                          BT::BehaviorTree &tree)
 {
 
     int bt_type = node.nodeDataModel()->BTType();
@@ -437,7 +437,7 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
         // {
 
         //     std::string filename = ((LuaNodeModel*)node.nodeDataModel())->type().toStdString();
-        //     BT::LuaActionNode* bt_node = new BT::LuaActionNode(filename,filename,);
+        //     BT::LuaActionNode* bt_node = tree.CreateNode<BT::LuaActionNode>(filename,filename,);
         //     node.linkBTNode(bt_node);
         //     return bt_node;
         //     break;
@@ -445,7 +445,7 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
         // case QtNodes::LUACONDITION:
         // {
         //     std::string filename = ((LuaNodeModel*)node.nodeDataModel())->type().toStdString();
-        //     BT::LuaConditionNode* bt_node = new BT::LuaConditionNode(filename,filename);
+        //     BT::LuaConditionNode* bt_node = tree.CreateNode<BT::LuaConditionNode>(filename,filename);
         //     node.linkBTNode(bt_node);
         //     return bt_node;
         //     break;
@@ -454,7 +454,7 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     case QtNodes::PYTHONACTION:
     {
         std::string filename = ((PythonNodeModel *)node.nodeDataModel())->type().toStdString();
-        BT::PythonActionNode *bt_node = new BT::PythonActionNode(filename, filename, blackboard);
+        BT::PythonActionNode *bt_node = tree.CreateNode<BT::PythonActionNode>(filename, filename, blackboard);
         node.linkBTNode(bt_node);
         return bt_node;
         break;
@@ -462,7 +462,7 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     case QtNodes::PYTHONCONDITION:
     {
         std::string filename = ((PythonNodeModel *)node.nodeDataModel())->type().toStdString();
-        BT::PythonConditionNode *bt_node = new BT::PythonConditionNode(filename, filename, blackboard);
+        BT::PythonConditionNode *bt_node = tree.CreateNode<BT::PythonConditionNode>(filename, filename, blackboard);
         node.linkBTNode(bt_node);
         return bt_node;
         break;
@@ -471,7 +471,7 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     {
         std::string server_name = ((YARPNodeModel *)node.nodeDataModel())->type().toStdString();
 
-        BT::YARPActionNode *bt_node = new BT::YARPActionNode(server_name + "BTAction", server_name);
+        BT::YARPActionNode *bt_node = tree.CreateNode<BT::YARPActionNode>(server_name + "BTAction", server_name);
         node.linkBTNode(bt_node);
         return bt_node;
         break;
@@ -479,21 +479,21 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     case QtNodes::YARPCONDITION:
     {
         std::string server_name = ((YARPNodeModel *)node.nodeDataModel())->type().toStdString();
-        BT::YARPConditionNode *bt_node = new BT::YARPConditionNode(server_name + "BTCondition", server_name);
+        BT::YARPConditionNode *bt_node = tree.CreateNode<BT::YARPConditionNode>(server_name + "BTCondition", server_name);
         node.linkBTNode(bt_node);
         return bt_node;
         break;
     }
     case QtNodes::SEQUENCE:
     {
-        BT::SequenceNode *bt_node = new BT::SequenceNode("Sequence");
+        BT::SequenceNode *bt_node = tree.CreateNode<BT::SequenceNode>("Sequence");
 
         std::vector<QtNodes::Node *> children = getChildren(scene, node);
 
         for (int i = 0; i < children.size(); i++)
 
         {
-            bt_node->AddChild(getBTObject(scene, *children[i], blackboard));
+            bt_node->AddChild(getBTObject(scene, *children[i], blackboard, tree));
         }
         node.linkBTNode(bt_node);
         return bt_node;
@@ -501,14 +501,14 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     }
     case QtNodes::SELECTOR:
     {
-        BT::FallbackNode *bt_node = new BT::FallbackNode("Fallback");
+        BT::FallbackNode *bt_node = tree.CreateNode<BT::FallbackNode>("Fallback");
 
         std::vector<QtNodes::Node *> children = getChildren(scene, node);
 
         for (int i = 0; i < children.size(); i++)
 
         {
-            bt_node->AddChild(getBTObject(scene, *children[i], blackboard));
+            bt_node->AddChild(getBTObject(scene, *children[i], blackboard, tree));
         }
         node.linkBTNode(bt_node);
         return bt_node;
@@ -516,14 +516,14 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     }
     case QtNodes::SEQUENCESTAR:
     {
-        BT::SequenceNodeWithMemory *bt_node = new BT::SequenceNodeWithMemory("SequenceWithMemory");
+        BT::SequenceNodeWithMemory *bt_node = tree.CreateNode<BT::SequenceNodeWithMemory>("SequenceWithMemory");
 
         std::vector<QtNodes::Node *> children = getChildren(scene, node);
 
         for (int i = 0; i < children.size(); i++)
 
         {
-            bt_node->AddChild(getBTObject(scene, *children[i], blackboard));
+            bt_node->AddChild(getBTObject(scene, *children[i], blackboard, tree));
         }
         node.linkBTNode(bt_node);
         return bt_node;
@@ -531,13 +531,13 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     }
     case QtNodes::SELECTORSTAR:
     {
-        BT::FallbackNodeWithMemory *bt_node = new BT::FallbackNodeWithMemory("FallbackWithMemory");
+        BT::FallbackNodeWithMemory *bt_node = tree.CreateNode<BT::FallbackNodeWithMemory>("FallbackWithMemory");
         std::vector<QtNodes::Node *> children = getChildren(scene, node);
 
         for (int i = 0; i < children.size(); i++)
 
         {
-            bt_node->AddChild(getBTObject(scene, *children[i], blackboard));
+            bt_node->AddChild(getBTObject(scene, *children[i], blackboard, tree));
         }
         node.linkBTNode(bt_node);
         return bt_node;
@@ -547,12 +547,12 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     {
         std::vector<QtNodes::Node *> children = getChildren(scene, node);
 
-        BT::ParallelNode *bt_node = new BT::ParallelNode("ParallelNode", children.size());
+        BT::ParallelNode *bt_node = tree.CreateNode<BT::ParallelNode>("ParallelNode", children.size());
 
         for (int i = 0; i < children.size(); i++)
 
         {
-            bt_node->AddChild(getBTObject(scene, *children[i], blackboard));
+            bt_node->AddChild(getBTObject(scene, *children[i], blackboard, tree));
         }
         node.linkBTNode(bt_node);
         return bt_node;
@@ -560,12 +560,12 @@ BT::TreeNode *getBTObject(QtNodes::FlowScene &scene, QtNodes::Node &node, yarp::
     }
     case QtNodes::ROOT:
     {
-        BT::RootNode *bt_node = new BT::RootNode();
+        BT::RootNode *bt_node = tree.CreateNode<BT::RootNode>();
         std::vector<QtNodes::Node *> children = getChildren(scene, node);
 
         for (int i = 0; i < children.size(); i++)
         {
-            bt_node->AddChild(getBTObject(scene, *children[i], blackboard));
+            bt_node->AddChild(getBTObject(scene, *children[i], blackboard, tree));
         }
         node.linkBTNode(bt_node);
         return bt_node;
@@ -611,13 +611,15 @@ int getMode()
 //     return 1; //number of returning values
 // }
 
-void RunServer(BlackBoardServer server)
+// The server is not copyable: it owns its ports and its journal
+void RunServer(BlackBoardServer* server)
 {
         yarp::os::ResourceFinder rf;
 
     std::cout << " running the server" << std::endl;
-    server.configure(rf);
-    server.runModule();
+    server->configure(rf);
+    server->runModule();
+    server->close();
     std::cout << " running the server2" << std::endl;
 
 }
@@ -648,7 +650,8 @@ void runTree(QtNodes::FlowScene *scene)
     //     RunPreamble(lua_state, (LuaPreambleNodeModel*)lua_preamble->nodeDataModel());
     // }
 
-    yarp::os::Property *blackboard = new yarp::os::Property();
+    // shared by the tree, the server and the blackboard node: readable from all their threads at once
+    BT::TypedBlackBoard *blackboard = new BT::TypedBlackBoard();
 
 
  BlackBoardServer blackboard_server(blackboard);
@@ -659,7 +662,7 @@ void runTree(QtNodes::FlowScene *scene)
     QtNodes::Node* blackboard_node = BlackboardNode(scene);
 
 std::cout << "running module" << std::endl;
- std::thread t1(&RunServer, blackboard_server);
+ std::thread t1(&RunServer, &blackboard_server);
 
 
 std::cout << " running the tree" << std::endl;
@@ -668,7 +671,10 @@ std::cout << " running the tree" << std::endl;
 
 
 
-    BT::TreeNode *bt_root = getBTObject(*scene, *root, blackboard);
+    // owns the nodes: they are released when the run ends
+    BT::BehaviorTree tree;
+    BT::TreeNode *bt_root = getBTObject(*scene, *root, blackboard, tree);
+    tree.set_root(bt_root);
 
     if(blackboard_node != NULL)
     {
@@ -678,15 +684,18 @@ std::cout << " running the tree" << std::endl;
 
 
 
+    BT::TickScheduler scheduler(std::chrono::milliseconds(1000));
+
     while (getMode() == 1)
     {
+        // sleeps until the deadline of this tick
+        scheduler.WaitForNextTick();
+
         std::cout << "Ticking the root node !" << std::endl;
 
         // Ticking the root node
         bt_root->Tick();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-
         scene->update();
        // ((YarpBlackboardNodeModel*)blackboard_node)->update_blackboard();
            if(blackboard_node != NULL)
@@ -701,7 +710,17 @@ std::cout << " running the tree" << std::endl;
         }
     }
     std::cout << "Halting the BT" << std::endl;
+    scheduler.PrintStatistics(std::cout);
     bt_root->Halt();
+    tree.Shutdown();
+    // the server runs on the stack of this function
+    blackboard_server.stopModule();
+    t1.join();
+    // the scene must not paint the nodes once they are destroyed
+    for (auto &it : scene->nodes())
+    {
+        it.second->linkBTNode(NULL);
+    }
     // std::cout << "Finalizing the BT" << std::endl;
     //bt_root->Finalize();
     //std::cout << "Closing the Lua state" << std::endl;
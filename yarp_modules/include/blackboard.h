@@ -7,6 +7,7 @@
 #include <yarp/os/Property.h> // the blackboard is a yarp property
 #include <cmath> //double_t, int_t etc
 #include <iostream>
+#include <tick_trigger.h>
 class BlackBoard
 {
 public:
@@ -59,6 +60,8 @@ public:
             content_2.unput(name);
             content_2.put(name,data);
         }
+        // a tree in reactive mode re-evaluates its conditions (see ExecuteReactive())
+        BT::GetDefaultTickTrigger()->Trigger();
     }
 
     //void PrintContent();
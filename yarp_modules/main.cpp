@@ -1,6 +1,6 @@
 #include <iostream>
 #include <yarp/os/Network.h>
-#include <yarp/os/Time.h>
+#include <yarp/os/ResourceFinder.h>
 #include <yarp_bt_module.h>
 #include <blackboard.h>
 #include <blackboard_server.h>
@@ -8,14 +8,11 @@
 int main(int argc, char * argv[])
 {
         yarp::os::Network yarp;
-        BlackBoardServer bb_server;
-        yarp::os::Port port;
-        bb_server.yarp().attachAsServer(port);
-        if (!port.open("/blackboardserver")) { return 1; }
-        while (true) {
-            printf("Server running happily\n");
-            yarp::os::Time::delay(10);
-        }
-        port.close();
-        return 0;
+        yarp::os::ResourceFinder rf;
+        rf.setDefault("name", "blackboardserver");
+        rf.configure(argc, argv);
+        // configure() opens /<name>/cmd and streams the changes of the typed blackboard
+        BT::TypedBlackBoard blackboard;
+        BlackBoardServer bb_server(&blackboard);
+        return bb_server.runModule(rf);
 }
@@ -16,6 +16,8 @@ using namespace RTF;
 
 
 #include <iostream>
+#include <atomic>
+#include <thread>
 #include <yarp/os/all.h>
 #include <BlackBoardCmd.h>
 // prepare the plugin
@@ -40,7 +42,7 @@ void BlackBoardTest::tearDown() { }
         Network yarp;
         /* This port will be used to talk to the remote server*/
         Port client_port;
-        std::string servername= "/blackboardserver";
+        std::string servername= "/blackboardserver/cmd";
         client_port.open("/tests/blackboardclient");
         /* connect to server */
         if (!yarp.connect("/tests/blackboardclient",servername.c_str()))
@@ -89,6 +91,149 @@ void BlackBoardTest::tearDown() { }
         RTF_TEST_CHECK(x32 == 11, "x32 edit");
 
 
+        // Check batched set and get (one round trip each)
+
+        std::vector<std::string> names;
+        std::vector<BlackBoardValue> values;
+        names.push_back("batch_i32");
+        values.push_back(BlackBoardValue(I32_TYPE, 7, 0.0, ""));
+        names.push_back("batch_d");
+        values.push_back(BlackBoardValue(DOUBLE_TYPE, 0, 2.5, ""));
+        names.push_back("batch_s");
+        values.push_back(BlackBoardValue(STRING_TYPE, 0, 0.0, "batch"));
+        RTF_TEST_CHECK(black_board_cmd.SetMany(names, values), "batched set");
+
+        names.push_back("never_set");
+        values = black_board_cmd.GetMany(names);
+        RTF_TEST_CHECK(values.size() == 4, "batched get size");
+        RTF_TEST_CHECK(values[0].integer == 7, "batched get i32");
+        RTF_TEST_CHECK(values[1].real == 2.5, "batched get double");
+        RTF_TEST_CHECK(values[2].text == "batch", "batched get string");
+        RTF_TEST_CHECK(values[3].type == NO_TYPE, "batched get of a key never set");
+
+        // all or nothing: a value with no type is rejected, with the whole batch
+        names.clear();
+        values.clear();
+        names.push_back("batch_i32");
+        values.push_back(BlackBoardValue(I32_TYPE, 8, 0.0, ""));
+        names.push_back("batch_none");
+        values.push_back(BlackBoardValue());
+        RTF_TEST_CHECK(!black_board_cmd.SetMany(names, values), "batched set rejected");
+        RTF_TEST_CHECK(black_board_cmd.GetI32("batch_i32") == 7, "batched set all or nothing");
+
+        // a new key takes the type of its first value in the batch
+        names.clear();
+        values.clear();
+        names.push_back("batch_i32");
+        values.push_back(BlackBoardValue(I32_TYPE, 9, 0.0, ""));
+        names.push_back("batch_new");
+        values.push_back(BlackBoardValue(STRING_TYPE, 0, 0.0, "text"));
+        names.push_back("batch_new");
+        values.push_back(BlackBoardValue(I32_TYPE, 1, 0.0, ""));
+        RTF_TEST_CHECK(!black_board_cmd.SetMany(names, values), "batched set of a key with two types rejected");
+        RTF_TEST_CHECK(black_board_cmd.GetI32("batch_i32") == 7, "batched set with two types not applied");
+        RTF_TEST_CHECK(black_board_cmd.GetMany(names)[1].type == NO_TYPE, "key with two types not created");
+
+        // a batch is atomic: a reader on its own connection never sees part of one batch and part of another
+        std::atomic<bool> is_writing(true);
+        std::atomic<int> mixed_batches_number(0);
+        std::thread reader([servername, &yarp, &is_writing, &mixed_batches_number]()
+        {
+            Port reader_port;
+            reader_port.open("/tests/blackboardreader");
+            yarp.connect("/tests/blackboardreader", servername.c_str());
+            BlackBoardCmd reader_cmd;
+            reader_cmd.yarp().attachAsClient(reader_port);
+            std::vector<std::string> mix_names;
+            mix_names.push_back("mix_a");
+            mix_names.push_back("mix_b");
+            while (is_writing)
+            {
+                std::vector<BlackBoardValue> mix_values = reader_cmd.GetMany(mix_names);
+                if (mix_values.size() != 2 || mix_values[0].type != mix_values[1].type
+                        || mix_values[0].integer != mix_values[1].integer)
+                {
+                    mixed_batches_number++;
+                }
+            }
+            reader_port.close();
+        });
+        names.clear();
+        names.push_back("mix_a");
+        names.push_back("mix_b");
+        for (int i = 1; i <= 200; i++)
+        {
+            values.clear();
+            values.push_back(BlackBoardValue(I32_TYPE, i, 0.0, ""));
+            values.push_back(BlackBoardValue(I32_TYPE, i, 0.0, ""));
+            black_board_cmd.SetMany(names, values);
+        }
+        is_writing = false;
+        reader.join();
+        RTF_TEST_CHECK(mixed_batches_number == 0, "batched get never sees a mixed batch");
+
+
+        // Check compare-and-set
+
+        BlackBoardValue expected(I32_TYPE, 11, 0.0, "");
+        BlackBoardValue desired(I32_TYPE, 12, 0.0, "");
+        RTF_TEST_CHECK(black_board_cmd.CompareAndSet("x32", expected, desired), "compare-and-set");
+        RTF_TEST_CHECK(black_board_cmd.GetI32("x32") == 12, "compare-and-set value");
+        RTF_TEST_CHECK(!black_board_cmd.CompareAndSet("x32", expected, desired), "compare-and-set of a stale value");
+
+        BlackBoardValue absent;
+        RTF_TEST_CHECK(black_board_cmd.CompareAndSet("cas_new", absent, desired), "compare-and-set of a new key");
+        RTF_TEST_CHECK(!black_board_cmd.CompareAndSet("cas_new", absent, desired), "compare-and-set of an existing key");
+
+
+        // Check increment
+
+        BlackBoardValue one(I32_TYPE, 1, 0.0, "");
+        black_board_cmd.Increment("counter", one);
+        BlackBoardValue counter = black_board_cmd.Increment("counter", one);
+        RTF_TEST_CHECK(counter.integer == 2, "increment");
+
+        BlackBoardValue half(DOUBLE_TYPE, 0, 0.5, "");
+        BlackBoardValue d_incremented = black_board_cmd.Increment("d", half);
+        RTF_TEST_CHECK(d_incremented.real == 2.0, "double increment");
+
+        RTF_TEST_CHECK(black_board_cmd.Increment("s", one).type == NO_TYPE, "increment of a string");
+
+
+        // Check change streaming (the server must run on a typed blackboard)
+
+        BufferedPort<Bottle> stream_port;
+        stream_port.open("/tests/blackboardclient/stream");
+        std::vector<std::string> patterns;
+        patterns.push_back("stream_*");
+        int32_t subscription_id = black_board_cmd.Subscribe("/tests/blackboardclient/stream", patterns, 0);
+        RTF_TEST_CHECK(subscription_id >= 0, "subscribe");
+        if (subscription_id >= 0)
+        {
+            black_board_cmd.SetDouble("stream_d", 3.5);
+            // a lost delta fails the check instead of blocking the test
+            Bottle* deltas = NULL;
+            double deadline = Time::now() + 5.0;
+            while (deltas == NULL && Time::now() < deadline)
+            {
+                deltas = stream_port.read(false);
+                if (deltas == NULL)
+                {
+                    Time::delay(0.01);
+                }
+            }
+            RTF_TEST_CHECK(deltas != NULL && deltas->size() == 1, "streamed delta");
+            if (deltas != NULL && deltas->size() == 1)
+            {
+                Bottle* delta = deltas->get(0).asList();
+                RTF_TEST_CHECK(delta->get(0).asString() == "stream_d", "streamed key");
+                RTF_TEST_CHECK(delta->get(3).asDouble() == 3.5, "streamed value");
+            }
+            RTF_TEST_CHECK(black_board_cmd.Unsubscribe(subscription_id), "unsubscribe");
+        }
+        stream_port.close();
+
+
     }
 
 int main(int argc, char** argv)
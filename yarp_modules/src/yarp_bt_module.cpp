@@ -1,5 +1,6 @@
 #include <iostream>
 #include "yarp_bt_module.h"
+#include <tick_trigger.h>
 
 
 YARPBTModule::YARPBTModule(std::string name) : BTCmd(), RFModule()
@@ -40,6 +41,8 @@ int32_t YARPBTModule::request_tick()
 {
     set_is_halted(false);
     tick();
+    // a tree in the same process re-evaluates its conditions at once (see ExecuteReactive())
+    BT::GetDefaultTickTrigger()->Trigger();
     return 1;
 }
 
@@ -52,6 +55,7 @@ void YARPBTModule::request_halt()
 {
     set_is_halted(true); // set is_halted BEFORE calling halt(), the halt routine must be the last thing a BT node is doing
     halt();
+    BT::GetDefaultTickTrigger()->Trigger();
 }
 
 bool YARPBTModule::is_halted()